@@ -0,0 +1,173 @@
+//
+// Created by haochuanchen on 18-5-12.
+//
+
+// Compare knot placement strategies: control point count vs. max error vs. runtime.
+// Usage: FittingBenchmark [curve file (*.obj|*.cd)]
+//        FittingBenchmark --batch <curve file>...     throughput of the batch fitting pipeline
+// Interpolation through all the vertices is timed last, for comparison with fitting as many control points.
+
+#include "../src/fitting/KTPFitting.h"
+#include "../src/fitting/DominantPointFitting.h"
+#include "../src/fitting/ErrorDrivenFitting.h"
+#include "../src/fitting/BatchFittingPipeline.h"
+#include "../src/fitting/BSplineCurveInterpolation.h"
+#include "../src/curve/util/BSplineEvaluator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <memory>
+
+using _Fitting = BSplineCurveFitting_Base;
+using _Ct = _Fitting::_In_Ct;
+using _Pt = _Fitting::_In_Pt;
+using _Dt = _Fitting::_Dt;
+
+namespace
+{
+
+/// A curve with a corner, a wiggly run and a smooth run.
+_Ct synthetic_curve(int n_vertex)
+{
+    _Ct curve;
+    auto& vertices = curve.get_vertices();
+    vertices.reserve(n_vertex);
+    for (int i = 0; i < n_vertex; i++)
+    {
+        _Dt t = _Dt(i) / (n_vertex - 1);
+        _Pt point;
+        point.vertex = t < 0.5 ? Vertex<_Dt>(t, 0.02 * std::sin(40 * t), 0.1 * std::sin(20 * t * t))
+                               : Vertex<_Dt>(0.5, t - 0.5, 0.1 * std::sin(20 * t * t));
+        vertices.push_back(point);
+    }
+    return curve;
+}
+
+struct Strategy
+{
+    const char* name;
+    std::function<std::unique_ptr<_Fitting>(const _Ct&, int, int)> create;
+};
+
+int run_batch(int n_file, char* files[])
+{
+    std::vector<QString> filenames;
+    for (int i = 0; i < n_file; i++)
+    {
+        filenames.emplace_back(files[i]);
+    }
+
+    BatchFittingPipeline pipeline([](const _Ct& c) { return KTPFitting(c, 3, 64).fitting(); });
+    pipeline.run(filenames);
+
+    auto statistics = pipeline.get_statistics();
+    std::printf("loaded %zu files (%zu vertices), fitted %zu, failed %zu in %.3f s\n",
+                statistics.n_loaded, statistics.n_vertex, statistics.n_fitted, statistics.n_failed,
+                statistics.wall_seconds);
+    std::printf("load: %.3f s busy, %.3f s blocked, %.1f files/s per thread\n",
+                statistics.load_seconds, statistics.load_blocked_seconds, statistics.load_throughput());
+    std::printf("fit:  %.3f s busy, %.3f s starved, %.1f curves/s per thread\n",
+                statistics.fit_seconds, statistics.fit_starved_seconds, statistics.fit_throughput());
+    std::printf("overall: %.1f curves/s\n", statistics.overall_throughput());
+    return 0;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc > 1 && std::strcmp(argv[1], "--batch") == 0)
+    {
+        return run_batch(argc - 2, argv + 2);
+    }
+
+    _Ct curve;
+    if (argc > 1)
+    {
+        curve.init_from_file(QString(argv[1]));
+    }
+    else
+    {
+        curve = synthetic_curve(20000);
+    }
+    curve.chordal_parameterization();
+
+    const int degree = 3;
+
+    std::vector<Strategy> strategies = {
+            {"KTP", [](const _Ct& c, int p, int n) { return std::make_unique<KTPFitting>(c, p, n); }},
+            {"DominantPoint", [](const _Ct& c, int p, int n) { return std::make_unique<DominantPointFitting>(c, p, n); }},
+            {"ErrorDriven", [](const _Ct& c, int p, int n) { return std::make_unique<ErrorDrivenFitting>(c, p, n); }},
+    };
+
+    std::printf("%-16s %10s %14s %14s %12s\n", "strategy", "n_ctrlpt", "max_error", "mean_error", "time(ms)");
+
+    for (int n_control_point = 8; n_control_point <= 256; n_control_point *= 2)
+    {
+        if (n_control_point > int(curve.get_vertices().size()))
+        {
+            break;
+        }
+
+        for (const auto& strategy : strategies)
+        {
+            auto fitting = strategy.create(curve, degree, n_control_point);
+
+            auto start = std::chrono::steady_clock::now();
+            auto fitted = fitting->fitting();
+            auto end = std::chrono::steady_clock::now();
+
+            auto error = fitting->fitting_error(fitted);
+            std::printf("%-16s %10d %14.6e %14.6e %12.3f\n", strategy.name, n_control_point,
+                        error.max_error, error.mean_error,
+                        std::chrono::duration<double, std::milli>(end - start).count());
+        }
+    }
+
+    // exact pass-through, the errors are 0 up to rounding, measured at the parameters of the vertices
+    BSplineCurveInterpolation interpolation(curve);
+    std::vector<_Dt> vertex_parameters;
+    for (const auto& vertex : curve.get_vertices())
+    {
+        vertex_parameters.push_back(vertex.trait.u);
+    }
+
+    using _Interpolate = std::function<_Fitting::_Out_Ct(std::vector<_Dt>&)>;
+    std::vector<std::pair<const char*, _Interpolate>> interpolations = {
+            {"GlobalInterp", [&](std::vector<_Dt>& parameters)
+            {
+                parameters = vertex_parameters;
+                return interpolation.global_interpolation(degree);
+            }},
+            {"LocalCubic", [&](std::vector<_Dt>& parameters)
+            {
+                return interpolation.local_cubic_interpolation(&parameters);
+            }},
+    };
+    for (const auto& interpolate : interpolations)
+    {
+        std::vector<_Dt> parameters;
+        auto start = std::chrono::steady_clock::now();
+        auto interpolated = interpolate.second(parameters);
+        auto end = std::chrono::steady_clock::now();
+
+        BSplineEvaluator<_Dt> evaluator(interpolated, 0);
+        const auto& vertices = curve.get_vertices();
+        _Dt max_error = 0, sum_error = 0;
+        for (size_t i = 0; i < vertices.size(); i++)
+        {
+            _Dt error = (evaluator.point(parameters[i]) - vertices[i].vertex).length();
+            max_error = std::max(max_error, error);
+            sum_error += error;
+        }
+
+        std::printf("%-16s %10zu %14.6e %14.6e %12.3f\n", interpolate.first, interpolated.get_control_points().size(),
+                    max_error, sum_error / vertices.size(),
+                    std::chrono::duration<double, std::milli>(end - start).count());
+    }
+
+    return 0;
+}
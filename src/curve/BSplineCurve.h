@@ -5,9 +5,15 @@
 #ifndef B_SPLINE_BSPLINECURVE_H
 #define B_SPLINE_BSPLINECURVE_H
 
+#include <algorithm>
+#include <limits>
+
 #include "base_type/PointTraits.h"
 #include "ParaCurve.h"
+#include "util/ArcLengthTable.h"
+#include "util/BSplineEvaluator.h"
 #include "util/BSplineFunction.h"
+#include "util/KnotVector.h"
 
 template <typename _PointType = CurvePoint<double, BSplinePointTrait<double>>>
 struct BSplineCurve : public ParaCurve<_PointType>
@@ -30,6 +36,15 @@ protected:
     /// knot vector
     std::vector<_Dt> _knots;
 
+    /// control points moved since the vertices were evaluated, cleared by every other change of the control points,
+    /// the knots or the degree, after which the vertices are recalculated rather than updated
+    std::vector<int> _dirty_ctrlpts;
+
+    /// minimum number of Bezier segments processed by a thread
+    static constexpr long _min_segment_grain = 256;
+    /// minimum number of vertices re-evaluated by a thread
+    static constexpr long _min_vertex_grain = 4096;
+
 public:
     BSplineCurve() = default;
 
@@ -38,11 +53,8 @@ public:
     /// \param control_points control points of the B spline
     /// \param knots the knots vector of the B spline
     BSplineCurve(int degree, const std::vector<Vector3X<_Dt>>& control_points, const std::vector<_Dt>& knots)
-        : _degree(degree), _ctrlpts(control_points)
+        : _degree(degree), _ctrlpts(control_points), _knots(KnotVector<_Dt>::normalized(knots))
     {
-        _check_knots_ascending(knots);
-        this->_knots = knots;
-        _normalize_knots(this->_knots);
     }
 
     /// Create B spline curve defined on `control_points`.
@@ -70,6 +82,7 @@ public: // generate curve vertex
         }
 
         _vertices.clear();
+        _dirty_ctrlpts.clear();
 
         BSplineFunction<_Dt> bf(_ctrlpts.size() - 1, _degree, _knots);
 
@@ -100,48 +113,597 @@ public: // generate curve vertex
         delete[] func_values;
     }
 
+    /// Resample the curve with `count` vertices equally spaced by arc length, in parallel. Like
+    /// `recalculate_curve`, the vertices carry their parameters and knot span indices.
+    /// Pre: set `ctrlpts`, `knots` and `degree`
+    /// \param count the number of vertices, at least 2
+    void resample_by_arclength(int count)
+    {
+        ArcLengthTable<_Dt> table(*this);
+        auto parameters = table.equal_arc_length_parameters(count);
+
+        _vertices.resize(count);
+        _dirty_ctrlpts.clear();
+        parallel_for(0, count, [&](long first, long last)
+        {
+            BSplineEvaluator<_Dt> evaluator(*this, 0);
+            for (long i = first; i < last; i++)
+            {
+                _Dt u = parameters[i];
+                int span = evaluator.find_span(u);
+                _vertices[i].vertex = evaluator.point(span, u);
+                _vertices[i].trait.u = u;
+                _vertices[i].trait.span = span;
+            }
+        });
+    }
+
+    /// Re-evaluate in place the vertices in the knot spans affected by `move_control_point` since the vertices were
+    /// evaluated. By local support, moving control point i changes the spans [i, i + p] only; the other vertices are
+    /// not touched. The vertices keep their parameters.
+    /// Pre: the vertices are evaluated by `recalculate_curve` or `resample_by_arclength`, and the knots and the
+    /// degree are not changed since
+    /// \return the number of vertices re-evaluated
+    long update_curve()
+    {
+        if (_dirty_ctrlpts.empty() || _vertices.empty())
+        {
+            _dirty_ctrlpts.clear();
+            return 0;
+        }
+
+        // merge the dirty span ranges [i, i + p]
+        std::sort(_dirty_ctrlpts.begin(), _dirty_ctrlpts.end());
+        std::vector<std::pair<int, int>> ranges;
+        for (int i : _dirty_ctrlpts)
+        {
+            if (!ranges.empty() && i <= ranges.back().second + 1)
+            {
+                ranges.back().second = std::max(ranges.back().second, i + _degree);
+            }
+            else
+            {
+                ranges.emplace_back(i, i + _degree);
+            }
+        }
+        _dirty_ctrlpts.clear();
+
+        // the vertices are ordered by parameter, so by knot span index too
+        auto span_of = [this](long k)
+        {
+            return int(_vertices[k].trait.span);
+        };
+        auto first_vertex = [&](int span)
+        {
+            long low = 0, high = long(_vertices.size());
+            while (low < high)
+            {
+                long mid = (low + high) / 2;
+                if (span_of(mid) < span)
+                {
+                    low = mid + 1;
+                }
+                else
+                {
+                    high = mid;
+                }
+            }
+            return low;
+        };
+
+        long count = 0;
+        for (const auto& range : ranges)
+        {
+            long first = first_vertex(range.first), last = first_vertex(range.second + 1);
+            count += last - first;
+            parallel_for(first, last, [&](long begin, long end)
+            {
+                BSplineEvaluator<_Dt> evaluator(*this, 0);
+                for (long k = begin; k < end; k++)
+                {
+                    _vertices[k].vertex = evaluator.point(span_of(k), _vertices[k].trait.u);
+                }
+            }, _min_vertex_grain);
+        }
+        return count;
+    }
+
     /// Get uniformly distributed knot vector according to control point and degree.
     /// Pre: set `_ctrlpts` and `_degree`
     /// \return uniformly distributed knot vector
     std::vector<_Dt> generate_uniform_knot_vector()
     {
-        // min and max knot vector values
-        _Dt knot_min = _Dt(0.0);
-        _Dt knot_max = _Dt(1.0);
+        return KnotVector<_Dt>::uniform(_degree, int(_ctrlpts.size()));
+    }
+
+public: // geometric operations
+
+    /// Move control point `i` by `delta`. The vertices are not changed until `update_curve`, which re-evaluates the
+    /// affected ones only.
+    /// \param i index of the control point
+    /// \param delta the displacement
+    void move_control_point(int i, const Vector3X<_Dt>& delta)
+    {
+        if (i < 0 || i >= int(_ctrlpts.size()))
+        {
+            throw std::out_of_range("control point index is out of range.");
+        }
+
+        _ctrlpts[i] += delta;
+        _dirty_ctrlpts.push_back(i);
+    }
+
+    /// Insert knot `u` `times` times. The shape of the curve is not changed.
+    /// See: *The NURBS Book* Algorithm A5.1
+    /// \param u the knot to insert, inside the knot vector
+    /// \param times the number of times to insert, the multiplicity of `u` will be no more than the degree
+    void insert_knot(_Dt u, int times = 1)
+    {
+        int n = int(_ctrlpts.size()) - 1;
+        int p = _degree;
+
+        if (u <= _knots[p] || u >= _knots[n + 1])
+        {
+            throw std::out_of_range("the knot to insert is out of the inner knot vector.");
+        }
+
+        BSplineFunction<_Dt> bf(n, p, _knots);
+        int k = bf.find_span(u);
+
+        // multiplicity of u
+        int s = 0;
+        for (int i = k; i >= 0 && _knots[i] == u; i--)
+        {
+            s++;
+        }
+
+        if (times <= 0)
+        {
+            return;
+        }
+        if (times + s > p)
+        {
+            throw std::invalid_argument("multiplicity of the knot would be greater than the degree.");
+        }
+
+        int r = times;
+
+        // load new knot vector
+        std::vector<_Dt> new_knots(_knots.size() + r);
+        for (int i = 0; i <= k; i++)
+        {
+            new_knots[i] = _knots[i];
+        }
+        for (int i = 1; i <= r; i++)
+        {
+            new_knots[k + i] = u;
+        }
+        for (int i = k + 1; i < _knots.size(); i++)
+        {
+            new_knots[i + r] = _knots[i];
+        }
+
+        // save unaltered control points
+        std::vector<Vertex<_Dt>> new_ctrlpts(n + 1 + r);
+        for (int i = 0; i <= k - p; i++)
+        {
+            new_ctrlpts[i] = _ctrlpts[i];
+        }
+        for (int i = k - s; i <= n; i++)
+        {
+            new_ctrlpts[i + r] = _ctrlpts[i];
+        }
+
+        std::vector<Vertex<_Dt>> temp(p + 1);
+        for (int i = 0; i <= p - s; i++)
+        {
+            temp[i] = _ctrlpts[k - p + i];
+        }
+
+        // insert the knot r times
+        int L = 0;
+        for (int j = 1; j <= r; j++)
+        {
+            L = k - p + j;
+            for (int i = 0; i <= p - j - s; i++)
+            {
+                _Dt alpha = (u - _knots[L + i]) / (_knots[i + k + 1] - _knots[L + i]);
+                temp[i] = alpha * temp[i + 1] + (1.0 - alpha) * temp[i];
+            }
+            new_ctrlpts[L] = temp[0];
+            new_ctrlpts[k + r - j - s] = temp[p - j - s];
+        }
+
+        // load remaining control points
+        for (int i = L + 1; i < k - s; i++)
+        {
+            new_ctrlpts[i] = temp[i - L];
+        }
+
+        _knots = std::move(new_knots);
+        _ctrlpts = std::move(new_ctrlpts);
+        _dirty_ctrlpts.clear();
+    }
+
+    /// Insert many knots in one pass. The shape of the curve is not changed.
+    /// See: *The NURBS Book* Algorithm A5.4
+    /// \param new_knots the knots to insert, inside the knot vector, sorted internally; a knot may repeat as long as
+    /// its multiplicity will be no more than the degree
+    void refine_knot_vector(const std::vector<_Dt>& new_knots)
+    {
+        if (new_knots.empty())
+        {
+            return;
+        }
+
+        int n = int(_ctrlpts.size()) - 1;
+        int p = _degree;
+        int m = n + p + 1;
+
+        std::vector<_Dt> x(new_knots);
+        std::sort(x.begin(), x.end());
+        int r = int(x.size()) - 1;
+
+        if (x.front() <= _knots[p] || x.back() >= _knots[n + 1])
+        {
+            throw std::out_of_range("the knot to insert is out of the inner knot vector.");
+        }
+
+        BSplineFunction<_Dt> bf(n, p, _knots);
+        int a = bf.find_span(x.front());
+        int b = bf.find_span(x.back()) + 1;
+
+        std::vector<_Dt> new_knot_vec(m + r + 2);
+        std::vector<Vertex<_Dt>> new_ctrlpts(n + r + 2);
+
+        // unaltered control points and knots
+        for (int j = 0; j <= a - p; j++)
+        {
+            new_ctrlpts[j] = _ctrlpts[j];
+        }
+        for (int j = b - 1; j <= n; j++)
+        {
+            new_ctrlpts[j + r + 1] = _ctrlpts[j];
+        }
+        for (int j = 0; j <= a; j++)
+        {
+            new_knot_vec[j] = _knots[j];
+        }
+        for (int j = b + p; j <= m; j++)
+        {
+            new_knot_vec[j + r + 1] = _knots[j];
+        }
+
+        // insert the knots from the last one
+        int i = b + p - 1;
+        int k = b + p + r;
+        for (int j = r; j >= 0; j--)
+        {
+            while (x[j] <= _knots[i] && i > a)
+            {
+                new_ctrlpts[k - p - 1] = _ctrlpts[i - p - 1];
+                new_knot_vec[k] = _knots[i];
+                k--;
+                i--;
+            }
+            new_ctrlpts[k - p - 1] = new_ctrlpts[k - p];
+            for (int l = 1; l <= p; l++)
+            {
+                int ind = k - p + l;
+                _Dt alpha = new_knot_vec[k + l] - x[j];
+                if (alpha == 0)
+                {
+                    new_ctrlpts[ind - 1] = new_ctrlpts[ind];
+                }
+                else
+                {
+                    alpha = alpha / (new_knot_vec[k + l] - _knots[i - p + l]);
+                    new_ctrlpts[ind - 1] = alpha * new_ctrlpts[ind - 1] + (1.0 - alpha) * new_ctrlpts[ind];
+                }
+            }
+            new_knot_vec[k] = x[j];
+            k--;
+        }
+
+        // multiplicity of the inner knots
+        for (int j = p + 1, s = 1; j <= n + r + 1; j++)
+        {
+            s = new_knot_vec[j] == new_knot_vec[j - 1] ? s + 1 : 1;
+            if (s > p)
+            {
+                throw std::invalid_argument("multiplicity of the knot would be greater than the degree.");
+            }
+        }
+
+        _knots = std::move(new_knot_vec);
+        _ctrlpts = std::move(new_ctrlpts);
+        _dirty_ctrlpts.clear();
+    }
+
+    /// Split the curve at `u` into two curves, each reparameterized to [0, 1].
+    /// \param u the parameter to split at, inside the knot vector
+    /// \param left the curve over [start, u]
+    /// \param right the curve over [u, end]
+    void split(_Dt u, BSplineCurve& left, BSplineCurve& right) const
+    {
+        int n = int(_ctrlpts.size()) - 1;
+        int p = _degree;
+
+        if (u <= _knots[p] || u >= _knots[n + 1])
+        {
+            throw std::out_of_range("the parameter to split at is out of the inner knot vector.");
+        }
+
+        // multiplicity of u
+        int s = int(std::count(_knots.begin(), _knots.end(), u));
+
+        // the B spline only, without the vertices
+        BSplineCurve curve;
+        curve._degree = p;
+        curve._ctrlpts = _ctrlpts;
+        curve._knots = _knots;
+        curve.refine_knot_vector(std::vector<_Dt>(std::max(p - s, 0), u));
+
+        // u is at [k - p + 1, k] of the refined knot vector
+        const auto& knots = curve._knots;
+        const auto& ctrlpts = curve._ctrlpts;
+        int k = int(std::upper_bound(knots.begin(), knots.end(), u) - knots.begin()) - 1;
 
+        std::vector<_Dt> left_knots(knots.begin(), knots.begin() + k + 1);
+        left_knots.push_back(u);
+        left = BSplineCurve(p, std::vector<Vertex<_Dt>>(ctrlpts.begin(), ctrlpts.begin() + k - p + 1), left_knots);
+
+        std::vector<_Dt> right_knots(1, u);
+        right_knots.insert(right_knots.end(), knots.begin() + k - p + 1, knots.end());
+        right = BSplineCurve(p, std::vector<Vertex<_Dt>>(ctrlpts.begin() + k - p, ctrlpts.end()), right_knots);
+    }
+
+    /// Remove knot `u` up to `times` times, as long as each removal moves the curve no more than `tolerance`.
+    /// See: *The NURBS Book* Algorithm A5.8
+    /// \param u the knot to remove, an inner knot of the knot vector
+    /// \param times the number of times to remove
+    /// \param tolerance max deviation of the curve per removal
+    /// \return the number of times actually removed
+    int remove_knot(_Dt u, int times = 1, _Dt tolerance = _Dt(1e-9))
+    {
         int n = int(_ctrlpts.size()) - 1;
+        int p = _degree;
+
+        if (u <= _knots[p] || u >= _knots[n + 1])
+        {
+            throw std::out_of_range("the knot to remove is out of the inner knot vector.");
+        }
 
-        // equation to use: m = n + p + 1
-        // p: _degree, n + 1: number of control points; m + 1: number of knots
-        int m = _degree + n + 1;
+        // last index of u
+        int r = n;
+        while (r > p && _knots[r] != u)
+        {
+            r--;
+        }
+        if (_knots[r] != u)
+        {
+            throw std::invalid_argument("the knot to remove is not in the knot vector.");
+        }
 
-        // calculate a uniform interval for middle knots
-        // number of segments in the middle
-        int num_segments = (m - (_degree + 1) * 2) + 2;
-        // spacing between the knots (uniform)
-        _Dt spacing = (knot_max - knot_min) / num_segments;
+        int removed = 0;
+        _Dt error;
+        while (removed < times && _remove_knot_once(r, tolerance, error))
+        {
+            removed++;
+            r--;
+        }
+        return removed;
+    }
 
-        std::vector<_Dt> knot_vector(m + 1);
+    /// Remove as many inner knots as possible while the curve stays within `tolerance` of the original one.
+    /// Every removal is tested with *The NURBS Book* Algorithm A5.8, and its error is accumulated on the knot spans
+    /// it changes, so the bound holds for the whole sequence of removals.
+    /// \param tolerance max deviation of the curve
+    /// \return bound of the deviation of the curve, no more than `tolerance`
+    _Dt remove_knots(_Dt tolerance)
+    {
+        int p = _degree;
 
-        // first _degree + 1 knots are `knot_min`
-        for (int i = 0; i <= _degree; i++)
+        // error bound of every knot span [u_i, u_{i+1})
+        std::vector<_Dt> span_error(_knots.size() - 1, _Dt(0.0));
+
+        bool removed = true;
+        while (removed)
         {
-            knot_vector[i] = knot_min;
+            removed = false;
+            for (int r = p + 1; r < int(_ctrlpts.size());)
+            {
+                // try the last one of the equal knots only
+                if (_knots[r] == _knots[r + 1])
+                {
+                    r++;
+                    continue;
+                }
+
+                int s = 0;
+                for (int i = r; _knots[i] == _knots[r]; i--)
+                {
+                    s++;
+                }
+
+                // spans covered by the modified control points [r - p, r - s]
+                int first_span = r - p, last_span = std::min(r - s + p, int(span_error.size()) - 1);
+                _Dt bound = *std::max_element(span_error.begin() + first_span, span_error.begin() + last_span + 1);
+
+                _Dt error;
+                if (!_remove_knot_once(r, tolerance - bound, error))
+                {
+                    r++;
+                    continue;
+                }
+                removed = true;
+
+                for (int i = first_span; i <= last_span; i++)
+                {
+                    span_error[i] += error;
+                }
+                span_error[r - 1] = std::max(span_error[r - 1], span_error[r]);
+                span_error.erase(span_error.begin() + r);
+
+                // the remaining copies of the knot end at r - 1, the next knot moves to r
+                if (s > 1)
+                {
+                    r--;
+                }
+            }
         }
 
-        // middle knots
-        for (int i = _degree + 1; i <= n; i++)
+        return span_error.empty() ? _Dt(0.0) : *std::max_element(span_error.begin(), span_error.end());
+    }
+
+    /// Decompose the curve into Bezier segments, one per non-empty knot span. The curve is not changed.
+    /// The knot vector must be clamped, as the generated ones are.
+    /// See: *The NURBS Book* Algorithm A5.6
+    /// \param segments control points of the segments, degree + 1 each
+    /// \param breakpoints parameters of the ends of the segments, one more than the segments
+    void decompose_to_bezier(std::vector<std::vector<Vertex<_Dt>>>& segments, std::vector<_Dt>& breakpoints) const
+    {
+        int p = _degree;
+        int m = int(_knots.size()) - 1;
+
+        segments.assign(1, std::vector<Vertex<_Dt>>(_ctrlpts.begin(), _ctrlpts.begin() + p + 1));
+        breakpoints.assign(1, _knots[p]);
+
+        std::vector<_Dt> alphas(p);
+        int a = p, b = p + 1;
+        while (b < m)
         {
-            knot_vector[i] = spacing * (i - _degree);
+            int i = b;
+            while (b < m && _knots[b + 1] == _knots[b])
+            {
+                b++;
+            }
+            int mult = b - i + 1;
+
+            if (b < m)
+            {
+                segments.emplace_back(p + 1);
+            }
+            auto& segment = segments[segments.size() - (b < m ? 2 : 1)];
+
+            // insert the knot up to multiplicity p, the points overlapping the next segment are saved into it
+            if (mult < p)
+            {
+                _Dt numer = _knots[b] - _knots[a];
+                for (int j = p; j > mult; j--)
+                {
+                    alphas[j - mult - 1] = numer / (_knots[a + j] - _knots[a]);
+                }
+                int r = p - mult;
+                for (int j = 1; j <= r; j++)
+                {
+                    int save = r - j;
+                    int s = mult + j;
+                    for (int k = p; k >= s; k--)
+                    {
+                        _Dt alpha = alphas[k - s];
+                        segment[k] = alpha * segment[k] + (1.0 - alpha) * segment[k - 1];
+                    }
+                    if (b < m)
+                    {
+                        segments.back()[save] = segment[p];
+                    }
+                }
+            }
+            breakpoints.push_back(_knots[b]);
+
+            if (b < m)
+            {
+                for (int k = p - mult; k <= p; k++)
+                {
+                    segments.back()[k] = _ctrlpts[b - p + k];
+                }
+                a = b;
+                b++;
+            }
         }
+    }
 
-        // Last _degree+1 knots are `knot_max`
-        for (int i = n + 1; i <= m; i++)
+    /// Elevate the degree of the curve by `times`. The shape and the continuity of the curve are not changed.
+    /// The curve is decomposed into Bezier segments, which are elevated in parallel, then the knots added by the
+    /// decomposition are removed. The result is the one of *The NURBS Book* Algorithm A5.9.
+    /// \param times the number of degrees to elevate
+    void elevate_degree(int times = 1)
+    {
+        if (times < 0)
+        {
+            throw std::invalid_argument("the degree cannot be elevated negative times.");
+        }
+        if (times == 0)
         {
-            knot_vector[i] = knot_max;
+            return;
         }
 
-        return knot_vector;
+        std::vector<std::vector<Vertex<_Dt>>> segments;
+        std::vector<_Dt> breakpoints;
+        decompose_to_bezier(segments, breakpoints);
+
+        parallel_for(0, long(segments.size()), [&](long first, long last)
+        {
+            for (long i = first; i < last; i++)
+            {
+                segments[i] = _elevate_bezier(segments[i], times);
+            }
+        }, _min_segment_grain);
+
+        // multiplicity s of an inner knot becomes s + times
+        auto multiplicity = _inner_multiplicity(breakpoints);
+        int p = _degree;
+        _compose_bezier(segments, breakpoints, p + times);
+        // these knots are removable by construction, the round-off of the removal grows with the coordinates, so no
+        // absolute tolerance is checked
+        for (size_t i = 1; i + 1 < breakpoints.size(); i++)
+        {
+            remove_knot(breakpoints[i], p - multiplicity[i], std::numeric_limits<_Dt>::infinity());
+        }
+    }
+
+    /// Reduce the degree of the curve by one, if it stays within `tolerance` of the original one.
+    /// The curve is decomposed into Bezier segments, which are reduced in parallel with the error bounds of *The
+    /// NURBS Book* Section 5.6, then the knots are removed as long as the accumulated bound allows, as Algorithm
+    /// A5.11 does.
+    /// \param tolerance max deviation of the curve
+    /// \param error_bound bound of the deviation of the curve if reduced, may be nullptr
+    /// \return false if the curve cannot be reduced within `tolerance`, the curve is not changed then
+    bool reduce_degree(_Dt tolerance, _Dt* error_bound = nullptr)
+    {
+        if (_degree < 2)
+        {
+            throw std::logic_error("the degree of the curve is too low to reduce.");
+        }
+
+        std::vector<std::vector<Vertex<_Dt>>> segments;
+        std::vector<_Dt> breakpoints;
+        decompose_to_bezier(segments, breakpoints);
+
+        std::vector<_Dt> errors(segments.size());
+        parallel_for(0, long(segments.size()), [&](long first, long last)
+        {
+            for (long i = first; i < last; i++)
+            {
+                errors[i] = _reduce_bezier(segments[i]);
+            }
+        }, _min_segment_grain);
+
+        _Dt error = *std::max_element(errors.begin(), errors.end());
+        if (error > tolerance)
+        {
+            return false;
+        }
+
+        _compose_bezier(segments, breakpoints, _degree - 1);
+        error += remove_knots(tolerance - error);
+
+        if (error_bound != nullptr)
+        {
+            *error_bound = error;
+        }
+        return true;
     }
 
 public: // getter and setter
@@ -158,6 +720,7 @@ public: // getter and setter
     void set_degree(int degree)
     {
         this->_degree = degree;
+        _dirty_ctrlpts.clear();
     }
 
     /// Get the knot vector of the B spline curve.
@@ -171,9 +734,8 @@ public: // getter and setter
     /// \param knots knot vector
     void set_knot_vector(const std::vector<_Dt>& knots)
     {
-        _check_knots_ascending(knots);
-        this->_knots = knots;
-        _normalize_knots(this->_knots);
+        this->_knots = KnotVector<_Dt>::normalized(knots);
+        _dirty_ctrlpts.clear();
     }
 
     /// Get the control points of the B spline curve.
@@ -188,44 +750,186 @@ public: // getter and setter
     void set_control_points(const std::vector<Vector3X<_Dt>>& control_points)
     {
         this->_ctrlpts = control_points;
+        _dirty_ctrlpts.clear();
     }
 
 protected:
 
-    void _check_knots_ascending(const std::vector<_Dt>& knot_vec)
+    /// Remove the inner knot at index `r`, the last one of the equal knots, if the curve moves no more than
+    /// `tolerance`.
+    /// See: *The NURBS Book* Algorithm A5.8
+    /// \param r index of the knot
+    /// \param tolerance max deviation of the curve
+    /// \param error deviation of the curve caused by the removal
+    /// \return whether the knot is removed
+    bool _remove_knot_once(int r, _Dt tolerance, _Dt& error)
     {
-        _Dt last_knot = knot_vec[0];
-        for (int i = 1; i < knot_vec.size(); i++)
+        int p = _degree;
+        int ord = p + 1;
+        _Dt u = _knots[r];
+
+        int s = 0;
+        for (int i = r; i >= 0 && _knots[i] == u; i--)
         {
-            if (last_knot > knot_vec[i])
-            {
-                throw std::logic_error("the knot vector is not ascending.");
-            }
+            s++;
+        }
+
+        int first = r - p, last = r - s;
+        int off = first - 1;
+
+        // new control points computed from both ends
+        std::vector<Vertex<_Dt>> temp(last - off + 2);
+        temp[0] = _ctrlpts[off];
+        temp[last + 1 - off] = _ctrlpts[last + 1];
+
+        int i = first, j = last;
+        int ii = 1, jj = last - off;
+        while (j - i > 0)
+        {
+            _Dt alfi = (u - _knots[i]) / (_knots[i + ord] - _knots[i]);
+            _Dt alfj = (u - _knots[j]) / (_knots[j + ord] - _knots[j]);
+            temp[ii] = (_ctrlpts[i] - (1.0 - alfi) * temp[ii - 1]) / alfi;
+            temp[jj] = (_ctrlpts[j] - alfj * temp[jj + 1]) / (1.0 - alfj);
+            i++;
+            ii++;
+            j--;
+            jj--;
+        }
+
+        // the two ends must meet
+        if (j - i < 0)
+        {
+            error = (temp[ii - 1] - temp[jj + 1]).length();
+        }
+        else
+        {
+            _Dt alfi = (u - _knots[i]) / (_knots[i + ord] - _knots[i]);
+            error = (_ctrlpts[i] - (alfi * temp[ii + 1] + (1.0 - alfi) * temp[ii - 1])).length();
         }
+
+        if (!(error <= tolerance))
+        {
+            return false;
+        }
+
+        i = first;
+        j = last;
+        while (j - i > 0)
+        {
+            _ctrlpts[i] = temp[i - off];
+            _ctrlpts[j] = temp[j - off];
+            i++;
+            j--;
+        }
+
+        int fout = (2 * r - s - p) / 2;
+        _knots.erase(_knots.begin() + r);
+        _ctrlpts.erase(_ctrlpts.begin() + fout);
+        _dirty_ctrlpts.clear();
+
+        return true;
     }
 
-    void _normalize_knots(std::vector<_Dt>& knot_vec)
+    /// Multiplicity of the inner breakpoints in the knot vector, indexed as `breakpoints`.
+    std::vector<int> _inner_multiplicity(const std::vector<_Dt>& breakpoints) const
     {
-        if (knot_vec.size() < 2)
+        std::vector<int> multiplicity(breakpoints.size(), 0);
+        for (size_t i = 1; i + 1 < breakpoints.size(); i++)
         {
-            return;
+            auto range = std::equal_range(_knots.begin(), _knots.end(), breakpoints[i]);
+            multiplicity[i] = int(range.second - range.first);
         }
-        _Dt knot_min = knot_vec[0], knot_max = knot_vec[knot_vec.size() - 1];
-        _Dt knot_range = knot_max - knot_min;
+        return multiplicity;
+    }
 
-        if (std::abs(knot_range) == 0.0)
+    /// Replace the B spline by Bezier segments joined with C0 continuity.
+    void _compose_bezier(const std::vector<std::vector<Vertex<_Dt>>>& segments, const std::vector<_Dt>& breakpoints,
+                         int degree)
+    {
+        _degree = degree;
+        _knots.assign(degree + 1, breakpoints.front());
+        _ctrlpts.assign(segments.front().begin(), segments.front().end());
+        for (size_t i = 1; i < segments.size(); i++)
         {
-            for (int i = 0; i < knot_vec.size(); i++)
+            _knots.insert(_knots.end(), degree, breakpoints[i]);
+            _ctrlpts.insert(_ctrlpts.end(), segments[i].begin() + 1, segments[i].end());
+        }
+        _knots.insert(_knots.end(), degree + 1, breakpoints.back());
+        _dirty_ctrlpts.clear();
+    }
+
+    /// Elevate a Bezier segment `times` degrees.
+    /// See: *The NURBS Book* Equation 5.36
+    static std::vector<Vertex<_Dt>> _elevate_bezier(const std::vector<Vertex<_Dt>>& points, int times)
+    {
+        int p = int(points.size()) - 1;
+        int ph = p + times;
+
+        std::vector<Vertex<_Dt>> elevated(ph + 1);
+        for (int i = 0; i <= ph; i++)
+        {
+            for (int j = std::max(0, i - times); j <= std::min(p, i); j++)
             {
-                knot_vec[i] = 1.0;
+                _Dt coef = _binomial(p, j) * _binomial(times, i - j) / _binomial(ph, i);
+                elevated[i] += coef * points[j];
             }
-            return;
         }
+        return elevated;
+    }
+
+    /// Reduce a Bezier segment one degree, from both ends towards the middle.
+    /// See: *The NURBS Book* Equations 5.41 - 5.44
+    /// \param points control points of the segment, replaced by the reduced ones
+    /// \return bound of the deviation of the segment: the max distance between the control points and the ones
+    /// elevated back, by the convex hull property
+    static _Dt _reduce_bezier(std::vector<Vertex<_Dt>>& points)
+    {
+        int p = int(points.size()) - 1;
+        int r = (p - 1) / 2;
+        auto alpha = [p](int i)
+        {
+            return _Dt(i) / p;
+        };
 
-        for (int i = 0; i < knot_vec.size(); i++)
+        std::vector<Vertex<_Dt>> reduced(p);
+        reduced[0] = points[0];
+        reduced[p - 1] = points[p];
+
+        int last_forward = p % 2 == 0 ? r : r - 1;
+        for (int i = 1; i <= last_forward; i++)
+        {
+            reduced[i] = (points[i] - alpha(i) * reduced[i - 1]) / (1 - alpha(i));
+        }
+        for (int i = p - 2; i >= r + 1; i--)
+        {
+            reduced[i] = (points[i + 1] - (1 - alpha(i + 1)) * reduced[i + 1]) / alpha(i + 1);
+        }
+        if (p % 2 == 1)
+        {
+            auto left = (points[r] - alpha(r) * reduced[r - 1]) / (1 - alpha(r));
+            auto right = (points[r + 1] - (1 - alpha(r + 1)) * reduced[r + 1]) / alpha(r + 1);
+            reduced[r] = (left + right) * _Dt(0.5);
+        }
+
+        auto elevated = _elevate_bezier(reduced, 1);
+        _Dt error = 0;
+        for (int i = 0; i <= p; i++)
+        {
+            error = std::max(error, (elevated[i] - points[i]).length());
+        }
+
+        points = std::move(reduced);
+        return error;
+    }
+
+    static _Dt _binomial(int n, int k)
+    {
+        _Dt value = 1;
+        for (int i = 1; i <= k; i++)
         {
-            knot_vec[i] = (knot_vec[i] - knot_min) / knot_range;
+            value = value * (n - k + i) / i;
         }
+        return value;
     }
 };
 
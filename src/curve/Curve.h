@@ -14,20 +14,34 @@
 
 #include "base_type/utility.h"
 #include "base_type/BoundBox.h"
-
-template <typename _CurvePoint = CurvePoint<double, BasePointTrait<double>>>
+#include "base_type/CurveStatistics.h"
+#include "base_type/VertexStorage.h"
+#include "util/Parallel.h"
+
+/**
+ * Curve consisting of vertices.
+ * @tparam _CurvePoint curve point type
+ * @tparam _VertexStorage storage policy of the vertices, `AoSStorage` (default) or `SoAStorage`
+ */
+template <typename _CurvePoint = CurvePoint<double, BasePointTrait<double>>, typename _VertexStorage = AoSStorage>
 class Curve
 {
 public:
     using _Pt = _CurvePoint;
     using _Tr = typename _CurvePoint::_Tr;
     using _Dt = typename _Pt::_Dt;
+    using _Storage = _VertexStorage;
+    /// container of the vertices, `std::vector<_Pt>` or `SoAVertexArray<_Pt>`
+    using _Vertices = typename _Storage::template container<_Pt>;
+
+    /// whether the vertices are stored as a structure of arrays
+    static constexpr bool is_soa = std::is_same<_Storage, SoAStorage>::value;
 
 // ----------- filed -----------
 
 protected:
     /// vertices of the curve
-    std::vector<_Pt> _vertices;
+    _Vertices _vertices;
 
     /// is periodic curve
     bool _is_periodic = false;
@@ -35,6 +49,12 @@ protected:
     /// the normalized bound box of the curve
     BoundBox<_Dt> _box;
 
+    /// the transform normalizing the vertices read from the file
+    NormalizeTransform<_Dt> _transform;
+
+    /// minimum number of vertices of a chunk processed by a thread
+    static constexpr long _min_grain = 1 << 16;
+
 private:
     /// I/O
     CurveIO<_Pt> _io;
@@ -54,20 +74,38 @@ public: // constructors and destructor
 public:
 
     /// Read curve module from file, then initialize properties.
+    /// The statistics of the vertices (bound box, max adjacent gap) are computed in one pass, then the vertices are
+    /// normalized in another, both in parallel for large curves.
     /// \param filename filename of the curve module
     /// \param normalize is normalize the curve to [-1, 1]^3, default true
     void init_from_file(const QString& filename, bool normalize = true)
     {
         _read_from_file(filename);
 
+        _transform = NormalizeTransform<_Dt>();
+        _is_periodic = false;
+
+        if (_vertices.empty())
+        {
+            return;
+        }
+
+        auto statistics = _cal_statistics();
+
         if (normalize)
         {
-            _normalize();
+            _transform = statistics.normalize_transform();
+            _apply_transform(_transform);
         }
 
-        _box = _cal_bound_box();
+        _box = _transform.apply(statistics.box);
 
-        _check_periodic();
+        // the transform is a uniform scaling, so the comparison of distances is not changed
+        _is_periodic = statistics.is_periodic();
+        if (_is_periodic)
+        {
+            _vertices.push_back(_vertices[0]);
+        }
     }
 
 public: // getter & setter
@@ -79,111 +117,155 @@ public: // getter & setter
         return _box;
     }
 
+    /// Whether the curve is periodic. The first vertex of a periodic curve is repeated at the end.
+    /// \return is periodic
+    bool is_periodic() const
+    {
+        return _is_periodic;
+    }
+
+    /// Get the transform applied to the vertices read from the file, identity if they are not normalized.
+    /// Use `invert` to map the vertices, or control points fitted on them, back to the original coordinates.
+    /// \return the normalization transform
+    const NormalizeTransform<_Dt>& get_normalize_transform() const
+    {
+        return _transform;
+    }
+
     /// Get the vertices of the curve
     /// \return the vertices
-    const std::vector<_Pt>& get_vertices() const
+    const _Vertices& get_vertices() const
     {
         return _vertices;
     }
 
     /// Get the vertices of the curve
     /// \return the vertices
-    std::vector<_Pt>& get_vertices()
+    _Vertices& get_vertices()
     {
         return _vertices;
     }
 
 protected:
 
-    /// Check whether the curve is periodic.
-    /// Someone think the distance between double end should be greater than the maximum gap between all the adjacent
-    /// points, we adopt this opinion.
-    void _check_periodic()
+    /// Compute the statistics of the vertices: bound box, max gap between adjacent vertices and both ends.
+    /// Chunks of the vertices are reduced in parallel, then merged in order.
+    /// \return the statistics
+    CurveStatistics<_Dt> _cal_statistics() const
     {
-        double max_dist = 0, dist;
-        for (int i = 1; i < _vertices.size(); i++)
+        long num_v = long(_vertices.size());
+        unsigned n_chunk = parallel_chunk_count(num_v, _min_grain);
+
+        std::vector<CurveStatistics<_Dt>> chunks(n_chunk);
+        parallel_for_chunk(0, num_v, n_chunk, [&](unsigned chunk, long first, long last)
         {
-            dist = (_vertices[i].vertex - _vertices[i - 1].vertex).squared_length();
-            if (max_dist < dist)
+            if constexpr (is_soa)
             {
-                max_dist = dist;
+                const _Dt* x = _vertices.x();
+                const _Dt* y = _vertices.y();
+                const _Dt* z = _vertices.z();
+                chunks[chunk] = _cal_statistics(first, last, [=](long i) { return Vertex<_Dt>(x[i], y[i], z[i]); });
             }
-        }
-
-        dist = (_vertices[0].vertex - _vertices.back().vertex).squared_length();
-        if (dist <= max_dist)
-        {
-            _is_periodic = true;
-        }
+            else
+            {
+                const _Pt* v = _vertices.data();
+                chunks[chunk] = _cal_statistics(first, last, [=](long i) { return v[i].vertex; });
+            }
+        });
 
-        // add 3 points to make C2 continuous
-        if (_is_periodic)
+        CurveStatistics<_Dt> statistics;
+        for (const auto& chunk : chunks)
         {
-            _vertices.push_back(_vertices[0]);
-//            _vertices.push_back(_vertices[1]);
-//            _vertices.push_back(_vertices[2]);
+            statistics.merge(chunk);
         }
+        return statistics;
     }
 
-    /// Calculate bounded box of the curve.
-    /// \return box the bound box
-    BoundBox<_Dt> _cal_bound_box() const
+    /// Compute the statistics of the vertices in [`first`, `last`), which is not empty.
+    /// \param vertex_at accessor of the vertex at an index
+    template <typename _Accessor>
+    static CurveStatistics<_Dt> _cal_statistics(long first, long last, _Accessor vertex_at)
     {
-        BoundBox<_Dt> box;
-
-        // extract bound box
-        auto x_min = std::numeric_limits<_Dt>::max(), x_max = _Dt(0),
-             y_min = std::numeric_limits<_Dt>::max(), y_max = _Dt(0),
-             z_min = std::numeric_limits<_Dt>::max(), z_max = _Dt(0);
-
-        for (const auto& vertex : _vertices)
+        // plain min/max and gap reductions in local variables, without branches on the loop
+        auto prev = vertex_at(first);
+        _Dt x_min = prev.x, x_max = prev.x,
+            y_min = prev.y, y_max = prev.y,
+            z_min = prev.z, z_max = prev.z;
+        _Dt max_gap = _Dt(0.0);
+
+        for (long i = first + 1; i < last; i++)
         {
-            x_min = vertex.vertex.x < x_min ? vertex.vertex.x : x_min;
-            x_max = vertex.vertex.x > x_max ? vertex.vertex.x : x_max;
-
-            y_min = vertex.vertex.y < y_min ? vertex.vertex.y : y_min;
-            y_max = vertex.vertex.y > y_max ? vertex.vertex.y : y_max;
-
-            z_min = vertex.vertex.z < z_min ? vertex.vertex.z : z_min;
-            z_max = vertex.vertex.z > z_max ? vertex.vertex.z : z_max;
+            auto v = vertex_at(i);
+            x_min = v.x < x_min ? v.x : x_min;
+            x_max = v.x > x_max ? v.x : x_max;
+            y_min = v.y < y_min ? v.y : y_min;
+            y_max = v.y > y_max ? v.y : y_max;
+            z_min = v.z < z_min ? v.z : z_min;
+            z_max = v.z > z_max ? v.z : z_max;
+
+            _Dt gap = (v - prev).squared_length();
+            max_gap = gap > max_gap ? gap : max_gap;
+            prev = v;
         }
 
-        box.x_max = x_max;
-        box.x_min = x_min;
-        box.y_max = y_max;
-        box.y_min = y_min;
-        box.z_max = z_max;
-        box.z_min = z_min;
-
-        return box;
+        CurveStatistics<_Dt> statistics;
+        statistics.count = size_t(last - first);
+        statistics.box = BoundBox<_Dt>{x_min, x_max, y_min, y_max, z_min, z_max};
+        statistics.max_squared_gap = max_gap;
+        statistics.first = vertex_at(first);
+        statistics.last = prev;
+        return statistics;
     }
 
-    /// Normalize the curve
-    void _normalize()
+    /// Transform the vertices in place, in parallel for large curves.
+    /// \param transform the transform
+    void _apply_transform(const NormalizeTransform<_Dt>& transform)
     {
-        auto origin_box = _cal_bound_box();
-
-        auto x_mid = (origin_box.x_min + origin_box.x_max) / 2.0,
-             y_mid = (origin_box.y_min + origin_box.y_max) / 2.0,
-             z_mid = (origin_box.z_min + origin_box.z_max) / 2.0;
+        auto center = transform.center;
+        auto scale = transform.scale;
 
-        auto x_length = (origin_box.x_max - origin_box.x_min) / 2.0,
-             y_length = (origin_box.y_max - origin_box.y_min) / 2.0,
-             z_length = (origin_box.z_max - origin_box.z_min) / 2.0;
-
-        x_length = x_length == 0.0 ? 0.5 : x_length;
-        y_length = y_length == 0.0 ? 0.5 : y_length;
-        z_length = z_length == 0.0 ? 0.5 : z_length;
-
-        auto max_length = x_length;
-        max_length = y_length > max_length ? y_length : max_length;
-        max_length = z_length > max_length ? z_length : max_length;
+        parallel_for(0, long(_vertices.size()), [&](long first, long last)
+        {
+            if constexpr (is_soa)
+            {
+                // one array at a time
+                _Dt* arrays[3] = {_vertices.x(), _vertices.y(), _vertices.z()};
+                _Dt offsets[3] = {center.x, center.y, center.z};
+                for (int c = 0; c < 3; c++)
+                {
+                    _Dt* a = arrays[c];
+                    _Dt offset = offsets[c];
+                    for (long i = first; i < last; i++)
+                    {
+                        a[i] = (a[i] - offset) / scale;
+                    }
+                }
+            }
+            else
+            {
+                for (long i = first; i < last; i++)
+                {
+                    auto& v = _vertices[i].vertex;
+                    v.x = (v.x - center.x) / scale;
+                    v.y = (v.y - center.y) / scale;
+                    v.z = (v.z - center.z) / scale;
+                }
+            }
+        }, _min_grain);
+    }
 
-        for (auto& vertex : _vertices)
+    /// Get the vertex at index `i`, regardless of the storage.
+    /// \param i the index
+    /// \return the vertex
+    Vertex<_Dt> _vertex_at(size_t i) const
+    {
+        if constexpr (is_soa)
+        {
+            return Vertex<_Dt>(_vertices.x()[i], _vertices.y()[i], _vertices.z()[i]);
+        }
+        else
         {
-            vertex.vertex.x = (vertex.vertex.x - x_mid) / max_length;
-            vertex.vertex.y = (vertex.vertex.y - y_mid) / max_length;
-            vertex.vertex.z = (vertex.vertex.z - z_mid) / max_length;
+            return _vertices[i].vertex;
         }
     }
 
@@ -0,0 +1,182 @@
+//
+// Created by haochuanchen on 18-6-4.
+//
+
+#ifndef B_SPLINE_NURBSCURVE_H
+#define B_SPLINE_NURBSCURVE_H
+
+#include "BSplineCurve.h"
+#include "base_type/Vector4X.h"
+#include "util/NURBSEvaluator.h"
+
+/// Rational B spline (NURBS) curve, a B spline curve with a weight per control point.
+/// The weighted control points are kept in homogeneous coordinates, so evaluation is the one of a non-rational B
+/// spline in 4D followed by a projection, see `NURBSEvaluator`.
+template <typename _PointType = CurvePoint<double, BSplinePointTrait<double>>>
+struct NURBSCurve : public ParaCurve<_PointType>
+{
+    using _Dt = typename _PointType::_Dt;
+    using _Pt = _PointType;
+    using _Base = ParaCurve<_Pt>;
+
+    static_assert(std::is_base_of<BSplinePointTrait<_Dt>, typename _Pt::_Tr>::value);
+
+protected:
+
+    using _Base::_vertices;
+
+    /// control points of the B spline
+    std::vector<Vertex<_Dt>> _ctrlpts;
+    /// weights of the control points
+    std::vector<_Dt> _weights;
+    /// control points in homogeneous coordinates (wx, wy, wz, w)
+    std::vector<Vector4X<_Dt>> _ctrlpts_w;
+    /// degree(order - 1) of the B spline
+    int _degree;
+    /// knot vector
+    std::vector<_Dt> _knots;
+
+public:
+    NURBSCurve() = default;
+
+    /// Create NURBS curve defined on weighted `control_points` and knot vector(`knots`).
+    /// \param degree degree(order - 1) of the B spline
+    /// \param control_points control points of the B spline
+    /// \param weights weights of the control points, positive
+    /// \param knots the knots vector of the B spline, normalized as `BSplineCurve` does
+    NURBSCurve(int degree, const std::vector<Vector3X<_Dt>>& control_points, const std::vector<_Dt>& weights,
+               const std::vector<_Dt>& knots)
+        : _degree(degree), _knots(KnotVector<_Dt>::normalized(knots))
+    {
+        set_control_points(control_points, weights);
+    }
+
+    /// Create NURBS curve defined on weighted `control_points`, with the uniform knot vector of `BSplineCurve`.
+    /// \param degree degree(order - 1) of the B spline
+    /// \param control_points control points of the B spline
+    /// \param weights weights of the control points, positive
+    NURBSCurve(int degree, const std::vector<Vector3X<_Dt>>& control_points, const std::vector<_Dt>& weights)
+        : _degree(degree), _knots(KnotVector<_Dt>::uniform(degree, int(control_points.size())))
+    {
+        set_control_points(control_points, weights);
+    }
+
+    /// Create NURBS curve of the same shape as a B spline curve, all weights are 1.
+    /// \param curve the B spline curve
+    explicit NURBSCurve(const BSplineCurve<_Pt>& curve)
+        : _degree(curve.get_degree()), _knots(curve.get_knot_vector())
+    {
+        set_control_points(curve.get_control_points(),
+                           std::vector<_Dt>(curve.get_control_points().size(), _Dt(1.0)));
+    }
+
+public: // generate curve vertex
+
+    /// Recalculate NURBS curve point. After all properties, including control points, weights, knot vector and
+    /// degree, have been set, call this method to update curve.
+    /// See: *The NURBS Book* Algorithm A4.1
+    /// \param sample_rate sample rate
+    void recalculate_curve(_Dt sample_rate = _Dt(0.01)) override
+    {
+        if (sample_rate <= 0)
+        {
+            throw std::invalid_argument("sample rate must be greater than zero but less than 1.0.");
+        }
+
+        _vertices.clear();
+
+        NURBSEvaluator<_Dt> evaluator(*this, 0);
+        _Pt point;
+
+        int count = 0;
+        for (_Dt u = sample_rate * count, end = _knots[_knots.size() - 1]; u <= end; u = sample_rate * count)
+        {
+            auto span = evaluator.find_span(u);
+            point.vertex = evaluator.point(span, u);
+            point.trait.u = u;
+            point.trait.span = span;
+            _vertices.emplace_back(point);
+
+            count++;
+        }
+    }
+
+public: // getter and setter
+
+    /// Get the degree of the NURBS curve
+    /// \return degree of the curve
+    int get_degree() const
+    {
+        return _degree;
+    }
+
+    /// Set the degree of the NURBS curve
+    /// \param degree
+    void set_degree(int degree)
+    {
+        _degree = degree;
+    }
+
+    /// Get the knot vector of the NURBS curve.
+    /// \return knot vector
+    const std::vector<_Dt>& get_knot_vector() const
+    {
+        return _knots;
+    }
+
+    /// Set knot vector of the NURBS curve. The knot vector will be normalized automatically.
+    /// \param knots knot vector
+    void set_knot_vector(const std::vector<_Dt>& knots)
+    {
+        _knots = KnotVector<_Dt>::normalized(knots);
+    }
+
+    /// Get the control points of the NURBS curve.
+    /// \return control points
+    const std::vector<Vector3X<_Dt>>& get_control_points() const
+    {
+        return _ctrlpts;
+    }
+
+    /// Get the weights of the control points.
+    /// \return weights
+    const std::vector<_Dt>& get_weights() const
+    {
+        return _weights;
+    }
+
+    /// Get the control points in homogeneous coordinates (wx, wy, wz, w).
+    /// \return homogeneous control points
+    const std::vector<Vector4X<_Dt>>& get_homogeneous_control_points() const
+    {
+        return _ctrlpts_w;
+    }
+
+    /// Set the control points of the NURBS curve and their weights.
+    /// \param control_points control points
+    /// \param weights weights of the control points, positive
+    void set_control_points(const std::vector<Vector3X<_Dt>>& control_points, const std::vector<_Dt>& weights)
+    {
+        if (control_points.size() != weights.size())
+        {
+            throw std::invalid_argument("every control point has a weight.");
+        }
+        for (auto w : weights)
+        {
+            if (!(w > 0))
+            {
+                throw std::invalid_argument("weights must be greater than zero.");
+            }
+        }
+
+        _ctrlpts = control_points;
+        _weights = weights;
+        _ctrlpts_w.resize(_ctrlpts.size());
+        for (size_t i = 0; i < _ctrlpts.size(); i++)
+        {
+            _ctrlpts_w[i] = Vector4X<_Dt>(_ctrlpts[i], _weights[i]);
+        }
+    }
+};
+
+#endif //B_SPLINE_NURBSCURVE_H
@@ -5,15 +5,20 @@
 #ifndef B_SPLINE_PARACURVE_H
 #define B_SPLINE_PARACURVE_H
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 #include "Curve.h"
+#include "util/BSplineFunction.h"
 
-template <typename _PointType = CurvePoint<double, ParaPointTrait<double>>>
-struct ParaCurve : public Curve<_PointType>
+template <typename _PointType = CurvePoint<double, ParaPointTrait<double>>, typename _VertexStorage = AoSStorage>
+struct ParaCurve : public Curve<_PointType, _VertexStorage>
 {
 public:
     using _Dt = typename _PointType::_Dt;
     using _Pt = _PointType;
-    using _Base = Curve<_Pt>;
+    using _Base = Curve<_Pt, _VertexStorage>;
 
     static_assert(std::is_base_of<ParaPointTrait<_Dt>, typename _Pt::_Tr>::value);
 
@@ -65,56 +70,168 @@ public: // parameterization
      */
     void chordal_parameterization()
     {
+        _para_type = ParameterizationMethod::CHORDAL;
 
+        _scan_parameterization([](const auto& kernel, long i) { return kernel.length(i); });
+    }
 
-        if (_vertices.empty())
+    /**
+     * Centripetal parameterization
+     * The parameterization factor is proportional to sqrt(segment length).
+     */
+    void centripetal_parameterization()
+    {
+        _para_type = ParameterizationMethod::CENTRIPETAL;
+
+        _scan_parameterization([](const auto& kernel, long i) { return std::sqrt(kernel.length(i)); });
+    }
+
+    /**
+     * Exponent parameterization
+     * The parameterization factor is proportional to (segment length)^alpha: 0 is uniform, 0.5 centripetal and 1
+     * chordal.
+     * @param alpha the exponent, no less than 0
+     */
+    void exponent_parameterization(_Dt alpha)
+    {
+        if (!(alpha >= 0))
         {
-            return;
+            throw std::invalid_argument("exponent of the parameterization must be no less than zero.");
         }
 
-        auto num_v = _vertices.size();
+        _para_type = ParameterizationMethod::EXPONENT;
 
-        _Dt chord_length = 0;
-        std::vector<_Dt> segment_length;
-        for (int i = 1; i < num_v; i++)
+        _Dt half_alpha = alpha / 2;
+        _scan_parameterization([half_alpha](const auto& kernel, long i)
         {
-            chord_length += (_vertices[i].vertex - _vertices[i - 1].vertex).length();
-            segment_length.push_back(chord_length);
-        }
+            return std::pow(kernel.squared_length(i), half_alpha);
+        });
+    }
+
+    /**
+     * Foley-Nielsen parameterization
+     * The parameterization factor is the segment length enlarged by the deflection angles at both of its ends:
+     * d_i * (1 + 3/2 * a_{i-1} * d_{i-1} / (d_{i-1} + d_i) + 3/2 * a_i * d_{i+1} / (d_i + d_{i+1})),
+     * where a_i = min(deflection angle at vertex i, pi/2).
+     * See: Foley, Nielsen, *Knot selection for parametric spline interpolation*, 1989
+     */
+    void foley_nielsen_parameterization()
+    {
+        _para_type = ParameterizationMethod::FOLEY_NIELSEN;
+
+        const _Dt half_pi = _Dt(std::acos(-1.0) / 2);
+        long num_v = long(_vertices.size());
 
-        _vertices[0].trait.u = 0;
-        for (int i = 1; i < num_v; i++)
+        _scan_parameterization([half_pi, num_v](const auto& kernel, long i)
         {
-            _vertices[i].trait.u = segment_length[i - 1] / chord_length;
-        }
+            _Dt d = kernel.length(i);
+            _Dt factor = _Dt(1.0);
+
+            if (i > 1)
+            {
+                _Dt d_prev = kernel.length(i - 1);
+                _Dt angle = std::min(kernel.deflection(i - 1), half_pi);
+                factor += d_prev + d > 0 ? _Dt(1.5) * angle * d_prev / (d_prev + d) : _Dt(0.0);
+            }
+            if (i + 1 < num_v)
+            {
+                _Dt d_next = kernel.length(i + 1);
+                _Dt angle = std::min(kernel.deflection(i), half_pi);
+                factor += d + d_next > 0 ? _Dt(1.5) * angle * d_next / (d + d_next) : _Dt(0.0);
+            }
+
+            return d * factor;
+        });
     }
 
     /**
-     * Centripetal parameterization
-     * The parameterization factor is proportional to sqrt(segment length).
+     * Universal parameterization
+     * The parameter of the i-th vertex is where the i-th basis function on a uniform knot vector, with as many
+     * functions as vertices, reaches its maximum. The parameters depend only on the number of vertices.
+     * See: Lim, *A universal parametrization in B-spline curve and surface interpolation*, 1999
+     * @param degree degree of the B spline to fit
      */
-    void centripetal_parameterization()
+    void universal_parameterization(int degree = 3)
     {
-        if (_vertices.empty())
+        if (degree < 1)
         {
-            return;
+            throw std::invalid_argument("degree must be greater than zero.");
         }
 
-        auto num_v = _vertices.size();
+        _para_type = ParameterizationMethod::UNIVERSAL;
 
-        _Dt chord_length = 0;
-        std::vector<_Dt> segment_length;
+        long num_v = long(_vertices.size());
+        if (num_v == 0)
+        {
+            return;
+        }
 
-        for (int i=1; i<num_v; i++)
+        // fewer vertices than the order, a lower degree is used
+        int p = int(std::min<long>(degree, num_v - 1));
+        if (p == 0)
         {
-            chord_length += std::sqrt((_vertices[i].vertex - _vertices[i - 1].vertex).length());
-            segment_length.push_back(chord_length);
+            _parameter_at(0) = _Dt(0.0);
+            return;
         }
 
-        _vertices[0].trait.u = 0;
-        for (int i = 1; i < num_v; i++)
+        // uniform clamped knot vector of num_v basis functions
+        long n = num_v - 1;
+        std::vector<_Dt> knots(num_v + p + 1);
+        for (long i = 0; i < long(knots.size()); i++)
         {
-            _vertices[i].trait.u = segment_length[i - 1] / chord_length;
+            knots[i] = i <= p ? _Dt(0.0) : (i > n ? _Dt(1.0) : _Dt(i - p) / (n - p + 1));
+        }
+
+        // the basis functions away from both ends are symmetric, their maxima are at the middle of their supports
+        parallel_for(p, num_v - p, [&](long first, long last)
+        {
+            for (long i = first; i < last; i++)
+            {
+                _parameter_at(i) = (knots[i] + knots[i + p + 1]) / 2;
+            }
+        }, _Base::_min_grain);
+
+        // the others, by golden section search on the support
+        BSplineFunction<_Dt> bf(int(n), p, knots);
+        std::vector<_Dt> values(p + 1);
+        auto basis = [&](long i, _Dt u)
+        {
+            int span = bf.find_span(u);
+            if (i < span - p || i > span)
+            {
+                return _Dt(0.0);
+            }
+            bf.basis_funcs(span, u, values.data());
+            return values[i - (span - p)];
+        };
+
+        const _Dt ratio = _Dt((std::sqrt(5.0) - 1) / 2);
+        for (long i = 0; i < num_v; i++)
+        {
+            if (i >= p && i < num_v - p)
+            {
+                continue;
+            }
+            if (i == 0 || i == n)
+            {
+                _parameter_at(i) = knots[i + p];
+                continue;
+            }
+
+            _Dt a = knots[i], b = knots[i + p + 1];
+            for (int iter = 0; iter < 64 && b - a > std::numeric_limits<_Dt>::epsilon(); iter++)
+            {
+                _Dt c = b - ratio * (b - a), d = a + ratio * (b - a);
+                if (basis(i, c) < basis(i, d))
+                {
+                    a = c;
+                }
+                else
+                {
+                    b = d;
+                }
+            }
+            _parameter_at(i) = (a + b) / 2;
         }
     }
 
@@ -126,6 +243,150 @@ public: // generate curve vertex
         // pass
     }
 
+protected:
+    /**
+     * Geometry of the polyline through the vertices, shared by the parameterizations.
+     * Segment i joins vertex i - 1 and vertex i. Every value is computed from the vertices alone, so loops over
+     * the segments have no dependency between iterations.
+     */
+    template <typename _VertexAt>
+    struct _SegmentKernel
+    {
+        /// accessor of the vertex at an index
+        _VertexAt vertex_at;
+
+        /// Squared length of segment i, 1 <= i < the number of vertices.
+        _Dt squared_length(long i) const
+        {
+            return (vertex_at(i) - vertex_at(i - 1)).squared_length();
+        }
+
+        /// Length of segment i, 1 <= i < the number of vertices.
+        _Dt length(long i) const
+        {
+            return std::sqrt(squared_length(i));
+        }
+
+        /// Deflection angle at vertex i between segment i and segment i + 1, in [0, pi].
+        _Dt deflection(long i) const
+        {
+            auto a = vertex_at(i) - vertex_at(i - 1);
+            auto b = vertex_at(i + 1) - vertex_at(i);
+            return std::atan2(a.cross(b).length(), a.dot(b));
+        }
+    };
+
+    /// Get the parameter of the vertex at index `i`, regardless of the storage.
+    _Dt& _parameter_at(long i)
+    {
+        if constexpr (_Base::is_soa)
+        {
+            return _vertices.u()[i];
+        }
+        else
+        {
+            return _vertices[i].trait.u;
+        }
+    }
+
+    /**
+     * Set the parameters to the normalized prefix sums of the segment factors.
+     * The vertices are split into chunks: every chunk computes its segment factors (a loop without dependency) and
+     * their running sum into `u` in parallel, then the chunk sums are scanned serially, and the chunks add their
+     * offsets and normalize in parallel. No temporary array is allocated.
+     * @param factor `factor(kernel, i)`, parameterization factor of segment i, from a `_SegmentKernel`
+     */
+    template <typename _Factor>
+    void _scan_parameterization(_Factor factor)
+    {
+        long num_v = long(_vertices.size());
+        if (num_v == 0)
+        {
+            return;
+        }
+
+        if constexpr (_Base::is_soa)
+        {
+            const _Dt* x = _vertices.x();
+            const _Dt* y = _vertices.y();
+            const _Dt* z = _vertices.z();
+            _Dt* u = _vertices.u();
+            auto vertex_at = [=](long i) { return Vertex<_Dt>(x[i], y[i], z[i]); };
+            _SegmentKernel<decltype(vertex_at)> kernel{vertex_at};
+            _scan_parameterization(num_v, [&](long i) { return factor(kernel, i); },
+                                   [u](long i) -> _Dt& { return u[i]; });
+        }
+        else
+        {
+            _Pt* v = _vertices.data();
+            auto vertex_at = [v](long i) -> const Vertex<_Dt>& { return v[i].vertex; };
+            _SegmentKernel<decltype(vertex_at)> kernel{vertex_at};
+            _scan_parameterization(num_v, [&](long i) { return factor(kernel, i); },
+                                   [v](long i) -> _Dt& { return v[i].trait.u; });
+        }
+    }
+
+    template <typename _Factor, typename _Parameter>
+    void _scan_parameterization(long num_v, _Factor factor, _Parameter u)
+    {
+        unsigned n_chunk = parallel_chunk_count(num_v, _Base::_min_grain);
+        std::vector<_Dt> chunk_sums(n_chunk);
+
+        // segment factors and the running sum of each chunk
+        parallel_for_chunk(0, num_v, n_chunk, [&](unsigned chunk, long first, long last)
+        {
+            if (first == 0)
+            {
+                u(0) = _Dt(0.0);
+                first = 1;
+            }
+            for (long i = first; i < last; i++)
+            {
+                u(i) = factor(i);
+            }
+
+            _Dt sum = _Dt(0.0);
+            for (long i = first; i < last; i++)
+            {
+                sum += u(i);
+                u(i) = sum;
+            }
+            chunk_sums[chunk] = sum;
+        });
+
+        // exclusive scan of the chunk sums
+        std::vector<_Dt> offsets(n_chunk, _Dt(0.0));
+        for (unsigned i = 1; i < n_chunk; i++)
+        {
+            offsets[i] = offsets[i - 1] + chunk_sums[i - 1];
+        }
+        _Dt total = offsets[n_chunk - 1] + chunk_sums[n_chunk - 1];
+
+        // all the vertices coincide
+        if (total == 0)
+        {
+            _Dt step = num_v > 1 ? _Dt(1.0) / (num_v - 1) : _Dt(0.0);
+            parallel_for(0, num_v, [&](long first, long last)
+            {
+                for (long i = first; i < last; i++)
+                {
+                    u(i) = i * step;
+                }
+            }, _Base::_min_grain);
+            return;
+        }
+
+        // offset and normalize, the last parameter is exactly 1
+        parallel_for_chunk(0, num_v, n_chunk, [&](unsigned chunk, long first, long last)
+        {
+            _Dt offset = offsets[chunk];
+            for (long i = first; i < last; i++)
+            {
+                u(i) = (u(i) + offset) / total;
+            }
+        });
+    }
+
 public: // getter & setter
 
     /// Get parameterization method of the parameterized curve.
@@ -0,0 +1,113 @@
+//
+// Created by haochuanchen on 18-5-21.
+//
+
+#ifndef B_SPLINE_CURVESTATISTICS_H
+#define B_SPLINE_CURVESTATISTICS_H
+
+#include <limits>
+
+#include "BoundBox.h"
+#include "NormalizeTransform.h"
+#include "Vector3X.h"
+
+/// Statistics of a curve accumulated vertex by vertex: bound box, max gap between adjacent vertices, and both end
+/// points. Statistics of consecutive pieces of a curve can be merged, so they can be computed block by block or in
+/// parallel.
+/// \tparam _DataType data type of the coordinate, default double.
+template <typename _DataType = double>
+struct CurveStatistics
+{
+public:
+    using _Dt = _DataType;
+    using _Vt = Vector3X<_Dt>;
+
+public:
+    /// the number of vertices
+    size_t count = 0;
+
+    /// bound box of the vertices
+    BoundBox<_Dt> box{std::numeric_limits<_Dt>::max(), std::numeric_limits<_Dt>::lowest(),
+                      std::numeric_limits<_Dt>::max(), std::numeric_limits<_Dt>::lowest(),
+                      std::numeric_limits<_Dt>::max(), std::numeric_limits<_Dt>::lowest()};
+
+    /// max squared distance between adjacent vertices
+    _Dt max_squared_gap = _Dt(0.0);
+
+    /// first vertex
+    _Vt first;
+
+    /// last vertex
+    _Vt last;
+
+public:
+    /// Append a vertex.
+    /// \param v the vertex
+    void add(const _Vt& v)
+    {
+        if (count == 0)
+        {
+            first = v;
+        }
+        else
+        {
+            _Dt gap = (v - last).squared_length();
+            max_squared_gap = gap > max_squared_gap ? gap : max_squared_gap;
+        }
+        last = v;
+        count++;
+
+        box.x_min = v.x < box.x_min ? v.x : box.x_min;
+        box.x_max = v.x > box.x_max ? v.x : box.x_max;
+        box.y_min = v.y < box.y_min ? v.y : box.y_min;
+        box.y_max = v.y > box.y_max ? v.y : box.y_max;
+        box.z_min = v.z < box.z_min ? v.z : box.z_min;
+        box.z_max = v.z > box.z_max ? v.z : box.z_max;
+    }
+
+    /// Append the statistics of the following piece of the curve.
+    /// \param next statistics of the piece right after this one
+    void merge(const CurveStatistics& next)
+    {
+        if (next.count == 0)
+        {
+            return;
+        }
+        if (count == 0)
+        {
+            *this = next;
+            return;
+        }
+
+        _Dt gap = (next.first - last).squared_length();
+        max_squared_gap = gap > max_squared_gap ? gap : max_squared_gap;
+        max_squared_gap = next.max_squared_gap > max_squared_gap ? next.max_squared_gap : max_squared_gap;
+
+        box.x_min = next.box.x_min < box.x_min ? next.box.x_min : box.x_min;
+        box.x_max = next.box.x_max > box.x_max ? next.box.x_max : box.x_max;
+        box.y_min = next.box.y_min < box.y_min ? next.box.y_min : box.y_min;
+        box.y_max = next.box.y_max > box.y_max ? next.box.y_max : box.y_max;
+        box.z_min = next.box.z_min < box.z_min ? next.box.z_min : box.z_min;
+        box.z_max = next.box.z_max > box.z_max ? next.box.z_max : box.z_max;
+
+        last = next.last;
+        count += next.count;
+    }
+
+    /// Whether the curve is periodic: the distance between both ends is no more than the max gap between adjacent
+    /// vertices.
+    /// \return is periodic
+    bool is_periodic() const
+    {
+        return count > 0 && (first - last).squared_length() <= max_squared_gap;
+    }
+
+    /// Get the transform normalizing the curve into [-1, 1]^3.
+    /// \return the transform
+    NormalizeTransform<_Dt> normalize_transform() const
+    {
+        return NormalizeTransform<_Dt>::from_bound_box(box);
+    }
+};
+
+#endif //B_SPLINE_CURVESTATISTICS_H
@@ -0,0 +1,85 @@
+//
+// Created by haochuanchen on 18-5-21.
+//
+
+#ifndef B_SPLINE_NORMALIZETRANSFORM_H
+#define B_SPLINE_NORMALIZETRANSFORM_H
+
+#include "BoundBox.h"
+#include "Vector3X.h"
+
+/// Uniform scaling that maps a curve into [-1, 1]^3: v' = (v - center) / scale.
+/// \tparam _DataType data type of the coordinate, default double.
+template <typename _DataType = double>
+struct NormalizeTransform
+{
+public:
+    using _Dt = _DataType;
+
+public:
+    /// center of the bound box
+    Vector3X<_Dt> center;
+
+    /// half of the longest edge of the bound box
+    _Dt scale = _Dt(1.0);
+
+public:
+    /// Get the transform normalizing a bound box. Degenerated edges are treated as 1.0 long.
+    /// \param box the bound box
+    /// \return the transform
+    static NormalizeTransform from_bound_box(const BoundBox<_Dt>& box)
+    {
+        NormalizeTransform transform;
+        transform.center = Vector3X<_Dt>((box.x_min + box.x_max) / 2.0,
+                                         (box.y_min + box.y_max) / 2.0,
+                                         (box.z_min + box.z_max) / 2.0);
+
+        auto x_length = (box.x_max - box.x_min) / 2.0,
+             y_length = (box.y_max - box.y_min) / 2.0,
+             z_length = (box.z_max - box.z_min) / 2.0;
+
+        x_length = x_length == 0.0 ? 0.5 : x_length;
+        y_length = y_length == 0.0 ? 0.5 : y_length;
+        z_length = z_length == 0.0 ? 0.5 : z_length;
+
+        auto max_length = x_length;
+        max_length = y_length > max_length ? y_length : max_length;
+        max_length = z_length > max_length ? z_length : max_length;
+
+        transform.scale = max_length;
+        return transform;
+    }
+
+    /// Normalize a point.
+    /// \param v the point
+    /// \return normalized point
+    Vector3X<_Dt> apply(const Vector3X<_Dt>& v) const
+    {
+        return (v - center) / scale;
+    }
+
+    /// Normalize a bound box.
+    /// \param box the bound box
+    /// \return normalized bound box
+    BoundBox<_Dt> apply(const BoundBox<_Dt>& box) const
+    {
+        BoundBox<_Dt> result;
+        result.x_min = (box.x_min - center.x) / scale;
+        result.x_max = (box.x_max - center.x) / scale;
+        result.y_min = (box.y_min - center.y) / scale;
+        result.y_max = (box.y_max - center.y) / scale;
+        result.z_min = (box.z_min - center.z) / scale;
+        result.z_max = (box.z_max - center.z) / scale;
+        return result;
+    }
+
+    /// Map a normalized point back, e.g. control points of a curve fitted on the normalized curve.
+    /// \param v normalized point
+    /// \return the original point
+    Vector3X<_Dt> invert(const Vector3X<_Dt>& v) const
+    {
+        return v * scale + center;
+    }
+};
+
+#endif //B_SPLINE_NORMALIZETRANSFORM_H
@@ -5,6 +5,9 @@
 #ifndef B_SPLINE_VERTEX_H
 #define B_SPLINE_VERTEX_H
 
+#include <cmath>
+#include <initializer_list>
+
 /// Three-dimensional vertex.
 /// \tparam DataType data type of the coordinate
 template <typename DataType = double>
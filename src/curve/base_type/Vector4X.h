@@ -0,0 +1,95 @@
+//
+// Created by haochuanchen on 18-6-4.
+//
+
+#ifndef B_SPLINE_VECTOR4X_H
+#define B_SPLINE_VECTOR4X_H
+
+#include "Vector3X.h"
+
+/// Four-dimensional vector, the homogeneous coordinate (wx, wy, wz, w) of a weighted point.
+/// Aligned to its size, so the four lanes are loaded and operated at once.
+/// \tparam DataType data type of the coordinate
+template <typename DataType = double>
+struct alignas(4 * sizeof(DataType)) Vector4X
+{
+    using _Dt = DataType;
+
+public:
+    _Dt x;
+    _Dt y;
+    _Dt z;
+    /// weight
+    _Dt w;
+
+public:
+    /// Create a 4D vector.
+    explicit Vector4X(_Dt x = _Dt(0.0), _Dt y = _Dt(0.0), _Dt z = _Dt(0.0), _Dt w = _Dt(0.0))
+            : x(x), y(y), z(z), w(w)
+    {
+    }
+
+    /// Create the homogeneous coordinate of a weighted point.
+    /// \param point the point
+    /// \param weight the weight
+    Vector4X(const Vector3X<_Dt>& point, _Dt weight)
+            : x(point.x * weight), y(point.y * weight), z(point.z * weight), w(weight)
+    {
+    }
+
+public:
+    Vector4X operator+(const Vector4X& rhs) const
+    {
+        return Vector4X(x + rhs.x, y + rhs.y, z + rhs.z, w + rhs.w);
+    }
+
+    Vector4X& operator+=(const Vector4X& rhs)
+    {
+        x += rhs.x;
+        y += rhs.y;
+        z += rhs.z;
+        w += rhs.w;
+        return *this;
+    }
+
+    Vector4X operator-(const Vector4X& rhs) const
+    {
+        return Vector4X(x - rhs.x, y - rhs.y, z - rhs.z, w - rhs.w);
+    }
+
+    Vector4X operator*(_Dt rhs) const
+    {
+        return Vector4X(x * rhs, y * rhs, z * rhs, w * rhs);
+    }
+
+    friend Vector4X operator*(_Dt lhs, const Vector4X& rhs)
+    {
+        return Vector4X(rhs.x * lhs, rhs.y * lhs, rhs.z * lhs, rhs.w * lhs);
+    }
+
+    /// The first three coordinates (wx, wy, wz), without division.
+    /// \return the weighted point
+    Vector3X<_Dt> weighted() const
+    {
+        return Vector3X<_Dt>(x, y, z);
+    }
+
+    /// Project to the 3D point (x, y, z) / w.
+    /// \return the point
+    Vector3X<_Dt> project() const
+    {
+        return Vector3X<_Dt>(x / w, y / w, z / w);
+    }
+
+    bool operator==(const Vector4X& ano) const
+    {
+        return x == ano.x && y == ano.y && z == ano.z && w == ano.w;
+    }
+
+    bool operator!=(const Vector4X& ano) const
+    {
+        return !(*this == ano);
+    }
+};
+
+#endif //B_SPLINE_VECTOR4X_H
@@ -0,0 +1,515 @@
+//
+// Created by haochuanchen on 18-5-26.
+//
+
+#ifndef B_SPLINE_VERTEXSTORAGE_H
+#define B_SPLINE_VERTEXSTORAGE_H
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+#include "CurvePoint.h"
+#include "../util/AlignedAllocator.h"
+
+/**
+ * Vertices stored as a structure of arrays: x, y, z, and the parameter u and the knot span index if the trait has
+ * them, each in its own contiguous array aligned to 64 bytes. Loops over a single coordinate vectorize.
+ *
+ * It mimics `std::vector<_CurvePoint>` for the existing code: `array[i].vertex.x`, `array[i].trait.u` and
+ * `array[i] = point` work through a proxy reference, `const` access and iteration yield `_CurvePoint` values.
+ * The proxy cannot be bound to `auto&`, use `auto&&` or the arrays instead.
+ * @tparam _CurvePoint curve point type, with `BasePointTrait`, `ParaPointTrait` or `BSplinePointTrait`
+ */
+template <typename _CurvePoint>
+class SoAVertexArray
+{
+public:
+    using _Pt = _CurvePoint;
+    using _Dt = typename _Pt::_Dt;
+    using _Tr = typename _Pt::_Tr;
+
+    template <typename _Type>
+    using _Array = std::vector<_Type, AlignedAllocator<_Type>>;
+
+    /// whether the points have the parameter u
+    static constexpr bool has_parameter = std::is_base_of<ParaPointTrait<_Dt>, _Tr>::value;
+    /// whether the points have the knot span index
+    static constexpr bool has_span = std::is_base_of<BSplinePointTrait<_Dt>, _Tr>::value;
+
+    using value_type = _Pt;
+    using size_type = size_t;
+
+    /// Reference to the coordinates of a vertex.
+    struct VertexRef
+    {
+        _Dt& x;
+        _Dt& y;
+        _Dt& z;
+
+        operator Vertex<_Dt>() const
+        {
+            return Vertex<_Dt>(x, y, z);
+        }
+
+        VertexRef& operator=(const Vertex<_Dt>& v)
+        {
+            x = v.x;
+            y = v.y;
+            z = v.z;
+            return *this;
+        }
+    };
+
+    /// Reference to the trait of a vertex without fields.
+    struct BaseTraitRef
+    {
+        BaseTraitRef(SoAVertexArray&, size_t)
+        {
+        }
+    };
+
+    /// Reference to the trait of a vertex with the parameter.
+    struct ParaTraitRef
+    {
+        _Dt& u;
+
+        ParaTraitRef(SoAVertexArray& array, size_t i)
+            : u(array._u[i])
+        {
+        }
+    };
+
+    /// Reference to the trait of a vertex with the parameter and the knot span index.
+    struct BSplineTraitRef
+    {
+        _Dt& u;
+        int& span;
+
+        BSplineTraitRef(SoAVertexArray& array, size_t i)
+            : u(array._u[i]), span(array._span[i])
+        {
+        }
+    };
+
+    using TraitRef = std::conditional_t<has_span, BSplineTraitRef,
+                                        std::conditional_t<has_parameter, ParaTraitRef, BaseTraitRef>>;
+
+    /// Proxy reference to a point.
+    struct reference
+    {
+        VertexRef vertex;
+        TraitRef trait;
+
+        reference(SoAVertexArray& array, size_t i)
+            : vertex{array._x[i], array._y[i], array._z[i]}, trait(array, i)
+        {
+        }
+
+        reference(const reference&) = default;
+
+        operator _Pt() const
+        {
+            _Pt point;
+            point.vertex = vertex;
+            if constexpr (has_parameter)
+            {
+                point.trait.u = trait.u;
+            }
+            if constexpr (has_span)
+            {
+                point.trait.span = trait.span;
+            }
+            return point;
+        }
+
+        reference& operator=(const _Pt& point)
+        {
+            vertex = point.vertex;
+            if constexpr (has_parameter)
+            {
+                trait.u = point.trait.u;
+            }
+            if constexpr (has_span)
+            {
+                trait.span = point.trait.span;
+            }
+            return *this;
+        }
+
+        reference& operator=(const reference& other)
+        {
+            return *this = _Pt(other);
+        }
+
+        /// Swap the referenced points, for the algorithms swapping through the iterators.
+        friend void swap(reference a, reference b)
+        {
+            _Pt point = a;
+            a = b;
+            b = point;
+        }
+    };
+
+    using const_reference = _Pt;
+
+    /// Random access iterator yielding proxy references, or values if `_Const`.
+    template <bool _Const>
+    class _Iterator
+    {
+    public:
+        using _Array_t = std::conditional_t<_Const, const SoAVertexArray, SoAVertexArray>;
+
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = _Pt;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = std::conditional_t<_Const, _Pt, typename SoAVertexArray::reference>;
+
+    private:
+        _Array_t* _array = nullptr;
+        difference_type _index = 0;
+
+        friend class _Iterator<!_Const>;
+
+    public:
+        _Iterator() = default;
+
+        _Iterator(_Array_t* array, difference_type index)
+            : _array(array), _index(index)
+        {
+        }
+
+        /// Convert an iterator to a const_iterator.
+        template <bool _Other, typename = std::enable_if_t<_Const && !_Other>>
+        _Iterator(const _Iterator<_Other>& other)
+            : _array(other._array), _index(other._index)
+        {
+        }
+
+        reference operator*() const
+        {
+            return (*_array)[_index];
+        }
+
+        reference operator[](difference_type n) const
+        {
+            return (*_array)[_index + n];
+        }
+
+        _Iterator& operator++()
+        {
+            _index++;
+            return *this;
+        }
+
+        _Iterator operator++(int)
+        {
+            auto it = *this;
+            _index++;
+            return it;
+        }
+
+        _Iterator& operator--()
+        {
+            _index--;
+            return *this;
+        }
+
+        _Iterator operator--(int)
+        {
+            auto it = *this;
+            _index--;
+            return it;
+        }
+
+        _Iterator& operator+=(difference_type n)
+        {
+            _index += n;
+            return *this;
+        }
+
+        _Iterator& operator-=(difference_type n)
+        {
+            _index -= n;
+            return *this;
+        }
+
+        _Iterator operator+(difference_type n) const
+        {
+            return _Iterator(_array, _index + n);
+        }
+
+        _Iterator operator-(difference_type n) const
+        {
+            return _Iterator(_array, _index - n);
+        }
+
+        friend _Iterator operator+(difference_type n, const _Iterator& it)
+        {
+            return it + n;
+        }
+
+        // the comparisons are friends, so an iterator converts to a const_iterator on either side
+
+        friend difference_type operator-(const _Iterator& a, const _Iterator& b)
+        {
+            return a._index - b._index;
+        }
+
+        friend bool operator==(const _Iterator& a, const _Iterator& b)
+        {
+            return a._index == b._index;
+        }
+
+        friend bool operator!=(const _Iterator& a, const _Iterator& b)
+        {
+            return a._index != b._index;
+        }
+
+        friend bool operator<(const _Iterator& a, const _Iterator& b)
+        {
+            return a._index < b._index;
+        }
+
+        friend bool operator>(const _Iterator& a, const _Iterator& b)
+        {
+            return a._index > b._index;
+        }
+
+        friend bool operator<=(const _Iterator& a, const _Iterator& b)
+        {
+            return a._index <= b._index;
+        }
+
+        friend bool operator>=(const _Iterator& a, const _Iterator& b)
+        {
+            return a._index >= b._index;
+        }
+    };
+
+    using iterator = _Iterator<false>;
+    using const_iterator = _Iterator<true>;
+
+private:
+    _Array<_Dt> _x;
+    _Array<_Dt> _y;
+    _Array<_Dt> _z;
+    /// empty if the points have no parameter
+    _Array<_Dt> _u;
+    /// empty if the points have no knot span index
+    _Array<int> _span;
+
+public: // std::vector like interface
+
+    size_t size() const
+    {
+        return _x.size();
+    }
+
+    bool empty() const
+    {
+        return _x.empty();
+    }
+
+    void clear()
+    {
+        _resize_all(0);
+    }
+
+    void reserve(size_t n)
+    {
+        _x.reserve(n);
+        _y.reserve(n);
+        _z.reserve(n);
+        if constexpr (has_parameter)
+        {
+            _u.reserve(n);
+        }
+        if constexpr (has_span)
+        {
+            _span.reserve(n);
+        }
+    }
+
+    /// Resize the arrays, new points are zero.
+    void resize(size_t n)
+    {
+        _resize_all(n);
+    }
+
+    void push_back(const _Pt& point)
+    {
+        _x.push_back(point.vertex.x);
+        _y.push_back(point.vertex.y);
+        _z.push_back(point.vertex.z);
+        if constexpr (has_parameter)
+        {
+            _u.push_back(point.trait.u);
+        }
+        if constexpr (has_span)
+        {
+            _span.push_back(point.trait.span);
+        }
+    }
+
+    void emplace_back(const _Pt& point)
+    {
+        push_back(point);
+    }
+
+    void pop_back()
+    {
+        _resize_all(size() - 1);
+    }
+
+    reference operator[](size_t i)
+    {
+        return reference(*this, i);
+    }
+
+    _Pt operator[](size_t i) const
+    {
+        _Pt point;
+        point.vertex = Vertex<_Dt>(_x[i], _y[i], _z[i]);
+        if constexpr (has_parameter)
+        {
+            point.trait.u = _u[i];
+        }
+        if constexpr (has_span)
+        {
+            point.trait.span = _span[i];
+        }
+        return point;
+    }
+
+    reference front()
+    {
+        return (*this)[0];
+    }
+
+    _Pt front() const
+    {
+        return (*this)[0];
+    }
+
+    reference back()
+    {
+        return (*this)[size() - 1];
+    }
+
+    _Pt back() const
+    {
+        return (*this)[size() - 1];
+    }
+
+    iterator begin()
+    {
+        return iterator(this, 0);
+    }
+
+    iterator end()
+    {
+        return iterator(this, std::ptrdiff_t(size()));
+    }
+
+    const_iterator begin() const
+    {
+        return const_iterator(this, 0);
+    }
+
+    const_iterator end() const
+    {
+        return const_iterator(this, std::ptrdiff_t(size()));
+    }
+
+public: // arrays
+
+    /// x of the points
+    _Dt* x()
+    {
+        return _x.data();
+    }
+
+    const _Dt* x() const
+    {
+        return _x.data();
+    }
+
+    /// y of the points
+    _Dt* y()
+    {
+        return _y.data();
+    }
+
+    const _Dt* y() const
+    {
+        return _y.data();
+    }
+
+    /// z of the points
+    _Dt* z()
+    {
+        return _z.data();
+    }
+
+    const _Dt* z() const
+    {
+        return _z.data();
+    }
+
+    /// parameters of the points, nullptr if there is none
+    _Dt* u()
+    {
+        return _u.data();
+    }
+
+    const _Dt* u() const
+    {
+        return _u.data();
+    }
+
+    /// knot span indices of the points, nullptr if there is none
+    int* span()
+    {
+        return _span.data();
+    }
+
+    const int* span() const
+    {
+        return _span.data();
+    }
+
+private:
+    void _resize_all(size_t n)
+    {
+        _x.resize(n);
+        _y.resize(n);
+        _z.resize(n);
+        if constexpr (has_parameter)
+        {
+            _u.resize(n);
+        }
+        if constexpr (has_span)
+        {
+            _span.resize(n);
+        }
+    }
+};
+
+/// Storage policy of the vertices of a curve: array of `CurvePoint`s, the default.
+struct AoSStorage
+{
+    template <typename _Pt>
+    using container = std::vector<_Pt>;
+};
+
+/// Storage policy of the vertices of a curve: structure of arrays, see `SoAVertexArray`.
+struct SoAStorage
+{
+    template <typename _Pt>
+    using container = SoAVertexArray<_Pt>;
+};
+
+#endif //B_SPLINE_VERTEXSTORAGE_H
@@ -17,6 +17,12 @@ enum class ParameterizationMethod
     CHORDAL,
     /// centripetal parameterized
     CENTRIPETAL,
+    /// Foley-Nielsen parameterized, chordal corrected by the deflection angles
+    FOLEY_NIELSEN,
+    /// universal parameterized, the maxima of the basis functions on a uniform knot vector
+    UNIVERSAL,
+    /// parameterized by segment length to the power of an exponent
+    EXPONENT,
 };
 
 
@@ -0,0 +1,484 @@
+//
+// Created by haochuanchen on 18-5-19.
+//
+
+#ifndef B_SPLINE_CURVEBINARYIO_H
+#define B_SPLINE_CURVEBINARYIO_H
+
+#include <QFile>
+#include <QSysInfo>
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "../base_type/CurvePoint.h"
+
+/**
+ * Binary curve format, version 1. All the values are little-endian.
+ *
+ * | offset | type      | field                                           |
+ * |--------|-----------|-------------------------------------------------|
+ * | 0      | char[8]   | magic "BSCURVE\0"                               |
+ * | 8      | uint32    | version                                         |
+ * | 12     | uint32    | size of a scalar, 4 (float) or 8 (double)       |
+ * | 16     | uint32    | flags, see `CurveBinaryFlag`                    |
+ * | 20     | int32     | degree of the B spline, -1 if there is none     |
+ * | 24     | uint64    | the number of vertices                          |
+ * | 32     | uint64    | the number of knots                             |
+ * | 40     | uint64    | the number of control points                    |
+ * | 48     | uint8[16] | reserved                                        |
+ *
+ * The header is followed by the arrays x, y, z, u, span (int32) of the vertices, the knots, and x, y, z of the
+ * control points, in this order. Absent arrays take no space. There are no weights, so rational curves are not
+ * supported. Every array starts at a multiple of 64 bytes, so the
+ * arrays of a mapped file can be used in place.
+ */
+struct CurveBinaryHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t scalar_size;
+    uint32_t flags;
+    int32_t degree;
+    uint64_t n_vertex;
+    uint64_t n_knot;
+    uint64_t n_ctrlpt;
+    uint8_t reserved[16];
+};
+
+static_assert(sizeof(CurveBinaryHeader) == 64);
+
+/// Flags of the binary curve format.
+enum class CurveBinaryFlag : uint32_t
+{
+    /// vertices have parameters
+    HAS_PARAMETER = 1u << 0,
+    /// vertices have knot span indices
+    HAS_SPAN = 1u << 1,
+    /// contains degree, knots and control points of a B spline
+    HAS_SPLINE = 1u << 2,
+};
+
+/**
+ * Read-only view of the arrays of a binary curve. Absent arrays are nullptr.
+ * @tparam _DataType data type of the coordinate, default double
+ */
+template <typename _DataType = double>
+struct CurveBinaryView
+{
+    using _Dt = _DataType;
+
+    size_t n_vertex = 0;
+    const _Dt* x = nullptr;
+    const _Dt* y = nullptr;
+    const _Dt* z = nullptr;
+    const _Dt* u = nullptr;
+    const int32_t* span = nullptr;
+
+    /// degree of the B spline, -1 if there is none
+    int degree = -1;
+
+    size_t n_knot = 0;
+    const _Dt* knots = nullptr;
+
+    size_t n_ctrlpt = 0;
+    const _Dt* ctrl_x = nullptr;
+    const _Dt* ctrl_y = nullptr;
+    const _Dt* ctrl_z = nullptr;
+
+    bool has_spline() const
+    {
+        return degree >= 0;
+    }
+};
+
+/**
+ * Read and write curves in the binary curve format.
+ * Reading maps the file into memory and exposes its arrays as a `CurveBinaryView` without copying.
+ * @tparam _DataType data type of the coordinate, default double
+ */
+template <typename _DataType = double>
+class CurveBinaryIO
+{
+public:
+    using _Dt = _DataType;
+    using _View = CurveBinaryView<_Dt>;
+
+    static constexpr uint32_t VERSION = 1;
+    static constexpr size_t ALIGNMENT = 64;
+
+private:
+    std::unique_ptr<QFile> _file;
+    uchar* _mapped = nullptr;
+    _View _view;
+
+public:
+    CurveBinaryIO() = default;
+
+    CurveBinaryIO(const CurveBinaryIO&) = delete;
+    CurveBinaryIO& operator=(const CurveBinaryIO&) = delete;
+
+    ~CurveBinaryIO()
+    {
+        close();
+    }
+
+    /// Map a binary curve file.
+    /// \param filename the filename
+    /// \return false if the file can not be mapped or is not a valid binary curve of `_Dt`
+    bool open(const QString& filename)
+    {
+        _check_byte_order();
+        close();
+
+        _file = std::make_unique<QFile>(filename);
+        if (!_file->open(QIODevice::ReadOnly))
+        {
+            close();
+            return false;
+        }
+
+        auto size = _file->size();
+        if (size < qint64(sizeof(CurveBinaryHeader)))
+        {
+            close();
+            return false;
+        }
+
+        _mapped = _file->map(0, size);
+        if (_mapped == nullptr || !_bind(reinterpret_cast<const char*>(_mapped), size_t(size)))
+        {
+            close();
+            return false;
+        }
+
+        return true;
+    }
+
+    /// Unmap the file. Views obtained before are invalidated.
+    void close()
+    {
+        if (_file != nullptr)
+        {
+            if (_mapped != nullptr)
+            {
+                _file->unmap(_mapped);
+            }
+            _file->close();
+        }
+        _file.reset();
+        _mapped = nullptr;
+        _view = _View();
+    }
+
+    /// Get the view of the mapped file.
+    /// \return view, valid until `close()`
+    const _View& get_view() const
+    {
+        return _view;
+    }
+
+    /// Copy the vertices of the view into a curve, and the B spline if the curve is a `BSplineCurve`.
+    /// \param curve the curve to load into
+    template <typename _Curve>
+    void load(_Curve& curve) const
+    {
+        load(_view, curve);
+    }
+
+    /// Copy the vertices of a view into a curve, and the B spline if the curve is a `BSplineCurve`.
+    /// \param view the view
+    /// \param curve the curve to load into
+    template <typename _Curve>
+    static void load(const _View& view, _Curve& curve)
+    {
+        _check_curve_type<_Curve>();
+
+        using _Pt = typename _Curve::_Pt;
+        using _Tr = typename _Pt::_Tr;
+
+        auto& vertices = curve.get_vertices();
+        vertices.resize(view.n_vertex);
+
+        for (size_t i = 0; i < view.n_vertex; i++)
+        {
+            vertices[i].vertex = Vector3X<typename _Pt::_Dt>(view.x[i], view.y[i], view.z[i]);
+
+            if constexpr (std::is_base_of<ParaPointTrait<typename _Pt::_Dt>, _Tr>::value)
+            {
+                vertices[i].trait.u = view.u != nullptr ? view.u[i] : 0;
+            }
+            if constexpr (std::is_base_of<BSplinePointTrait<typename _Pt::_Dt>, _Tr>::value)
+            {
+                vertices[i].trait.span = view.span != nullptr ? view.span[i] : 0;
+            }
+        }
+
+        if constexpr (_has_spline<_Curve>::value)
+        {
+            if (view.has_spline())
+            {
+                std::vector<Vector3X<typename _Pt::_Dt>> control_points(view.n_ctrlpt);
+                for (size_t i = 0; i < view.n_ctrlpt; i++)
+                {
+                    control_points[i] = Vector3X<typename _Pt::_Dt>(view.ctrl_x[i], view.ctrl_y[i], view.ctrl_z[i]);
+                }
+
+                curve.set_degree(view.degree);
+                curve.set_control_points(control_points);
+                curve.set_knot_vector(std::vector<typename _Pt::_Dt>(view.knots, view.knots + view.n_knot));
+            }
+        }
+    }
+
+    /// Write a curve. Parameters and knot spans of the vertices are written if the point trait has them, the B
+    /// spline is written if the curve is a `BSplineCurve`.
+    /// \param filename the filename
+    /// \param curve the curve
+    /// \return false if the file can not be written
+    template <typename _Curve>
+    static bool write(const QString& filename, const _Curve& curve)
+    {
+        _check_curve_type<_Curve>();
+
+        _check_byte_order();
+
+        using _Pt = typename _Curve::_Pt;
+        using _Tr = typename _Pt::_Tr;
+
+        const auto& vertices = curve.get_vertices();
+
+        CurveBinaryHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, "BSCURVE", 8);
+        header.version = VERSION;
+        header.scalar_size = sizeof(_Dt);
+        header.degree = -1;
+        header.n_vertex = vertices.size();
+
+        if constexpr (std::is_base_of<ParaPointTrait<typename _Pt::_Dt>, _Tr>::value)
+        {
+            header.flags |= static_cast<uint32_t>(CurveBinaryFlag::HAS_PARAMETER);
+        }
+        if constexpr (std::is_base_of<BSplinePointTrait<typename _Pt::_Dt>, _Tr>::value)
+        {
+            header.flags |= static_cast<uint32_t>(CurveBinaryFlag::HAS_SPAN);
+        }
+        if constexpr (_has_spline<_Curve>::value)
+        {
+            header.flags |= static_cast<uint32_t>(CurveBinaryFlag::HAS_SPLINE);
+            header.degree = curve.get_degree();
+            header.n_knot = curve.get_knot_vector().size();
+            header.n_ctrlpt = curve.get_control_points().size();
+        }
+
+        QFile file(filename);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        {
+            return false;
+        }
+
+        bool ok = _write_block(file, &header, sizeof(header));
+
+        std::vector<_Dt> buffer(vertices.size());
+        auto write_vertices = [&](auto field)
+        {
+            for (size_t i = 0; i < vertices.size(); i++)
+            {
+                buffer[i] = _Dt(field(vertices[i]));
+            }
+            ok = ok && _write_block(file, buffer.data(), buffer.size() * sizeof(_Dt));
+        };
+
+        write_vertices([](const _Pt& p) { return p.vertex.x; });
+        write_vertices([](const _Pt& p) { return p.vertex.y; });
+        write_vertices([](const _Pt& p) { return p.vertex.z; });
+
+        if constexpr (std::is_base_of<ParaPointTrait<typename _Pt::_Dt>, _Tr>::value)
+        {
+            write_vertices([](const _Pt& p) { return p.trait.u; });
+        }
+        if constexpr (std::is_base_of<BSplinePointTrait<typename _Pt::_Dt>, _Tr>::value)
+        {
+            std::vector<int32_t> spans(vertices.size());
+            for (size_t i = 0; i < vertices.size(); i++)
+            {
+                spans[i] = vertices[i].trait.span;
+            }
+            ok = ok && _write_block(file, spans.data(), spans.size() * sizeof(int32_t));
+        }
+
+        if constexpr (_has_spline<_Curve>::value)
+        {
+            const auto& knots = curve.get_knot_vector();
+            const auto& control_points = curve.get_control_points();
+
+            std::vector<_Dt> values(knots.begin(), knots.end());
+            ok = ok && _write_block(file, values.data(), values.size() * sizeof(_Dt));
+
+            values.resize(control_points.size());
+            for (int axis = 0; axis < 3; axis++)
+            {
+                for (size_t i = 0; i < control_points.size(); i++)
+                {
+                    values[i] = axis == 0 ? control_points[i].x : (axis == 1 ? control_points[i].y : control_points[i].z);
+                }
+                ok = ok && _write_block(file, values.data(), values.size() * sizeof(_Dt));
+            }
+        }
+
+        file.close();
+        return ok;
+    }
+
+private:
+    /// Detect rational curves, such as `NURBSCurve`, by their weights.
+    template <typename _Curve, typename = void>
+    struct _is_rational : std::false_type
+    {
+    };
+
+    template <typename _Curve>
+    struct _is_rational<_Curve, std::void_t<decltype(std::declval<const _Curve&>().get_weights())>>
+        : std::true_type
+    {
+    };
+
+    /// Detect `BSplineCurve`-like curves by their knot vector.
+    template <typename _Curve, typename = void>
+    struct _has_spline : std::false_type
+    {
+    };
+
+    template <typename _Curve>
+    struct _has_spline<_Curve, std::void_t<decltype(std::declval<const _Curve&>().get_knot_vector())>>
+        : std::true_type
+    {
+    };
+
+    template <typename _Curve>
+    static void _check_curve_type()
+    {
+        static_assert(!_is_rational<_Curve>::value, "the binary curve format has no weights, rational curves such as "
+                                                    "NURBSCurve are not supported.");
+    }
+
+    static size_t _aligned(size_t size)
+    {
+        return (size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    }
+
+    static void _check_byte_order()
+    {
+        if (QSysInfo::ByteOrder != QSysInfo::LittleEndian)
+        {
+            throw std::logic_error("binary curve format is only supported on little-endian hosts.");
+        }
+    }
+
+    /// Write `size` bytes, padded to the alignment.
+    static bool _write_block(QFile& file, const void* data, size_t size)
+    {
+        static const char padding[ALIGNMENT] = {0};
+
+        if (size > 0 && file.write(reinterpret_cast<const char*>(data), size) != qint64(size))
+        {
+            return false;
+        }
+
+        size_t n_padding = _aligned(size) - size;
+        return n_padding == 0 || file.write(padding, n_padding) == qint64(n_padding);
+    }
+
+    /// Validate the header and point the view into `data`.
+    bool _bind(const char* data, size_t size)
+    {
+        CurveBinaryHeader header;
+        std::memcpy(&header, data, sizeof(header));
+
+        if (std::memcmp(header.magic, "BSCURVE", 8) != 0 || header.version != VERSION
+            || header.scalar_size != sizeof(_Dt))
+        {
+            return false;
+        }
+
+        size_t offset = sizeof(CurveBinaryHeader);
+        bool ok = true;
+
+        // the counts come from the file: compare them with the bytes left before multiplying, the product could
+        // overflow
+        auto take = [&](uint64_t count, size_t element_size) -> const char*
+        {
+            if (count == 0)
+            {
+                return nullptr;
+            }
+            if (offset > size || count > (size - offset) / element_size)
+            {
+                ok = false;
+                return nullptr;
+            }
+            const char* result = data + offset;
+            offset += _aligned(size_t(count) * element_size);
+            return result;
+        };
+
+        _View view;
+        view.n_vertex = header.n_vertex;
+
+        view.x = reinterpret_cast<const _Dt*>(take(header.n_vertex, sizeof(_Dt)));
+        view.y = reinterpret_cast<const _Dt*>(take(header.n_vertex, sizeof(_Dt)));
+        view.z = reinterpret_cast<const _Dt*>(take(header.n_vertex, sizeof(_Dt)));
+        if (header.flags & static_cast<uint32_t>(CurveBinaryFlag::HAS_PARAMETER))
+        {
+            view.u = reinterpret_cast<const _Dt*>(take(header.n_vertex, sizeof(_Dt)));
+        }
+        if (header.flags & static_cast<uint32_t>(CurveBinaryFlag::HAS_SPAN))
+        {
+            view.span = reinterpret_cast<const int32_t*>(take(header.n_vertex, sizeof(int32_t)));
+        }
+        if (header.flags & static_cast<uint32_t>(CurveBinaryFlag::HAS_SPLINE))
+        {
+            view.degree = header.degree;
+            view.n_knot = header.n_knot;
+            view.knots = reinterpret_cast<const _Dt*>(take(header.n_knot, sizeof(_Dt)));
+            view.n_ctrlpt = header.n_ctrlpt;
+            view.ctrl_x = reinterpret_cast<const _Dt*>(take(header.n_ctrlpt, sizeof(_Dt)));
+            view.ctrl_y = reinterpret_cast<const _Dt*>(take(header.n_ctrlpt, sizeof(_Dt)));
+            view.ctrl_z = reinterpret_cast<const _Dt*>(take(header.n_ctrlpt, sizeof(_Dt)));
+
+            // a B spline of degree p with n + 1 control points has n + p + 2 knots; both counts are bounded by the
+            // file size here, so the sum does not overflow
+            if (header.degree < 0 || header.n_ctrlpt < uint64_t(header.degree) + 1
+                || header.n_knot != header.n_ctrlpt + uint64_t(header.degree) + 1)
+            {
+                ok = false;
+            }
+        }
+
+        // a required array is absent while its count is not zero
+        if (view.n_vertex > 0 && (view.x == nullptr || view.y == nullptr || view.z == nullptr))
+        {
+            ok = false;
+        }
+        if (view.has_spline() && (view.knots == nullptr || view.ctrl_x == nullptr || view.ctrl_y == nullptr
+                                  || view.ctrl_z == nullptr))
+        {
+            ok = false;
+        }
+
+        if (!ok)
+        {
+            return false;
+        }
+
+        _view = view;
+        return true;
+    }
+};
+
+#endif //B_SPLINE_CURVEBINARYIO_H
@@ -0,0 +1,411 @@
+//
+// Created by haochuanchen on 18-5-24.
+//
+
+#ifndef B_SPLINE_CURVECOMPACTCODEC_H
+#define B_SPLINE_CURVECOMPACTCODEC_H
+
+#include <QFile>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iterator>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include "../BSplineCurve.h"
+
+/**
+ * Compact lossy encoding of a B spline curve, version 1, with a declared error bound.
+ *
+ * | field        | type                | comment                                                     |
+ * |--------------|---------------------|-------------------------------------------------------------|
+ * | magic        | char[4]             | "BSCC"                                                      |
+ * | version      | uint8               |                                                             |
+ * | degree       | uint8               |                                                             |
+ * | knot_bits    | uint8               | knots are stored as integers k / 2^knot_bits                |
+ * | reserved     | uint8               |                                                             |
+ * | error_bound  | float64             | max distance between the decoded curve and the source curve |
+ * | step         | float64             | quantization step of the control point coordinates          |
+ * | n_knot       | varint              |                                                             |
+ * | n_ctrlpt     | varint              |                                                             |
+ * | knots        | varint[n_knot]      | differences of adjacent quantized knots                     |
+ * | ctrlpts      | svarint[n_ctrlpt*3] | differences of adjacent quantized x, y, z                   |
+ *
+ * Fixed-size fields are little-endian. A varint stores 7 bits per byte, low bits first; an svarint is a zigzag
+ * encoded varint.
+ *
+ * The encoder spends the tolerance on:
+ * 1. knot removal, up to half of the tolerance, see `BSplineCurve::remove_knots`;
+ * 2. knot quantization, bounded by the control points of the difference of the curves before and after it, see
+ *    `_knot_deviation`;
+ * 3. control point quantization, the rest. By the convex hull property the curve moves no more than its control
+ *    points, i.e. sqrt(3) * step / 2.
+ * @tparam _DataType data type of the coordinate, default double
+ */
+template <typename _DataType = double>
+class CurveCompactCodec
+{
+public:
+    using _Dt = _DataType;
+    using _Vt = Vector3X<_Dt>;
+
+    static constexpr uint8_t VERSION = 1;
+    static constexpr size_t HEADER_SIZE = 24;
+
+    /// Fields of an encoded curve, without decoding it.
+    struct Info
+    {
+        int degree = 0;
+        int knot_bits = 0;
+        _Dt error_bound = 0;
+        _Dt step = 0;
+        size_t n_knot = 0;
+        size_t n_ctrlpt = 0;
+    };
+
+public:
+    /// Encode a B spline curve.
+    /// \param curve the curve, such as `BSplineCurve`
+    /// \param tolerance max distance between the decoded curve and `curve`
+    /// \param knot_bits resolution of the knots, in [8, 52]
+    /// \return the encoded bytes
+    template <typename _Curve>
+    static std::vector<uint8_t> encode(const _Curve& curve, _Dt tolerance, int knot_bits = 30)
+    {
+        if (!(tolerance > 0))
+        {
+            throw std::invalid_argument("tolerance must be greater than zero.");
+        }
+        if (knot_bits < 8 || knot_bits > 52)
+        {
+            throw std::invalid_argument("knot bits must be in [8, 52].");
+        }
+
+        int degree = curve.get_degree();
+        if (degree < 1 || degree > 255)
+        {
+            throw std::invalid_argument("degree must be in [1, 255].");
+        }
+
+        // 1. knot removal
+        BSplineCurve<CurvePoint<_Dt, BSplinePointTrait<_Dt>>> reduced(degree, curve.get_control_points(),
+                                                                     curve.get_knot_vector());
+        _Dt removal_error = reduced.remove_knots(tolerance * _Dt(0.5));
+
+        const auto& ctrlpts = reduced.get_control_points();
+        const auto& knots = reduced.get_knot_vector();
+
+        // 2. knot quantization
+        const _Dt knot_scale = std::ldexp(_Dt(1.0), knot_bits);
+        std::vector<uint64_t> q_knots(knots.size());
+        std::vector<_Dt> dq_knots(knots.size());
+        for (size_t i = 0; i < knots.size(); i++)
+        {
+            q_knots[i] = uint64_t(std::llround(knots[i] * knot_scale));
+            dq_knots[i] = q_knots[i] / knot_scale;
+        }
+        for (size_t i = degree + 1; i + degree + 1 < knots.size(); i++)
+        {
+            if (q_knots[i] == q_knots[i - degree])
+            {
+                throw std::logic_error("knot resolution is too coarse for the knot vector.");
+            }
+        }
+
+        _Dt knot_error = _knot_deviation(degree, ctrlpts, knots, dq_knots);
+
+        // 3. control point quantization
+        _Dt ctrlpt_tolerance = tolerance - removal_error - knot_error;
+        if (!(ctrlpt_tolerance > 0))
+        {
+            throw std::logic_error("knot resolution is too coarse for the tolerance.");
+        }
+        _Dt step = _Dt(2.0) * ctrlpt_tolerance / std::sqrt(_Dt(3.0));
+
+        std::vector<uint8_t> data;
+        data.reserve(HEADER_SIZE + 2 * 10 + knots.size() * 4 + ctrlpts.size() * 3 * 4);
+
+        data.insert(data.end(), {'B', 'S', 'C', 'C', VERSION, uint8_t(degree), uint8_t(knot_bits), 0});
+        // removal_error + knot_error + ctrlpt_tolerance, without the rounding error of the sum
+        _put_float64(data, double(tolerance));
+        _put_float64(data, double(step));
+        _put_varint(data, knots.size());
+        _put_varint(data, ctrlpts.size());
+
+        uint64_t last_knot = 0;
+        for (auto k : q_knots)
+        {
+            _put_varint(data, k - last_knot);
+            last_knot = k;
+        }
+
+        int64_t last[3] = {0, 0, 0};
+        for (const auto& p : ctrlpts)
+        {
+            const _Dt coordinates[3] = {p.x, p.y, p.z};
+            for (int c = 0; c < 3; c++)
+            {
+                _Dt q = std::round(coordinates[c] / step);
+                if (!(std::abs(q) < _Dt(int64_t(1) << 62)))
+                {
+                    throw std::logic_error("control point is too far from the origin for the tolerance.");
+                }
+                auto value = int64_t(q);
+                _put_svarint(data, value - last[c]);
+                last[c] = value;
+            }
+        }
+
+        return data;
+    }
+
+    /// Read the fields of an encoded curve.
+    /// \param data the encoded bytes
+    /// \param size the number of bytes
+    /// \param info the fields
+    /// \return false if `data` is not an encoded curve
+    static bool read_info(const uint8_t* data, size_t size, Info& info)
+    {
+        const uint8_t* p = data;
+        return _read_header(p, data + size, info);
+    }
+
+    /// Decode a B spline curve. The vertices of the curve are not computed, see `recalculate_curve`.
+    /// \param data the encoded bytes
+    /// \param size the number of bytes
+    /// \param curve the decoded curve, such as `BSplineCurve`
+    /// \return false if `data` is not an encoded curve or it is truncated
+    template <typename _Curve>
+    static bool decode(const uint8_t* data, size_t size, _Curve& curve)
+    {
+        const uint8_t* p = data;
+        const uint8_t* end = data + size;
+
+        Info info;
+        if (!_read_header(p, end, info))
+        {
+            return false;
+        }
+
+        const _Dt knot_step = std::ldexp(_Dt(1.0), -info.knot_bits);
+        std::vector<_Dt> knots(info.n_knot);
+        uint64_t k = 0, delta;
+        for (size_t i = 0; i < info.n_knot; i++)
+        {
+            if (!_get_varint(p, end, delta))
+            {
+                return false;
+            }
+            k += delta;
+            knots[i] = k * knot_step;
+        }
+
+        std::vector<_Vt> ctrlpts(info.n_ctrlpt);
+        int64_t q[3] = {0, 0, 0};
+        int64_t d;
+        for (size_t i = 0; i < info.n_ctrlpt; i++)
+        {
+            for (int c = 0; c < 3; c++)
+            {
+                if (!_get_svarint(p, end, d))
+                {
+                    return false;
+                }
+                q[c] += d;
+            }
+            ctrlpts[i] = _Vt(q[0] * info.step, q[1] * info.step, q[2] * info.step);
+        }
+
+        curve.set_degree(info.degree);
+        curve.set_control_points(ctrlpts);
+        curve.set_knot_vector(knots);
+        return true;
+    }
+
+    /// Encode a B spline curve into a file.
+    /// \param filename the filename
+    /// \param curve the curve
+    /// \param tolerance max distance between the decoded curve and `curve`
+    /// \return false if the file cannot be written
+    template <typename _Curve>
+    static bool write(const QString& filename, const _Curve& curve, _Dt tolerance)
+    {
+        auto data = encode(curve, tolerance);
+
+        QFile file(filename);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        {
+            return false;
+        }
+        bool ok = file.write(reinterpret_cast<const char*>(data.data()), qint64(data.size())) == qint64(data.size());
+        file.close();
+        return ok;
+    }
+
+    /// Decode a B spline curve from a file.
+    /// \param filename the filename
+    /// \param curve the decoded curve
+    /// \return false if the file cannot be read or decoded
+    template <typename _Curve>
+    static bool read(const QString& filename, _Curve& curve)
+    {
+        QFile file(filename);
+        if (!file.open(QIODevice::ReadOnly))
+        {
+            return false;
+        }
+        QByteArray bytes = file.readAll();
+        file.close();
+
+        return decode(reinterpret_cast<const uint8_t*>(bytes.constData()), size_t(bytes.size()), curve);
+    }
+
+private:
+    /// Bound of the distance between the curves on the same control points and the knot vectors before and after
+    /// quantization. The quantized knots are mapped affinely onto the domain of the source ones, which moves no
+    /// point of the curve, then both curves are refined to the merged knot vector. Their difference is a B spline
+    /// on it, so by the convex hull property it is bounded by the longest difference of the control points.
+    static _Dt _knot_deviation(int degree, const std::vector<_Vt>& ctrlpts, const std::vector<_Dt>& knots,
+                               const std::vector<_Dt>& quantized)
+    {
+        using _Curve = BSplineCurve<CurvePoint<_Dt, BSplinePointTrait<_Dt>>>;
+
+        int n = int(ctrlpts.size()) - 1;
+        _Dt a = knots[degree], b = knots[n + 1];
+        _Dt qa = quantized[degree], qb = quantized[n + 1];
+
+        std::vector<_Dt> moved(quantized);
+        if (qa != a || qb != b)
+        {
+            for (auto& u : moved)
+            {
+                u = a + (u - qa) * (b - a) / (qb - qa);
+            }
+            std::fill(moved.begin(), moved.begin() + degree + 1, a);
+            std::fill(moved.begin() + n + 1, moved.end(), b);
+        }
+
+        // the knots of each inner knot vector missing from the other one, counting multiplicity
+        std::vector<_Dt> to_origin, to_moved;
+        std::set_difference(moved.begin() + degree + 1, moved.begin() + n + 1, knots.begin() + degree + 1,
+                            knots.begin() + n + 1, std::back_inserter(to_origin));
+        std::set_difference(knots.begin() + degree + 1, knots.begin() + n + 1, moved.begin() + degree + 1,
+                            moved.begin() + n + 1, std::back_inserter(to_moved));
+
+        _Curve origin(degree, ctrlpts, knots);
+        _Curve moved_curve(degree, ctrlpts, moved);
+        origin.refine_knot_vector(to_origin);
+        moved_curve.refine_knot_vector(to_moved);
+
+        const auto& p = origin.get_control_points();
+        const auto& q = moved_curve.get_control_points();
+        _Dt max_error = 0;
+        for (size_t i = 0; i < p.size(); i++)
+        {
+            max_error = std::max(max_error, (p[i] - q[i]).length());
+        }
+        return max_error;
+    }
+
+    static bool _read_header(const uint8_t*& p, const uint8_t* end, Info& info)
+    {
+        if (end - p < long(HEADER_SIZE) || std::memcmp(p, "BSCC", 4) != 0 || p[4] != VERSION)
+        {
+            return false;
+        }
+        info.degree = p[5];
+        info.knot_bits = p[6];
+        p += 8;
+        info.error_bound = _Dt(_get_float64(p));
+        info.step = _Dt(_get_float64(p));
+
+        uint64_t n_knot, n_ctrlpt;
+        if (!_get_varint(p, end, n_knot) || !_get_varint(p, end, n_ctrlpt))
+        {
+            return false;
+        }
+        // a knot or a control point takes 1 byte at least
+        if (n_knot > uint64_t(end - p) || n_ctrlpt > uint64_t(end - p))
+        {
+            return false;
+        }
+        // a B spline of degree p with n + 1 control points has n + p + 2 knots
+        if (info.degree < 1 || n_ctrlpt < uint64_t(info.degree) + 1 || n_knot != n_ctrlpt + info.degree + 1)
+        {
+            return false;
+        }
+        info.n_knot = size_t(n_knot);
+        info.n_ctrlpt = size_t(n_ctrlpt);
+        return true;
+    }
+
+    static void _put_varint(std::vector<uint8_t>& data, uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            data.push_back(uint8_t(value | 0x80));
+            value >>= 7;
+        }
+        data.push_back(uint8_t(value));
+    }
+
+    static void _put_svarint(std::vector<uint8_t>& data, int64_t value)
+    {
+        _put_varint(data, (uint64_t(value) << 1) ^ uint64_t(value >> 63));
+    }
+
+    static void _put_float64(std::vector<uint8_t>& data, double value)
+    {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        for (int i = 0; i < 8; i++)
+        {
+            data.push_back(uint8_t(bits >> (8 * i)));
+        }
+    }
+
+    static bool _get_varint(const uint8_t*& p, const uint8_t* end, uint64_t& value)
+    {
+        value = 0;
+        for (int shift = 0; shift < 64 && p < end; shift += 7)
+        {
+            uint8_t byte = *p++;
+            value |= uint64_t(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static bool _get_svarint(const uint8_t*& p, const uint8_t* end, int64_t& value)
+    {
+        uint64_t zigzag;
+        if (!_get_varint(p, end, zigzag))
+        {
+            return false;
+        }
+        value = int64_t(zigzag >> 1) ^ -int64_t(zigzag & 1);
+        return true;
+    }
+
+    static double _get_float64(const uint8_t*& p)
+    {
+        uint64_t bits = 0;
+        for (int i = 0; i < 8; i++)
+        {
+            bits |= uint64_t(p[i]) << (8 * i);
+        }
+        p += 8;
+
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+};
+
+#endif //B_SPLINE_CURVECOMPACTCODEC_H
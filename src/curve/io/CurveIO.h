@@ -6,15 +6,19 @@
 #define B_SPLINE_CURVEIO_H
 
 #include <QFile>
-#include <QtCore/QTextStream>
 
+#include <algorithm>
+#include <charconv>
+#include <cstring>
 #include <type_traits>
+#include <vector>
 
 #include "../base_type/utility.h"
+#include "../util/Parallel.h"
 #include "../Curve.h"
 
-template <typename>
-struct Curve;
+template <typename, typename>
+class Curve;
 
 template <typename _CurvePoint>
 class CurveIO
@@ -22,46 +26,179 @@ class CurveIO
 public:
     using _Pt = _CurvePoint;
     using _Dt = typename _Pt::_Dt;
-    using _Ct = Curve<_Pt>;
 
 private:
     QString m_filename;
 
+    /// minimum number of bytes of a chunk parsed by a thread
+    static constexpr long _min_grain = 1 << 20;
+
 public:
-    void read_from_file(_Ct& curve, const QString& filename)
+    /// Read vertices ("v x y z" lines) of an OBJ/.cd file and append them to the curve.
+    /// The file is mapped into memory and parsed in place, chunks of large files are parsed in parallel.
+    /// \param curve the curve, such as `Curve`
+    /// \param filename the filename
+    template <typename _Curve>
+    void read_from_file(_Curve& curve, const QString& filename)
     {
         auto& vertices = curve.get_vertices();
 
         this->m_filename = filename;
         QFile file(filename);
-        if (file.open(QIODevice::ReadOnly))
+        if (!file.open(QIODevice::ReadOnly))
+        {
+            return;
+        }
+
+        auto size = file.size();
+        if (size <= 0)
+        {
+            file.close();
+            return;
+        }
+
+        const char* data = reinterpret_cast<const char*>(file.map(0, size));
+        QByteArray buffer;
+        if (data == nullptr)
+        {
+            // mapping is not supported by the device, read the whole file instead
+            buffer = file.readAll();
+            data = buffer.constData();
+            size = buffer.size();
+        }
+
+        parse_vertices(data, data + size, vertices);
+
+        if (buffer.isEmpty())
+        {
+            file.unmap(reinterpret_cast<unsigned char*>(const_cast<char*>(data)));
+        }
+        file.close();
+    }
+
+    /// Parse the vertices of OBJ/.cd text and append them to `vertices`.
+    /// Fields may be separated by any number of spaces or tabs, lines end with "\n" or "\r\n".
+    /// \param begin first character of the text
+    /// \param end one past the last character of the text
+    /// \param vertices vertices to append to, `std::vector<_Pt>` or `SoAVertexArray<_Pt>`
+    template <typename _Vertices>
+    static void parse_vertices(const char* begin, const char* end, _Vertices& vertices)
+    {
+        unsigned n_chunk = parallel_chunk_count(end - begin, _min_grain);
+
+        // chunks are aligned to line starts
+        std::vector<const char*> bounds(n_chunk + 1, end);
+        bounds[0] = begin;
+        for (unsigned i = 1; i < n_chunk; i++)
+        {
+            const char* p = begin + (end - begin) * long(i) / long(n_chunk);
+            p = std::max(p, bounds[i - 1]);
+            const char* line_end = static_cast<const char*>(std::memchr(p, '\n', end - p));
+            bounds[i] = line_end == nullptr ? end : line_end + 1;
+        }
+
+        // one vertex per line at most: every chunk gets a slot per line, at the prefix sum of the line counts
+        std::vector<size_t> offsets(n_chunk + 1, vertices.size());
+        parallel_for_chunk(0, n_chunk, n_chunk, [&](unsigned, long first, long last)
+        {
+            for (long i = first; i < last; i++)
+            {
+                offsets[i + 1] = _count_lines(bounds[i], bounds[i + 1]);
+            }
+        });
+        for (unsigned i = 0; i < n_chunk; i++)
+        {
+            offsets[i + 1] += offsets[i];
+        }
+
+        vertices.resize(offsets[n_chunk]);
+        std::vector<size_t> n_parsed(n_chunk);
+        parallel_for_chunk(0, n_chunk, n_chunk, [&](unsigned, long first, long last)
+        {
+            for (long i = first; i < last; i++)
+            {
+                auto slice = vertices.begin() + offsets[i];
+                n_parsed[i] = _parse_chunk(bounds[i], bounds[i + 1], slice) - slice;
+            }
+        });
+
+        // drop the slots of the lines without a vertex
+        auto out = vertices.begin() + offsets[0] + n_parsed[0];
+        for (unsigned i = 1; i < n_chunk; i++)
+        {
+            auto slice = vertices.begin() + offsets[i];
+            out = std::copy(slice, slice + n_parsed[i], out);
+        }
+        vertices.resize(out - vertices.begin());
+    }
+
+private:
+    static bool _is_blank(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    /// Parse a number in [`p`, `end`), skipping leading blanks.
+    /// \return position after the number, nullptr if there is no number
+    static const char* _parse_number(const char* p, const char* end, _Dt& value)
+    {
+        while (p < end && _is_blank(*p))
+        {
+            p++;
+        }
+        // from_chars does not accept a leading '+'
+        if (p < end && *p == '+')
         {
-            QTextStream in(&file);
-            QString line = in.readLine();
-            if(line.isNull())
+            p++;
+        }
+
+        auto result = std::from_chars(p, end, value);
+        if (result.ec != std::errc())
+        {
+            return nullptr;
+        }
+        return result.ptr;
+    }
+
+    /// Count the lines in [`begin`, `end`), the last one may have no line break.
+    static size_t _count_lines(const char* begin, const char* end)
+    {
+        size_t n_line = std::count(begin, end, '\n');
+        return begin < end && end[-1] != '\n' ? n_line + 1 : n_line;
+    }
+
+    /// Parse the vertices in [`begin`, `end`) and write them from `out` on.
+    /// \return position after the last vertex written
+    template <typename _OutputIt>
+    static _OutputIt _parse_chunk(const char* begin, const char* end, _OutputIt out)
+    {
+        _Pt point;
+        const char* p = begin;
+        while (p < end)
+        {
+            const char* line_end = static_cast<const char*>(std::memchr(p, '\n', end - p));
+            line_end = line_end == nullptr ? end : line_end;
+
+            while (p < line_end && _is_blank(*p))
             {
-                file.close();
-                return;
+                p++;
             }
 
-            _Pt point;
-            while (!line.isNull())
+            // "v" followed by a blank, not "vn" or "vt"
+            if (line_end - p > 1 && p[0] == 'v' && _is_blank(p[1]))
             {
-                QStringList slist = line.split(" ");
-                if(slist.size() > 3)
+                p++;
+                if ((p = _parse_number(p, line_end, point.vertex.x)) != nullptr
+                    && (p = _parse_number(p, line_end, point.vertex.y)) != nullptr
+                    && (p = _parse_number(p, line_end, point.vertex.z)) != nullptr)
                 {
-                    if(!slist.at(0).compare("v"))
-                    {
-                        point.vertex.x = slist.at(1).toDouble();
-                        point.vertex.y = slist.at(2).toDouble();
-                        point.vertex.z = slist.at(3).toDouble();
-                        vertices.push_back(point);
-                    }
+                    *out++ = point;
                 }
-                line = in.readLine();
             }
-            file.close();
+
+            p = line_end + 1;
         }
+        return out;
     }
 };
 
@@ -0,0 +1,240 @@
+//
+// Created by haochuanchen on 18-5-21.
+//
+
+#ifndef B_SPLINE_CURVESTREAMREADER_H
+#define B_SPLINE_CURVESTREAMREADER_H
+
+#include <QFile>
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "../Curve.h"
+#include "../base_type/CurveStatistics.h"
+
+/**
+ * Pull-based reader of the vertices of an OBJ/.cd file, block by block, with bounded memory.
+ * Statistics (bound box, max adjacent gap, end points) are accumulated over the vertices read, so a curve can be
+ * normalized in two passes without being materialized:
+ *
+ *     CurveStreamReader<_Pt> reader(filename);
+ *     auto statistics = reader.scan();                    // pass 1: statistics only
+ *     reader.set_transform(statistics.normalize_transform());
+ *     reader.set_close_periodic(statistics.is_periodic());
+ *     while (reader.read_block(block) > 0) { ... }        // pass 2: normalized blocks
+ *
+ * @tparam _CurvePoint curve point type
+ */
+template <typename _CurvePoint>
+class CurveStreamReader
+{
+public:
+    using _Pt = _CurvePoint;
+    using _Dt = typename _Pt::_Dt;
+
+private:
+    QString _filename;
+    std::unique_ptr<QFile> _file;
+
+    /// max number of vertices per block
+    size_t _block_size;
+
+    /// raw bytes read from the file, and the incomplete last line carried to the next read
+    std::vector<char> _buffer;
+    size_t _carry = 0;
+
+    /// parsed vertices not yet returned
+    std::vector<_Pt> _pending;
+    size_t _pending_pos = 0;
+
+    /// is the file exhausted
+    bool _eof = false;
+
+    /// statistics of the (untransformed) vertices returned so far
+    CurveStatistics<_Dt> _statistics;
+
+    /// transform applied to the returned vertices
+    bool _has_transform = false;
+    NormalizeTransform<_Dt> _transform;
+
+    /// repeat the first vertex at the end, as `Curve` does for periodic curves
+    bool _close_periodic = false;
+    bool _has_first = false;
+    _Pt _first;
+    bool _closed = false;
+
+public:
+    /**
+     * Create a stream reader.
+     * @param filename the filename
+     * @param block_size max number of vertices per block
+     * @param buffer_bytes size of the read buffer, longer lines are still read completely
+     */
+    explicit CurveStreamReader(const QString& filename, size_t block_size = 1 << 16, size_t buffer_bytes = 1 << 20)
+        : _filename(filename), _block_size(block_size), _buffer(buffer_bytes)
+    {
+        if (block_size == 0 || buffer_bytes == 0)
+        {
+            throw std::invalid_argument("block size and buffer size must be greater than zero.");
+        }
+        rewind();
+    }
+
+    /// Whether the file is opened.
+    bool is_open() const
+    {
+        return _file != nullptr;
+    }
+
+    /// Restart from the beginning of the file. The statistics are reset, the transform is kept.
+    void rewind()
+    {
+        _file = std::make_unique<QFile>(_filename);
+        if (!_file->open(QIODevice::ReadOnly))
+        {
+            _file.reset();
+        }
+
+        _carry = 0;
+        _pending.clear();
+        _pending_pos = 0;
+        _eof = _file == nullptr;
+        _statistics = CurveStatistics<_Dt>();
+        _has_first = false;
+        _closed = false;
+    }
+
+    /// Transform the returned vertices, such as normalization.
+    /// \param transform the transform
+    void set_transform(const NormalizeTransform<_Dt>& transform)
+    {
+        _has_transform = true;
+        _transform = transform;
+    }
+
+    /// Repeat the first vertex after the last one, to close a periodic curve.
+    /// \param close is closing
+    void set_close_periodic(bool close)
+    {
+        _close_periodic = close;
+    }
+
+    /// Read the next block of vertices.
+    /// \param block vertices of the block, cleared first
+    /// \return the number of vertices read, 0 at the end of the file
+    size_t read_block(std::vector<_Pt>& block)
+    {
+        block.clear();
+
+        while (block.size() < _block_size)
+        {
+            if (_pending_pos == _pending.size() && !_fill())
+            {
+                break;
+            }
+
+            size_t n = std::min(_block_size - block.size(), _pending.size() - _pending_pos);
+            for (size_t i = 0; i < n; i++)
+            {
+                _Pt point = _pending[_pending_pos + i];
+                _statistics.add(point.vertex);
+                if (_has_transform)
+                {
+                    point.vertex = _transform.apply(point.vertex);
+                }
+                if (!_has_first)
+                {
+                    _first = point;
+                    _has_first = true;
+                }
+                block.push_back(point);
+            }
+            _pending_pos += n;
+        }
+
+        if (block.size() < _block_size && _close_periodic && _has_first && !_closed)
+        {
+            block.push_back(_first);
+            _closed = true;
+        }
+
+        return block.size();
+    }
+
+    /// Read through the file to compute the statistics, then rewind.
+    /// \return statistics of the whole curve
+    CurveStatistics<_Dt> scan()
+    {
+        std::vector<_Pt> block;
+        block.reserve(_block_size);
+
+        bool close_periodic = _close_periodic;
+        _close_periodic = false;
+
+        while (read_block(block) > 0)
+        {
+        }
+
+        auto statistics = _statistics;
+        _close_periodic = close_periodic;
+        rewind();
+
+        return statistics;
+    }
+
+    /// Get the statistics of the vertices read so far, before transform.
+    /// \return the statistics
+    const CurveStatistics<_Dt>& get_statistics() const
+    {
+        return _statistics;
+    }
+
+private:
+    /// Read and parse more lines.
+    /// \return false if the file is exhausted
+    bool _fill()
+    {
+        _pending.clear();
+        _pending_pos = 0;
+
+        while (_pending.empty() && !_eof)
+        {
+            // grow the buffer if a single line does not fit
+            if (_carry == _buffer.size())
+            {
+                _buffer.resize(_buffer.size() * 2);
+            }
+
+            auto n_read = _file->read(_buffer.data() + _carry, qint64(_buffer.size() - _carry));
+            if (n_read <= 0)
+            {
+                _eof = true;
+                n_read = 0;
+            }
+
+            const char* begin = _buffer.data();
+            const char* end = begin + _carry + n_read;
+
+            // parse complete lines only, unless it is the end
+            const char* parse_end = end;
+            if (!_eof)
+            {
+                while (parse_end > begin && parse_end[-1] != '\n')
+                {
+                    parse_end--;
+                }
+            }
+
+            CurveIO<_Pt>::parse_vertices(begin, parse_end, _pending);
+
+            _carry = end - parse_end;
+            std::memmove(_buffer.data(), parse_end, _carry);
+        }
+
+        return !_pending.empty();
+    }
+};
+
+#endif //B_SPLINE_CURVESTREAMREADER_H
@@ -0,0 +1,59 @@
+//
+// Created by haochuanchen on 18-5-26.
+//
+
+#ifndef B_SPLINE_ALIGNEDALLOCATOR_H
+#define B_SPLINE_ALIGNEDALLOCATOR_H
+
+#include <cstddef>
+#include <new>
+
+/**
+ * Allocator of memory aligned to `_Alignment` bytes, e.g. for arrays loaded by SIMD instructions.
+ * @tparam _Type element type
+ * @tparam _Alignment alignment in bytes, a power of 2, default 64 (a cache line)
+ */
+template <typename _Type, size_t _Alignment = 64>
+struct AlignedAllocator
+{
+public:
+    using value_type = _Type;
+
+    template <typename _Other>
+    struct rebind
+    {
+        using other = AlignedAllocator<_Other, _Alignment>;
+    };
+
+public:
+    AlignedAllocator() = default;
+
+    template <typename _Other>
+    AlignedAllocator(const AlignedAllocator<_Other, _Alignment>&)
+    {
+    }
+
+    _Type* allocate(size_t n)
+    {
+        return static_cast<_Type*>(::operator new(n * sizeof(_Type), std::align_val_t(_Alignment)));
+    }
+
+    void deallocate(_Type* p, size_t)
+    {
+        ::operator delete(p, std::align_val_t(_Alignment));
+    }
+
+    template <typename _Other>
+    bool operator==(const AlignedAllocator<_Other, _Alignment>&) const
+    {
+        return true;
+    }
+
+    template <typename _Other>
+    bool operator!=(const AlignedAllocator<_Other, _Alignment>&) const
+    {
+        return false;
+    }
+};
+
+#endif //B_SPLINE_ALIGNEDALLOCATOR_H
@@ -0,0 +1,289 @@
+//
+// Created by haochuanchen on 18-5-28.
+//
+
+#ifndef B_SPLINE_ARCLENGTHTABLE_H
+#define B_SPLINE_ARCLENGTHTABLE_H
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "BSplineEvaluator.h"
+#include "Parallel.h"
+
+/**
+ * Arc length table of a B spline curve, for the arc length s(u) and its inverse u(s).
+ * Every non-empty knot span is split into sub-intervals, whose lengths are integrated by 8-point Gauss-Legendre
+ * quadrature of the speed |C'(u)| and accumulated. The inverse looks up the sub-interval in the table, interpolates
+ * linearly, then polishes by safeguarded Newton iteration.
+ *
+ * The table is immutable once built. Queries without an evaluator use the table's own one and are NOT THREAD SAFETY;
+ * pass one `BSplineEvaluator` per thread to query in parallel.
+ * The control points and the knot vector are referenced, not copied.
+ * @tparam _DataType data type of the coordinate, default double
+ */
+template <typename _DataType = double>
+class ArcLengthTable
+{
+public:
+    using _Dt = _DataType;
+    using _Vt = Vector3X<_Dt>;
+    using _Evaluator = BSplineEvaluator<_Dt>;
+
+private:
+    int _degree;
+    const std::vector<_Vt>& _ctrlpts;
+    const std::vector<_Dt>& _knots;
+
+    /// parameters of the ends of the sub-intervals, _Dt[n_interval + 1]
+    std::vector<_Dt> _u;
+    /// arc length at `_u`, _Dt[n_interval + 1]
+    std::vector<_Dt> _s;
+    /// knot span index of the sub-intervals, int[n_interval]
+    std::vector<int> _span;
+
+    /// evaluator of the queries without an evaluator
+    std::unique_ptr<_Evaluator> _evaluator;
+
+    /// 8-point Gauss-Legendre nodes on [-1, 1], the positive half
+    static constexpr double _gl_nodes[4] = {0.1834346424956498, 0.5255324099163290,
+                                            0.7966664774136267, 0.9602898564975363};
+    static constexpr double _gl_weights[4] = {0.3626837833783620, 0.3137066458778873,
+                                              0.2223810344533745, 0.1012285362903763};
+
+    /// minimum number of sub-intervals integrated by a thread
+    static constexpr long _min_grain = 256;
+
+public:
+    /**
+     * Build the arc length table of a B spline curve.
+     * @param degree degree(order - 1) of the B spline
+     * @param control_points control points of the B spline
+     * @param knots knot vector of the B spline
+     * @param n_subdivision the number of sub-intervals per knot span
+     */
+    ArcLengthTable(int degree, const std::vector<_Vt>& control_points, const std::vector<_Dt>& knots,
+                   int n_subdivision = 4)
+        : _degree(degree), _ctrlpts(control_points), _knots(knots)
+    {
+        if (n_subdivision < 1)
+        {
+            throw std::invalid_argument("a knot span contains at least one sub-interval.");
+        }
+
+        int n = int(control_points.size()) - 1;
+        for (int i = degree; i <= n; i++)
+        {
+            if (knots[i + 1] <= knots[i])
+            {
+                continue;
+            }
+            for (int j = 0; j < n_subdivision; j++)
+            {
+                _u.push_back(knots[i] + (knots[i + 1] - knots[i]) * j / n_subdivision);
+                _span.push_back(i);
+            }
+        }
+        _u.push_back(knots[n + 1]);
+
+        // lengths of the sub-intervals in parallel, then the prefix sum
+        long n_interval = long(_span.size());
+        _s.assign(n_interval + 1, _Dt(0.0));
+        parallel_for(0, n_interval, [&](long first, long last)
+        {
+            _Evaluator evaluator(degree, control_points, knots, 1);
+            for (long k = first; k < last; k++)
+            {
+                _s[k + 1] = _integrate(evaluator, _span[k], _u[k], _u[k + 1]);
+            }
+        }, _min_grain);
+
+        for (long k = 0; k < n_interval; k++)
+        {
+            _s[k + 1] += _s[k];
+        }
+
+        _evaluator = std::make_unique<_Evaluator>(degree, control_points, knots, 1);
+    }
+
+    /**
+     * Build the arc length table of a B spline curve, such as `BSplineCurve`.
+     * @param curve the curve, must outlive the table
+     * @param n_subdivision the number of sub-intervals per knot span
+     */
+    template <typename _Curve>
+    explicit ArcLengthTable(const _Curve& curve, int n_subdivision = 4)
+        : ArcLengthTable(curve.get_degree(), curve.get_control_points(), curve.get_knot_vector(), n_subdivision)
+    {
+    }
+
+    ArcLengthTable(const ArcLengthTable&) = delete;
+    ArcLengthTable& operator=(const ArcLengthTable&) = delete;
+
+    /**
+     * Get the length of the whole curve.
+     * @return the length
+     */
+    _Dt length() const
+    {
+        return _s.back();
+    }
+
+    /**
+     * Get the arc length from the start of the curve to parameter u.
+     * @param u the parameter
+     * @return the arc length
+     */
+    _Dt arc_length(_Dt u) const
+    {
+        return arc_length(u, *_evaluator);
+    }
+
+    /**
+     * Get the arc length from the start of the curve to parameter u.
+     * @param u the parameter
+     * @param evaluator evaluator of the curve, one per thread
+     * @return the arc length
+     */
+    _Dt arc_length(_Dt u, const _Evaluator& evaluator) const
+    {
+        if (_span.empty() || u <= _u.front())
+        {
+            return _Dt(0.0);
+        }
+        if (u >= _u.back())
+        {
+            return length();
+        }
+
+        long k = _interval_of(_u, u);
+        return _s[k] + _integrate(evaluator, _span[k], _u[k], u);
+    }
+
+    /**
+     * Get the parameter at arc length s, the inverse of `arc_length`.
+     * @param s the arc length, clamped to [0, length()]
+     * @return the parameter
+     */
+    _Dt parameter(_Dt s) const
+    {
+        return parameter(s, *_evaluator);
+    }
+
+    /**
+     * Get the parameter at arc length s, the inverse of `arc_length`.
+     * @param s the arc length, clamped to [0, length()]
+     * @param evaluator evaluator of the curve, one per thread
+     * @return the parameter
+     */
+    _Dt parameter(_Dt s, const _Evaluator& evaluator) const
+    {
+        if (_span.empty() || s <= 0)
+        {
+            return _u.front();
+        }
+        if (s >= length())
+        {
+            return _u.back();
+        }
+
+        long k = _interval_of(_s, s);
+        int span = _span[k];
+        _Dt a = _u[k], b = _u[k + 1];
+        _Dt s_a = _s[k];
+
+        // linear guess, then Newton on s_a + length(a, u) - s, kept inside the bracket [a, b]
+        _Dt u = a + (b - a) * (s - s_a) / (_s[k + 1] - s_a);
+        _Dt tolerance = length() * std::numeric_limits<_Dt>::epsilon() * 16;
+        _Vt ders[2];
+
+        for (int iter = 0; iter < 16; iter++)
+        {
+            _Dt f = s_a + _integrate(evaluator, span, a, u) - s;
+            if (std::abs(f) <= tolerance)
+            {
+                break;
+            }
+
+            if (f > 0)
+            {
+                b = u;
+            }
+            else
+            {
+                a = u;
+                s_a = s + f;
+            }
+
+            evaluator.derivatives(span, u, 1, ders);
+            _Dt speed = ders[1].length();
+            _Dt next = speed > 0 ? u - f / speed : a - 1;
+
+            // bisect if Newton leaves the bracket
+            u = next > a && next < b ? next : (a + b) / 2;
+        }
+
+        return u;
+    }
+
+    /**
+     * Get the parameters of `count` points equally spaced by arc length, from the start to the end, in parallel.
+     * @param count the number of points, at least 2
+     * @return the parameters
+     */
+    std::vector<_Dt> equal_arc_length_parameters(long count) const
+    {
+        if (count < 2)
+        {
+            throw std::invalid_argument("at least 2 points are sampled.");
+        }
+
+        std::vector<_Dt> parameters(count);
+        _Dt step = length() / (count - 1);
+        parallel_for(0, count, [&](long first, long last)
+        {
+            _Evaluator evaluator(_degree, _ctrlpts, _knots, 1);
+            for (long i = first; i < last; i++)
+            {
+                parameters[i] = parameter(step * i, evaluator);
+            }
+        }, _min_grain);
+
+        parameters.front() = _u.front();
+        parameters.back() = _u.back();
+        return parameters;
+    }
+
+private:
+    /// Index k of the interval [values[k], values[k + 1]) containing `value`, values[0] <= value < values.back().
+    static long _interval_of(const std::vector<_Dt>& values, _Dt value)
+    {
+        long k = long(std::upper_bound(values.begin(), values.end(), value) - values.begin()) - 1;
+        return std::min(std::max(k, 0L), long(values.size()) - 2);
+    }
+
+    /// Length of the curve over [a, b] inside knot span `span`, by 8-point Gauss-Legendre quadrature.
+    static _Dt _integrate(const _Evaluator& evaluator, int span, _Dt a, _Dt b)
+    {
+        _Dt half = (b - a) / 2, mid = (a + b) / 2;
+        _Vt ders[2];
+
+        _Dt sum = _Dt(0.0);
+        for (int i = 0; i < 4; i++)
+        {
+            _Dt offset = half * _Dt(_gl_nodes[i]);
+            evaluator.derivatives(span, mid - offset, 1, ders);
+            _Dt speed = ders[1].length();
+            evaluator.derivatives(span, mid + offset, 1, ders);
+            speed += ders[1].length();
+            sum += _Dt(_gl_weights[i]) * speed;
+        }
+        return sum * half;
+    }
+};
+
+#endif //B_SPLINE_ARCLENGTHTABLE_H
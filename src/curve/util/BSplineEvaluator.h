@@ -0,0 +1,194 @@
+//
+// Created by haochuanchen on 18-5-12.
+//
+
+#ifndef B_SPLINE_BSPLINEEVALUATOR_H
+#define B_SPLINE_BSPLINEEVALUATOR_H
+
+#include <vector>
+
+#include "../base_type/Vector3X.h"
+#include "BSplineFunction.h"
+
+/**
+ * Evaluate points and derivatives of a B spline curve at arbitrary parameters.
+ * It keeps the scratch arrays of the basis functions, so evaluation does not allocate.
+ * Like `BSplineFunction`, it is NOT THREAD SAFETY, create one evaluator per thread.
+ * The control points and the knot vector are referenced, not copied.
+ * @tparam _DataType data type of the coordinate, default double
+ */
+template <typename _DataType = double>
+class BSplineEvaluator
+{
+public:
+    using _Dt = _DataType;
+    using _Vt = Vector3X<_Dt>;
+
+private:
+    /// degree(order - 1) of the B spline
+    int _degree;
+
+    /// control points of the B spline
+    const std::vector<_Vt>& _ctrlpts;
+
+    /// knot vector
+    const std::vector<_Dt>& _knots;
+
+    /// basis functions
+    BSplineFunction<_Dt> _bf;
+
+    /// max derivative order supported
+    int _max_order;
+
+    /// basis functions and their derivatives, _Dt[_max_order + 1][degree + 1], scratch of the const evaluations
+    mutable std::vector<std::vector<_Dt>> _ders;
+    mutable std::vector<_Dt*> _ders_rows;
+
+public:
+    /**
+     * Create an evaluator of the B spline curve.
+     * @param degree degree(order - 1) of the B spline
+     * @param control_points control points of the B spline
+     * @param knots knot vector of the B spline
+     * @param max_order max derivative order to evaluate
+     */
+    BSplineEvaluator(int degree, const std::vector<_Vt>& control_points, const std::vector<_Dt>& knots,
+                     int max_order = 3)
+        : _degree(degree), _ctrlpts(control_points), _knots(knots),
+          _bf(int(control_points.size()) - 1, degree, knots), _max_order(max_order)
+    {
+        _ders.assign(max_order + 1, std::vector<_Dt>(degree + 1));
+        for (auto& row : _ders)
+        {
+            _ders_rows.push_back(row.data());
+        }
+    }
+
+    /**
+     * Create an evaluator of a B spline curve, such as `BSplineCurve`.
+     * @param curve the curve, must outlive the evaluator
+     * @param max_order max derivative order to evaluate
+     */
+    template <typename _Curve>
+    explicit BSplineEvaluator(const _Curve& curve, int max_order = 3)
+        : BSplineEvaluator(curve.get_degree(), curve.get_control_points(), curve.get_knot_vector(), max_order)
+    {
+    }
+
+    BSplineEvaluator(const BSplineEvaluator&) = delete;
+    BSplineEvaluator& operator=(const BSplineEvaluator&) = delete;
+
+    /**
+     * Determine the knot span index of parameter u.
+     * @param u the parameter
+     * @return the knot span index
+     */
+    int find_span(_Dt u) const
+    {
+        return _bf.find_span(u);
+    }
+
+    /**
+     * Compute the point on the curve.
+     * See: *The NURBS Book* Algorithm A3.1
+     * @param u the parameter
+     * @return the point
+     */
+    _Vt point(_Dt u) const
+    {
+        return point(_bf.find_span(u), u);
+    }
+
+    /**
+     * Compute the point on the curve, with known knot span.
+     * @param span the index of the knot span containing u
+     * @param u the parameter
+     * @return the point
+     */
+    _Vt point(int span, _Dt u) const
+    {
+        _Dt* func_values = _ders_rows[0];
+        _bf.basis_funcs(span, u, func_values);
+
+        _Vt result;
+        for (int i = 0; i <= _degree; i++)
+        {
+            result += func_values[i] * _ctrlpts[span - _degree + i];
+        }
+        return result;
+    }
+
+    /**
+     * Compute the point and derivatives on the curve. Derivatives higher than the degree are zero.
+     * See: *The NURBS Book* Algorithm A3.2
+     * @param u the parameter
+     * @param order max derivative order, no more than `max_order` of the evaluator
+     * @param ders pre-alloced array to store C(u), C'(u), ..., _Vt[order + 1]
+     */
+    void derivatives(_Dt u, int order, _Vt* ders) const
+    {
+        derivatives(_bf.find_span(u), u, order, ders);
+    }
+
+    /**
+     * Compute the point and derivatives on the curve, with known knot span.
+     * @param span the index of the knot span containing u
+     * @param u the parameter
+     * @param order max derivative order, no more than `max_order` of the evaluator
+     * @param ders pre-alloced array to store C(u), C'(u), ..., _Vt[order + 1]
+     */
+    void derivatives(int span, _Dt u, int order, _Vt* ders) const
+    {
+        if (order > _max_order)
+        {
+            throw std::invalid_argument("derivative order is greater than the max order of the evaluator.");
+        }
+
+        int du = order < _degree ? order : _degree;
+
+        _bf.ders_basis_funcs(span, u, du, _ders_rows.data());
+
+        for (int k = 0; k <= du; k++)
+        {
+            ders[k] = _Vt();
+            for (int j = 0; j <= _degree; j++)
+            {
+                ders[k] += _ders_rows[k][j] * _ctrlpts[span - _degree + j];
+            }
+        }
+
+        for (int k = du + 1; k <= order; k++)
+        {
+            ders[k] = _Vt();
+        }
+    }
+
+    /**
+     * Get the degree of the curve.
+     * @return degree
+     */
+    int get_degree() const
+    {
+        return _degree;
+    }
+
+    /**
+     * Get the control points of the curve.
+     * @return control points
+     */
+    const std::vector<_Vt>& get_control_points() const
+    {
+        return _ctrlpts;
+    }
+
+    /**
+     * Get the knot vector of the curve.
+     * @return knot vector
+     */
+    const std::vector<_Dt>& get_knot_vector() const
+    {
+        return _knots;
+    }
+};
+
+#endif //B_SPLINE_BSPLINEEVALUATOR_H
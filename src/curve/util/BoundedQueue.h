@@ -0,0 +1,103 @@
+//
+// Created by haochuanchen on 18-5-23.
+//
+
+#ifndef B_SPLINE_BOUNDEDQUEUE_H
+#define B_SPLINE_BOUNDEDQUEUE_H
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+/**
+ * Blocking FIFO queue with a capacity, to connect the stages of a pipeline with backpressure.
+ * Producers block while it is full, consumers block while it is empty. After `close()`, `push` fails and `pop` drains
+ * the remaining items then fails.
+ * @tparam _Type item type
+ */
+template <typename _Type>
+class BoundedQueue
+{
+private:
+    std::deque<_Type> _items;
+    size_t _capacity;
+    bool _closed = false;
+
+    std::mutex _mutex;
+    std::condition_variable _not_full;
+    std::condition_variable _not_empty;
+
+public:
+    /**
+     * Create a queue.
+     * @param capacity max number of items, at least 1
+     */
+    explicit BoundedQueue(size_t capacity)
+        : _capacity(capacity == 0 ? 1 : capacity)
+    {
+    }
+
+    /**
+     * Push an item, blocking while the queue is full.
+     * @param item the item
+     * @return false if the queue is closed
+     */
+    bool push(_Type item)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _not_full.wait(lock, [this] { return _closed || _items.size() < _capacity; });
+        if (_closed)
+        {
+            return false;
+        }
+        _items.push_back(std::move(item));
+        lock.unlock();
+        _not_empty.notify_one();
+        return true;
+    }
+
+    /**
+     * Pop an item, blocking while the queue is empty.
+     * @param item the popped item
+     * @return false if the queue is closed and drained
+     */
+    bool pop(_Type& item)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _not_empty.wait(lock, [this] { return _closed || !_items.empty(); });
+        if (_items.empty())
+        {
+            return false;
+        }
+        item = std::move(_items.front());
+        _items.pop_front();
+        lock.unlock();
+        _not_full.notify_one();
+        return true;
+    }
+
+    /**
+     * Close the queue and wake up all the waiting threads.
+     */
+    void close()
+    {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _closed = true;
+        }
+        _not_full.notify_all();
+        _not_empty.notify_all();
+    }
+
+    /**
+     * Get the number of items in the queue.
+     * @return the number of items
+     */
+    size_t size()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        return _items.size();
+    }
+};
+
+#endif //B_SPLINE_BOUNDEDQUEUE_H
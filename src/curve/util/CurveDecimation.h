@@ -0,0 +1,212 @@
+//
+// Created by haochuanchen on 18-5-10.
+//
+
+#ifndef B_SPLINE_CURVEDECIMATION_H
+#define B_SPLINE_CURVEDECIMATION_H
+
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "../ParaCurve.h"
+#include "Parallel.h"
+
+/**
+ * Reduce the vertices of an oversampled parameterized curve before fitting.
+ * Douglas-Peucker simplification drops the vertices within `tolerance` of the simplified polyline, then vertices are
+ * put back wherever two adjacent kept vertices are more than `max_gap` apart, so the density does not become too
+ * sparse for least squares fitting. The kept vertices are the original ones, with their parameters unchanged.
+ * Long curves are split into chunks simplified in parallel; the chunk boundaries are kept, so the error is still
+ * bounded by `tolerance`.
+ * @tparam _Curve parameterized curve type
+ */
+template <typename _Curve>
+class CurveDecimation
+{
+public:
+    using _Ct = _Curve;
+    using _Pt = typename _Ct::_Pt;
+    using _Dt = typename _Pt::_Dt;
+
+    static_assert(std::is_base_of<ParaCurve<_Pt, typename _Ct::_Storage>, _Ct>::value);
+
+private:
+    /// maximum distance between a dropped vertex and the simplified polyline
+    _Dt _tolerance;
+
+    /// maximum distance between two adjacent kept vertices, 0 means no limit
+    _Dt _max_gap;
+
+    /// minimum number of vertices of a chunk simplified by a thread
+    long _min_grain = 1 << 16;
+
+public:
+    /**
+     * Create a decimation.
+     * @param tolerance maximum distance between a dropped vertex and the simplified polyline
+     * @param max_gap maximum distance between two adjacent kept vertices, 0 means no limit
+     */
+    explicit CurveDecimation(_Dt tolerance, _Dt max_gap = _Dt(0.0))
+        : _tolerance(tolerance), _max_gap(max_gap)
+    {
+        if (tolerance < 0 || max_gap < 0)
+        {
+            throw std::invalid_argument("tolerance and max gap of decimation must be non-negative.");
+        }
+    }
+
+    /**
+     * Set the minimum number of vertices of a chunk simplified by a thread.
+     * @param n_vertex the number of vertices, at least 2
+     */
+    void set_min_grain(long n_vertex)
+    {
+        if (n_vertex < 2)
+        {
+            throw std::invalid_argument("a chunk of decimation contains at least 2 vertices.");
+        }
+        _min_grain = n_vertex;
+    }
+
+    /**
+     * Select the vertices to keep.
+     * @param curve the curve to decimate
+     * @return ascending indices of the kept vertices, including both end points
+     */
+    std::vector<int> select(const _Ct& curve) const
+    {
+        const auto& vertices = curve.get_vertices();
+        long num_v = vertices.size();
+
+        if (num_v <= 2)
+        {
+            std::vector<int> all(num_v);
+            for (int i = 0; i < num_v; i++)
+            {
+                all[i] = i;
+            }
+            return all;
+        }
+
+        std::vector<char> keep(num_v, 0);
+
+        parallel_for(0, num_v - 1, [&](long first, long last)
+        {
+            _douglas_peucker(vertices, first, last, keep);
+        }, _min_grain);
+        keep[num_v - 1] = 1;
+
+        std::vector<int> indices;
+        for (int i = 0; i < num_v; i++)
+        {
+            if (keep[i])
+            {
+                if (_max_gap > 0 && !indices.empty())
+                {
+                    _fill_gap(vertices, indices.back(), i, indices);
+                }
+                indices.push_back(i);
+            }
+        }
+
+        return indices;
+    }
+
+    /**
+     * Decimate the curve.
+     * The periodicity, the bound box, the normalize transform and the parameterization method are the ones of `curve`.
+     * @param curve the curve to decimate
+     * @return the decimated curve, its vertices keep their parameters
+     */
+    _Ct decimate(const _Ct& curve) const
+    {
+        auto indices = select(curve);
+
+        // the indices are ascending, so the kept vertices are moved to the front in place
+        _Ct result(curve);
+        auto& result_vertices = result.get_vertices();
+        for (size_t k = 0; k < indices.size(); k++)
+        {
+            result_vertices[k] = result_vertices[indices[k]];
+        }
+        result_vertices.resize(indices.size());
+
+        return result;
+    }
+
+private:
+    /**
+     * Iterative Douglas-Peucker on vertices [`first`, `last`]. Marks `first` and the kept inner vertices; `last` is
+     * marked by the next chunk, so that no flag is written by two threads.
+     */
+    void _douglas_peucker(const typename _Ct::_Vertices& vertices, long first, long last, std::vector<char>& keep) const
+    {
+        keep[first] = 1;
+
+        _Dt squared_tolerance = _tolerance * _tolerance;
+
+        std::vector<std::pair<long, long>> stack;
+        stack.emplace_back(first, last);
+
+        while (!stack.empty())
+        {
+            auto range = stack.back();
+            stack.pop_back();
+
+            if (range.second - range.first < 2)
+            {
+                continue;
+            }
+
+            const auto& a = vertices[range.first].vertex;
+            auto ab = vertices[range.second].vertex - a;
+            _Dt squared_ab = ab.squared_length();
+
+            _Dt max_dist = -1;
+            long max_index = range.first;
+            for (long i = range.first + 1; i < range.second; i++)
+            {
+                auto ap = vertices[i].vertex - a;
+
+                // squared distance from the vertex to segment ab
+                _Dt t = squared_ab > 0 ? ap.dot(ab) / squared_ab : _Dt(0.0);
+                t = t < 0 ? _Dt(0.0) : (t > 1 ? _Dt(1.0) : t);
+                _Dt dist = (ap - ab * t).squared_length();
+
+                if (dist > max_dist)
+                {
+                    max_dist = dist;
+                    max_index = i;
+                }
+            }
+
+            if (max_dist > squared_tolerance)
+            {
+                keep[max_index] = 1;
+                stack.emplace_back(range.first, max_index);
+                stack.emplace_back(max_index, range.second);
+            }
+        }
+    }
+
+    /**
+     * Append the vertices between `first` and `last` (both exclusive), to keep adjacent vertices no more than
+     * `_max_gap` apart.
+     */
+    void _fill_gap(const typename _Ct::_Vertices& vertices, int first, int last, std::vector<int>& indices) const
+    {
+        int previous = first;
+        for (int i = first + 1; i < last; i++)
+        {
+            if ((vertices[i + 1].vertex - vertices[previous].vertex).length() > _max_gap)
+            {
+                indices.push_back(i);
+                previous = i;
+            }
+        }
+    }
+};
+
+#endif //B_SPLINE_CURVEDECIMATION_H
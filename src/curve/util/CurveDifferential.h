@@ -0,0 +1,291 @@
+//
+// Created by haochuanchen on 18-6-6.
+//
+
+#ifndef B_SPLINE_CURVEDIFFERENTIAL_H
+#define B_SPLINE_CURVEDIFFERENTIAL_H
+
+#include <cmath>
+#include <vector>
+
+#include "AlignedAllocator.h"
+#include "BSplineEvaluator.h"
+#include "Parallel.h"
+
+/**
+ * Differential geometry of a B spline curve at batches of parameters: curvature, torsion, Frenet frames and
+ * rotation minimizing frames. Derivatives up to order 3 are evaluated exactly by the basis function derivatives, in
+ * parallel across the samples, and the results are written as structures of arrays.
+ *
+ * Rotation minimizing frames are propagated by the double reflection method of Wang et al., *Computation of Rotation
+ * Minimizing Frames*, 2008; the points and tangents are evaluated in parallel, the cheap propagation is sequential.
+ *
+ * The control points and the knot vector are referenced, not copied.
+ * @tparam _DataType data type of the coordinate, default double
+ */
+template <typename _DataType = double>
+class CurveDifferential
+{
+public:
+    using _Dt = _DataType;
+    using _Vt = Vector3X<_Dt>;
+    using _Evaluator = BSplineEvaluator<_Dt>;
+
+    template <typename _Type>
+    using _Array = std::vector<_Type, AlignedAllocator<_Type>>;
+
+    /// Vectors stored as a structure of arrays.
+    struct VectorArray
+    {
+        _Array<_Dt> x;
+        _Array<_Dt> y;
+        _Array<_Dt> z;
+
+        void resize(size_t n)
+        {
+            x.resize(n);
+            y.resize(n);
+            z.resize(n);
+        }
+
+        size_t size() const
+        {
+            return x.size();
+        }
+
+        _Vt operator[](size_t i) const
+        {
+            return _Vt(x[i], y[i], z[i]);
+        }
+
+        void set(size_t i, const _Vt& v)
+        {
+            x[i] = v.x;
+            y[i] = v.y;
+            z[i] = v.z;
+        }
+    };
+
+    /// Curvature and torsion at the samples.
+    struct Profile
+    {
+        _Array<_Dt> u;
+        _Array<_Dt> curvature;
+        /// 0 where the curvature is 0
+        _Array<_Dt> torsion;
+    };
+
+    /// Orthonormal frames at the samples.
+    struct Frames
+    {
+        _Array<_Dt> u;
+        VectorArray point;
+        VectorArray tangent;
+        VectorArray normal;
+        VectorArray binormal;
+    };
+
+private:
+    int _degree;
+    const std::vector<_Vt>& _ctrlpts;
+    const std::vector<_Dt>& _knots;
+
+    /// minimum number of samples evaluated by a thread
+    static constexpr long _min_grain = 1024;
+
+public:
+    /**
+     * Create the differential geometry of a B spline curve.
+     * @param degree degree(order - 1) of the B spline
+     * @param control_points control points of the B spline
+     * @param knots knot vector of the B spline
+     */
+    CurveDifferential(int degree, const std::vector<_Vt>& control_points, const std::vector<_Dt>& knots)
+        : _degree(degree), _ctrlpts(control_points), _knots(knots)
+    {
+    }
+
+    /**
+     * Create the differential geometry of a B spline curve, such as `BSplineCurve`.
+     * @param curve the curve, must outlive this
+     */
+    template <typename _Curve>
+    explicit CurveDifferential(const _Curve& curve)
+        : CurveDifferential(curve.get_degree(), curve.get_control_points(), curve.get_knot_vector())
+    {
+    }
+
+    /**
+     * Compute the curvature |C' x C''| / |C'|^3 and the torsion (C' x C'') . C''' / |C' x C''|^2 at the parameters.
+     * @param parameters the parameters
+     * @return the profile
+     */
+    Profile curvature_profile(const std::vector<_Dt>& parameters) const
+    {
+        long n = long(parameters.size());
+        Profile profile;
+        profile.u.assign(parameters.begin(), parameters.end());
+        profile.curvature.resize(n);
+        profile.torsion.resize(n);
+
+        parallel_for(0, n, [&](long first, long last)
+        {
+            _Evaluator evaluator(_degree, _ctrlpts, _knots, 3);
+            _Vt ders[4];
+            for (long i = first; i < last; i++)
+            {
+                evaluator.derivatives(parameters[i], 3, ders);
+                _Vt cross = ders[1].cross(ders[2]);
+                _Dt speed = ders[1].length();
+                _Dt squared_cross = cross.squared_length();
+
+                profile.curvature[i] = speed > 0 ? std::sqrt(squared_cross) / (speed * speed * speed) : _Dt(0.0);
+                profile.torsion[i] = squared_cross > 0 ? cross.dot(ders[3]) / squared_cross : _Dt(0.0);
+            }
+        }, _min_grain);
+
+        return profile;
+    }
+
+    /**
+     * Compute the Frenet frames at the parameters: the tangent C' / |C'|, the binormal C' x C'' / |C' x C''| and the
+     * normal binormal x tangent. Where the curvature is 0 the normal is any one perpendicular to the tangent.
+     * @param parameters the parameters
+     * @return the frames
+     */
+    Frames frenet_frames(const std::vector<_Dt>& parameters) const
+    {
+        long n = long(parameters.size());
+        Frames frames = _allocate(parameters);
+
+        parallel_for(0, n, [&](long first, long last)
+        {
+            _Evaluator evaluator(_degree, _ctrlpts, _knots, 2);
+            _Vt ders[3];
+            for (long i = first; i < last; i++)
+            {
+                evaluator.derivatives(parameters[i], 2, ders);
+                _Vt tangent = _normalized(ders[1]);
+                _Vt binormal = ders[1].cross(ders[2]);
+                _Dt length = binormal.length();
+                _Vt normal = length > 0 ? binormal.cross(ders[1]) / (length * ders[1].length())
+                                        : _perpendicular(tangent);
+
+                frames.point.set(i, ders[0]);
+                frames.tangent.set(i, tangent);
+                frames.normal.set(i, normal);
+                frames.binormal.set(i, tangent.cross(normal));
+            }
+        }, _min_grain);
+
+        return frames;
+    }
+
+    /**
+     * Compute the rotation minimizing frames at the parameters by double reflection, starting from the Frenet
+     * normal at the first parameter. The frames rotate as little as possible about the tangent, so they do not flip
+     * at inflections as Frenet frames do. Dense parameters give accurate frames.
+     * @param parameters the parameters, ascending
+     * @return the frames
+     */
+    Frames rotation_minimizing_frames(const std::vector<_Dt>& parameters) const
+    {
+        if (parameters.empty())
+        {
+            return Frames();
+        }
+        auto first = frenet_frames(std::vector<_Dt>(1, parameters.front()));
+        return rotation_minimizing_frames(parameters, first.normal[0]);
+    }
+
+    /**
+     * Compute the rotation minimizing frames at the parameters by double reflection.
+     * @param parameters the parameters, ascending
+     * @param initial_normal normal of the first frame, projected to be perpendicular to the tangent
+     * @return the frames
+     */
+    Frames rotation_minimizing_frames(const std::vector<_Dt>& parameters, const _Vt& initial_normal) const
+    {
+        long n = long(parameters.size());
+        Frames frames = _allocate(parameters);
+        if (n == 0)
+        {
+            return frames;
+        }
+
+        // points and tangents in parallel
+        parallel_for(0, n, [&](long first, long last)
+        {
+            _Evaluator evaluator(_degree, _ctrlpts, _knots, 1);
+            _Vt ders[2];
+            for (long i = first; i < last; i++)
+            {
+                evaluator.derivatives(parameters[i], 1, ders);
+                frames.point.set(i, ders[0]);
+                frames.tangent.set(i, _normalized(ders[1]));
+            }
+        }, _min_grain);
+
+        _Vt t = frames.tangent[0];
+        _Vt r = initial_normal - t * t.dot(initial_normal);
+        r = r.length() > 0 ? _normalized(r) : _perpendicular(t);
+        frames.normal.set(0, r);
+        frames.binormal.set(0, t.cross(r));
+
+        for (long i = 0; i + 1 < n; i++)
+        {
+            _Vt t0 = frames.tangent[i], t1 = frames.tangent[i + 1];
+
+            // reflect by the bisector plane of the two points, then by the one mapping the reflected tangent to t1
+            _Vt v1 = frames.point[i + 1] - frames.point[i];
+            _Dt c1 = v1.dot(v1);
+            _Vt r_l = r, t_l = t0;
+            if (c1 > 0)
+            {
+                r_l = r - v1 * (2 / c1 * v1.dot(r));
+                t_l = t0 - v1 * (2 / c1 * v1.dot(t0));
+            }
+
+            _Vt v2 = t1 - t_l;
+            _Dt c2 = v2.dot(v2);
+            r = c2 > 0 ? r_l - v2 * (2 / c2 * v2.dot(r_l)) : r_l;
+
+            // keep it orthonormal against rounding
+            r = _normalized(r - t1 * t1.dot(r));
+            frames.normal.set(i + 1, r);
+            frames.binormal.set(i + 1, t1.cross(r));
+        }
+
+        return frames;
+    }
+
+private:
+    static Frames _allocate(const std::vector<_Dt>& parameters)
+    {
+        Frames frames;
+        frames.u.assign(parameters.begin(), parameters.end());
+        frames.point.resize(parameters.size());
+        frames.tangent.resize(parameters.size());
+        frames.normal.resize(parameters.size());
+        frames.binormal.resize(parameters.size());
+        return frames;
+    }
+
+    static _Vt _normalized(const _Vt& v)
+    {
+        _Dt length = v.length();
+        return length > 0 ? v / length : v;
+    }
+
+    /// A unit vector perpendicular to `v`, or the x axis if `v` is zero.
+    static _Vt _perpendicular(const _Vt& v)
+    {
+        // cross with the axis least aligned with v
+        _Vt axis = std::abs(v.x) <= std::abs(v.y) && std::abs(v.x) <= std::abs(v.z) ? _Vt(1, 0, 0)
+                 : std::abs(v.y) <= std::abs(v.z) ? _Vt(0, 1, 0) : _Vt(0, 0, 1);
+        _Vt p = v.cross(axis);
+        return p.length() > 0 ? _normalized(p) : _Vt(1, 0, 0);
+    }
+};
+
+#endif //B_SPLINE_CURVEDIFFERENTIAL_H
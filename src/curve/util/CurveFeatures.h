@@ -0,0 +1,201 @@
+//
+// Created by haochuanchen on 18-6-7.
+//
+
+#ifndef B_SPLINE_CURVEFEATURES_H
+#define B_SPLINE_CURVEFEATURES_H
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "../ParaCurve.h"
+#include "Parallel.h"
+
+/**
+ * Geometric features of the polyline through the vertices of a parameterized curve: segment lengths, turning angles,
+ * discrete curvature, corners and inflections, and the cumulative feature measure (share of arc length plus share of
+ * turning angle) that spends samples, knots or breakpoints on the features instead of following the vertex density.
+ *
+ * The per-vertex values only read the neighbouring vertices, so they are computed in one pass without dependency
+ * between iterations, in parallel for long curves; the totals, the prefix sums and the feature lists follow in a
+ * serial pass over the arrays.
+ * @tparam _Curve parameterized curve type
+ */
+template <typename _Curve>
+class CurveFeatures
+{
+public:
+    using _Ct = _Curve;
+    using _Pt = typename _Ct::_Pt;
+    using _Dt = typename _Pt::_Dt;
+
+    static_assert(std::is_base_of<ParaCurve<_Pt, typename _Ct::_Storage>, _Ct>::value);
+
+    /// Features of a curve. Segment k joins vertex k - 1 and vertex k.
+    struct Features
+    {
+        /// length of segment k, 0 at k = 0
+        std::vector<_Dt> length;
+        /// turning angle at vertex k in [0, pi], 0 at both end points
+        std::vector<_Dt> angle;
+        /// discrete curvature at vertex k, turning angle over the mean length of the adjacent segments
+        std::vector<_Dt> curvature;
+        /// cumulative feature measure up to vertex k, from 0 to 2 (1 if the polyline is straight)
+        std::vector<_Dt> measure;
+        /// ascending indices of the corner vertices
+        std::vector<int> corners;
+        /// ascending indices k of the inflections, the curve turns the other way between vertex k and k + 1
+        std::vector<int> inflections;
+
+        _Dt total_length = 0;
+        _Dt total_angle = 0;
+
+        /// Number of vertices.
+        int size() const
+        {
+            return int(length.size());
+        }
+
+        /**
+         * Select vertices evenly distributed in the feature measure, for knot placement or adaptive sampling.
+         * @param count the number of vertices to select, no less than 2
+         * @return ascending distinct indices of the vertices, including both end points, no more than the vertices
+         */
+        std::vector<int> distribute(int count) const
+        {
+            int m = size() - 1;
+            std::vector<int> selected;
+            if (m < 0)
+            {
+                return selected;
+            }
+
+            selected.push_back(0);
+            for (int i = 1; i < count - 1; i++)
+            {
+                _Dt target = measure[m] * i / (count - 1);
+                int k = int(std::lower_bound(measure.begin(), measure.end(), target) - measure.begin());
+                k = std::min(std::max(k, selected.back() + 1), m);
+                if (k < m)
+                {
+                    selected.push_back(k);
+                }
+            }
+            if (m > 0)
+            {
+                selected.push_back(m);
+            }
+            return selected;
+        }
+    };
+
+private:
+    /// minimum turning angle of a corner, besides being above the mean
+    _Dt _corner_angle;
+
+    /// minimum turning angle on both sides of an inflection, below it the sign of turning is noise
+    _Dt _inflection_angle;
+
+    /// minimum number of vertices of a chunk processed by a thread
+    static constexpr long _min_grain = 1 << 16;
+
+public:
+    /**
+     * Create a feature extractor.
+     * A corner is a local maximum of the turning angle greater than both `corner_angle` and the mean turning angle.
+     * An inflection is where the turning direction reverses between two vertices turning by at least
+     * `inflection_angle`.
+     * @param corner_angle minimum turning angle of a corner, in radians
+     * @param inflection_angle minimum turning angle on both sides of an inflection, in radians
+     */
+    explicit CurveFeatures(_Dt corner_angle = _Dt(0.0), _Dt inflection_angle = _Dt(1e-6))
+        : _corner_angle(corner_angle), _inflection_angle(inflection_angle)
+    {
+    }
+
+    /**
+     * Extract the features of a curve.
+     * @param curve the curve
+     * @return the features
+     */
+    Features extract(const _Ct& curve) const
+    {
+        const auto& vertices = curve.get_vertices();
+        long num_v = long(vertices.size());
+
+        Features features;
+        features.length.assign(num_v, _Dt(0.0));
+        features.angle.assign(num_v, _Dt(0.0));
+        features.curvature.assign(num_v, _Dt(0.0));
+        features.measure.assign(num_v, _Dt(0.0));
+        if (num_v == 0)
+        {
+            return features;
+        }
+
+        // reversal of the turning direction between vertex k and k + 1, by the binormals of both
+        std::vector<char> reversed(num_v, 0);
+
+        parallel_for(0, num_v, [&](long first, long last)
+        {
+            for (long k = std::max(first, 1L); k < last; k++)
+            {
+                auto a = vertices[k].vertex - vertices[k - 1].vertex;
+                features.length[k] = a.length();
+                if (k + 1 >= num_v)
+                {
+                    continue;
+                }
+
+                auto b = vertices[k + 1].vertex - vertices[k].vertex;
+                auto binormal = a.cross(b);
+                _Dt angle = std::atan2(binormal.length(), a.dot(b));
+                _Dt mean_length = (a.length() + b.length()) / 2;
+                features.angle[k] = angle;
+                features.curvature[k] = mean_length > 0 ? angle / mean_length : _Dt(0.0);
+
+                if (k + 2 >= num_v || angle < _inflection_angle)
+                {
+                    continue;
+                }
+                auto c = vertices[k + 2].vertex - vertices[k + 1].vertex;
+                auto next_binormal = b.cross(c);
+                reversed[k] = std::atan2(next_binormal.length(), b.dot(c)) >= _inflection_angle &&
+                              binormal.dot(next_binormal) < 0;
+            }
+        }, _min_grain);
+
+        for (long k = 1; k < num_v; k++)
+        {
+            features.total_length += features.length[k];
+            features.total_angle += features.angle[k];
+        }
+
+        _Dt total_length = features.total_length > 0 ? features.total_length : _Dt(1.0);
+        _Dt total_angle = features.total_angle > 0 ? features.total_angle : _Dt(1.0);
+        const auto& angle = features.angle;
+        for (long k = 1; k < num_v; k++)
+        {
+            _Dt turning = (angle[k - 1] + angle[k]) / 2;
+            features.measure[k] = features.measure[k - 1] + features.length[k] / total_length + turning / total_angle;
+        }
+
+        _Dt min_corner = std::max(_corner_angle, features.total_angle / std::max(1L, num_v - 2));
+        for (long k = 1; k + 1 < num_v; k++)
+        {
+            if (angle[k] > min_corner && angle[k] >= angle[k - 1] && angle[k] > angle[k + 1])
+            {
+                features.corners.push_back(int(k));
+            }
+            if (reversed[k])
+            {
+                features.inflections.push_back(int(k));
+            }
+        }
+
+        return features;
+    }
+};
+
+#endif //B_SPLINE_CURVEFEATURES_H
@@ -0,0 +1,555 @@
+//
+// Created by haochuanchen on 18-5-31.
+//
+
+#ifndef B_SPLINE_CURVEINDEX_H
+#define B_SPLINE_CURVEINDEX_H
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "CurveProjector.h"
+#include "Parallel.h"
+
+/**
+ * Spatial index over many B spline curves, for nearest curve, radius and box queries.
+ * The bound boxes of the control points of every knot span (see `CurveProjector`) are put into a hashed uniform grid,
+ * so curves are inserted and removed incrementally. Candidate curves found in the grid are projected by their
+ * `CurveProjector`, so the distances are exact, not the distances to the tessellation.
+ *
+ * Boxes covering more than `_max_cell_per_box` cells are kept in a list checked by every query, so a few huge spans
+ * do not flood the grid. Choose the cell size around the typical span size.
+ *
+ * The curves are copied. Queries are const and may run concurrently, but not with `insert` or `remove`.
+ * @tparam _DataType data type of the coordinate, default double
+ */
+template <typename _DataType = double>
+class CurveIndex
+{
+public:
+    using _Dt = _DataType;
+    using _Vt = Vector3X<_Dt>;
+    using _Projector = CurveProjector<_Dt>;
+
+    /// A curve found by a point query.
+    struct Hit
+    {
+        /// id of the curve, -1 if none is found
+        int id;
+        /// parameter of the closest point on the curve
+        _Dt u;
+        /// the closest point
+        _Vt point;
+        /// distance between the query point and the curve
+        _Dt distance;
+    };
+
+private:
+    /// A curve in the index.
+    struct _Entry
+    {
+        int degree;
+        std::vector<_Vt> ctrlpts;
+        std::vector<_Dt> knots;
+        std::unique_ptr<_Projector> projector;
+        std::vector<std::pair<int, BoundBox<_Dt>>> boxes;
+    };
+
+    /// A knot span of a curve in a cell.
+    struct _SpanRef
+    {
+        int id;
+        BoundBox<_Dt> box;
+    };
+
+    struct _Cell
+    {
+        long x;
+        long y;
+        long z;
+
+        bool operator==(const _Cell& rhs) const
+        {
+            return x == rhs.x && y == rhs.y && z == rhs.z;
+        }
+    };
+
+    struct _CellHash
+    {
+        size_t operator()(const _Cell& cell) const
+        {
+            return size_t(cell.x) * 73856093u ^ size_t(cell.y) * 19349663u ^ size_t(cell.z) * 83492791u;
+        }
+    };
+
+    _Dt _cell_size;
+
+    std::unordered_map<int, std::unique_ptr<_Entry>> _entries;
+    int _next_id = 0;
+
+    std::unordered_map<_Cell, std::vector<_SpanRef>, _CellHash> _grid;
+    /// spans too large for the grid
+    std::vector<_SpanRef> _large;
+
+    /// range of the occupied cells, to stop the nearest search, not shrunk by `remove`
+    _Cell _cell_min{0, 0, 0};
+    _Cell _cell_max{-1, -1, -1};
+
+    /// boxes covering more cells go to `_large`
+    static constexpr long _max_cell_per_box = 64;
+
+    /// minimum number of queries run by a thread
+    static constexpr long _min_grain = 64;
+
+public:
+    /**
+     * Create an empty index.
+     * @param cell_size edge length of the grid cells
+     */
+    explicit CurveIndex(_Dt cell_size)
+        : _cell_size(cell_size)
+    {
+        if (!(cell_size > 0))
+        {
+            throw std::invalid_argument("cell size must be greater than zero.");
+        }
+    }
+
+    CurveIndex(const CurveIndex&) = delete;
+    CurveIndex& operator=(const CurveIndex&) = delete;
+
+public: // modification
+
+    /**
+     * Insert a B spline curve, copied.
+     * @param degree degree(order - 1) of the B spline
+     * @param control_points control points of the B spline
+     * @param knots knot vector of the B spline
+     * @return id of the curve
+     */
+    int insert(int degree, const std::vector<_Vt>& control_points, const std::vector<_Dt>& knots)
+    {
+        auto entry = std::make_unique<_Entry>();
+        entry->degree = degree;
+        entry->ctrlpts = control_points;
+        entry->knots = knots;
+        entry->projector = std::make_unique<_Projector>(degree, entry->ctrlpts, entry->knots);
+        entry->boxes = entry->projector->span_bound_boxes();
+
+        int id = _next_id++;
+        for (const auto& span_box : entry->boxes)
+        {
+            _add(_SpanRef{id, span_box.second});
+        }
+        _entries.emplace(id, std::move(entry));
+        return id;
+    }
+
+    /**
+     * Insert a B spline curve, such as `BSplineCurve`, copied.
+     * @param curve the curve
+     * @return id of the curve
+     */
+    template <typename _Curve>
+    int insert(const _Curve& curve)
+    {
+        return insert(curve.get_degree(), curve.get_control_points(), curve.get_knot_vector());
+    }
+
+    /**
+     * Remove a curve.
+     * @param id id of the curve
+     * @return false if there is no such curve
+     */
+    bool remove(int id)
+    {
+        auto it = _entries.find(id);
+        if (it == _entries.end())
+        {
+            return false;
+        }
+
+        auto is_removed = [id](const _SpanRef& ref)
+        {
+            return ref.id == id;
+        };
+
+        for (const auto& span_box : it->second->boxes)
+        {
+            const auto& box = span_box.second;
+            if (_is_large(box))
+            {
+                continue;
+            }
+            _for_each_cell(box, [&](const _Cell& cell)
+            {
+                auto found = _grid.find(cell);
+                if (found == _grid.end())
+                {
+                    return;
+                }
+                auto& refs = found->second;
+                refs.erase(std::remove_if(refs.begin(), refs.end(), is_removed), refs.end());
+                if (refs.empty())
+                {
+                    _grid.erase(found);
+                }
+            });
+        }
+        _large.erase(std::remove_if(_large.begin(), _large.end(), is_removed), _large.end());
+
+        _entries.erase(it);
+        return true;
+    }
+
+    /// Number of curves in the index.
+    size_t size() const
+    {
+        return _entries.size();
+    }
+
+public: // queries
+
+    /**
+     * Find the curve nearest to a point.
+     * @param point the point
+     * @param max_distance curves farther are ignored
+     * @return the nearest curve, its id is -1 if there is none within `max_distance`
+     */
+    Hit nearest(const _Vt& point, _Dt max_distance = std::numeric_limits<_Dt>::max()) const
+    {
+        Hit best{-1, _Dt(0.0), _Vt(), max_distance};
+        std::unordered_set<int> projected;
+
+        auto visit = [&](const _SpanRef& ref)
+        {
+            if (_squared_distance(ref.box, point) > best.distance * best.distance || projected.count(ref.id))
+            {
+                return;
+            }
+            projected.insert(ref.id);
+            auto hit = _project(ref.id, point);
+            if (hit.distance <= best.distance)
+            {
+                best = hit;
+            }
+        };
+
+        for (const auto& ref : _large)
+        {
+            visit(ref);
+        }
+
+        // shells of cells around the cell of the point, from the first one reaching the occupied cells, until no
+        // unvisited cell can be nearer
+        _Cell center = _cell_of(point);
+        long r_first = std::max({_cell_min.x - center.x, center.x - _cell_max.x, _cell_min.y - center.y,
+                                 center.y - _cell_max.y, _cell_min.z - center.z, center.z - _cell_max.z, 0L});
+        long r_last = std::max({std::abs(center.x - _cell_min.x), std::abs(center.x - _cell_max.x),
+                                std::abs(center.y - _cell_min.y), std::abs(center.y - _cell_max.y),
+                                std::abs(center.z - _cell_min.z), std::abs(center.z - _cell_max.z)});
+        if (_grid.empty())
+        {
+            r_last = -1;
+        }
+
+        for (long r = r_first; r <= r_last; r++)
+        {
+            if (r > 0 && _cell_size * (r - 1) > best.distance)
+            {
+                break;
+            }
+            if (double(r) * double(r) * 24 > double(_grid.size()))
+            {
+                // more cells in the shell than occupied ones: scan the grid instead
+                for (const auto& cell : _grid)
+                {
+                    for (const auto& ref : cell.second)
+                    {
+                        visit(ref);
+                    }
+                }
+                break;
+            }
+            _for_each_shell_cell(center, r, [&](const _Cell& cell)
+            {
+                auto found = _grid.find(cell);
+                if (found == _grid.end())
+                {
+                    return;
+                }
+                for (const auto& ref : found->second)
+                {
+                    visit(ref);
+                }
+            });
+        }
+
+        return best;
+    }
+
+    /**
+     * Find the nearest curves of points, in parallel.
+     * @param points the points
+     * @param max_distance curves farther are ignored
+     * @return the nearest curve of each point
+     */
+    std::vector<Hit> nearest(const std::vector<_Vt>& points, _Dt max_distance = std::numeric_limits<_Dt>::max()) const
+    {
+        std::vector<Hit> hits(points.size());
+        parallel_for(0, long(points.size()), [&](long first, long last)
+        {
+            for (long i = first; i < last; i++)
+            {
+                hits[i] = nearest(points[i], max_distance);
+            }
+        }, _min_grain);
+        return hits;
+    }
+
+    /**
+     * Find the curves within a distance of a point.
+     * @param point the point
+     * @param radius the distance
+     * @return the curves, nearest first
+     */
+    std::vector<Hit> within(const _Vt& point, _Dt radius) const
+    {
+        BoundBox<_Dt> range{point.x - radius, point.x + radius, point.y - radius, point.y + radius,
+                            point.z - radius, point.z + radius};
+
+        std::vector<Hit> hits;
+        for (int id : _candidates(range))
+        {
+            auto hit = _project(id, point);
+            if (hit.distance <= radius)
+            {
+                hits.push_back(hit);
+            }
+        }
+
+        std::sort(hits.begin(), hits.end(), [](const Hit& a, const Hit& b)
+        {
+            return a.distance < b.distance;
+        });
+        return hits;
+    }
+
+    /**
+     * Find the curves within a distance of points, in parallel.
+     * @param points the points
+     * @param radius the distance
+     * @return the curves of each point, nearest first
+     */
+    std::vector<std::vector<Hit>> within(const std::vector<_Vt>& points, _Dt radius) const
+    {
+        std::vector<std::vector<Hit>> hits(points.size());
+        parallel_for(0, long(points.size()), [&](long first, long last)
+        {
+            for (long i = first; i < last; i++)
+            {
+                hits[i] = within(points[i], radius);
+            }
+        }, _min_grain);
+        return hits;
+    }
+
+    /**
+     * Find the curves that may intersect a box: some knot span has control points bounded by a box overlapping it.
+     * The result is conservative, by the convex hull property it contains every curve intersecting the box.
+     * @param box the box
+     * @return ids of the curves, ascending
+     */
+    std::vector<int> overlapping(const BoundBox<_Dt>& box) const
+    {
+        return _candidates(box);
+    }
+
+    /**
+     * Find the curves that may intersect boxes, in parallel. See `overlapping`.
+     * @param boxes the boxes
+     * @return ids of the curves of each box, ascending
+     */
+    std::vector<std::vector<int>> overlapping(const std::vector<BoundBox<_Dt>>& boxes) const
+    {
+        std::vector<std::vector<int>> ids(boxes.size());
+        parallel_for(0, long(boxes.size()), [&](long first, long last)
+        {
+            for (long i = first; i < last; i++)
+            {
+                ids[i] = _candidates(boxes[i]);
+            }
+        }, _min_grain);
+        return ids;
+    }
+
+private:
+    /// Project a point onto a curve.
+    Hit _project(int id, const _Vt& point) const
+    {
+        const auto& entry = *_entries.at(id);
+        BSplineEvaluator<_Dt> evaluator(entry.degree, entry.ctrlpts, entry.knots, 2);
+        auto projection = entry.projector->project(point, evaluator);
+        return Hit{id, projection.u, projection.point, projection.distance};
+    }
+
+    /// Ids of the curves with a span box overlapping a box, ascending.
+    std::vector<int> _candidates(const BoundBox<_Dt>& box) const
+    {
+        std::vector<int> ids;
+        auto visit = [&](const _SpanRef& ref)
+        {
+            if (_is_overlapping(ref.box, box))
+            {
+                ids.push_back(ref.id);
+            }
+        };
+
+        for (const auto& ref : _large)
+        {
+            visit(ref);
+        }
+
+        // clamp to the occupied cells, the query box may be huge
+        _Cell low = _cell_of(_Vt(box.x_min, box.y_min, box.z_min));
+        _Cell high = _cell_of(_Vt(box.x_max, box.y_max, box.z_max));
+        low = _Cell{std::max(low.x, _cell_min.x), std::max(low.y, _cell_min.y), std::max(low.z, _cell_min.z)};
+        high = _Cell{std::min(high.x, _cell_max.x), std::min(high.y, _cell_max.y), std::min(high.z, _cell_max.z)};
+
+        if (double(high.x - low.x + 1) * double(high.y - low.y + 1) * double(high.z - low.z + 1) > _grid.size())
+        {
+            // more cells than occupied ones: scan the grid instead
+            for (const auto& cell : _grid)
+            {
+                for (const auto& ref : cell.second)
+                {
+                    visit(ref);
+                }
+            }
+        }
+        else
+        {
+            for (long x = low.x; x <= high.x; x++)
+            {
+                for (long y = low.y; y <= high.y; y++)
+                {
+                    for (long z = low.z; z <= high.z; z++)
+                    {
+                        auto found = _grid.find(_Cell{x, y, z});
+                        if (found == _grid.end())
+                        {
+                            continue;
+                        }
+                        for (const auto& ref : found->second)
+                        {
+                            visit(ref);
+                        }
+                    }
+                }
+            }
+        }
+
+        std::sort(ids.begin(), ids.end());
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+        return ids;
+    }
+
+    /// Put a span into the grid, or the large list.
+    void _add(const _SpanRef& ref)
+    {
+        if (_is_large(ref.box))
+        {
+            _large.push_back(ref);
+            return;
+        }
+
+        _for_each_cell(ref.box, [&](const _Cell& cell)
+        {
+            _grid[cell].push_back(ref);
+        });
+
+        _Cell low = _cell_of(_Vt(ref.box.x_min, ref.box.y_min, ref.box.z_min));
+        _Cell high = _cell_of(_Vt(ref.box.x_max, ref.box.y_max, ref.box.z_max));
+        if (_cell_min.x > _cell_max.x)
+        {
+            _cell_min = low;
+            _cell_max = high;
+            return;
+        }
+        _cell_min = _Cell{std::min(_cell_min.x, low.x), std::min(_cell_min.y, low.y), std::min(_cell_min.z, low.z)};
+        _cell_max = _Cell{std::max(_cell_max.x, high.x), std::max(_cell_max.y, high.y), std::max(_cell_max.z, high.z)};
+    }
+
+    _Cell _cell_of(const _Vt& p) const
+    {
+        return _Cell{long(std::floor(p.x / _cell_size)), long(std::floor(p.y / _cell_size)),
+                     long(std::floor(p.z / _cell_size))};
+    }
+
+    bool _is_large(const BoundBox<_Dt>& box) const
+    {
+        _Cell low = _cell_of(_Vt(box.x_min, box.y_min, box.z_min));
+        _Cell high = _cell_of(_Vt(box.x_max, box.y_max, box.z_max));
+        return double(high.x - low.x + 1) * double(high.y - low.y + 1) * double(high.z - low.z + 1) > _max_cell_per_box;
+    }
+
+    /// Call `func(cell)` for the cells overlapping a box.
+    template <typename _Func>
+    void _for_each_cell(const BoundBox<_Dt>& box, _Func&& func) const
+    {
+        _Cell low = _cell_of(_Vt(box.x_min, box.y_min, box.z_min));
+        _Cell high = _cell_of(_Vt(box.x_max, box.y_max, box.z_max));
+        for (long x = low.x; x <= high.x; x++)
+        {
+            for (long y = low.y; y <= high.y; y++)
+            {
+                for (long z = low.z; z <= high.z; z++)
+                {
+                    func(_Cell{x, y, z});
+                }
+            }
+        }
+    }
+
+    /// Call `func(cell)` for the cells at Chebyshev distance r from a cell.
+    template <typename _Func>
+    static void _for_each_shell_cell(const _Cell& center, long r, _Func&& func)
+    {
+        for (long x = -r; x <= r; x++)
+        {
+            for (long y = -r; y <= r; y++)
+            {
+                bool is_face = std::abs(x) == r || std::abs(y) == r;
+                long step = is_face ? 1 : 2 * r;
+                for (long z = -r; z <= r; z += std::max(step, 1L))
+                {
+                    func(_Cell{center.x + x, center.y + y, center.z + z});
+                }
+            }
+        }
+    }
+
+    static bool _is_overlapping(const BoundBox<_Dt>& a, const BoundBox<_Dt>& b)
+    {
+        return a.x_min <= b.x_max && b.x_min <= a.x_max &&
+               a.y_min <= b.y_max && b.y_min <= a.y_max &&
+               a.z_min <= b.z_max && b.z_min <= a.z_max;
+    }
+
+    /// Squared distance between a point and a box, 0 inside.
+    static _Dt _squared_distance(const BoundBox<_Dt>& box, const _Vt& p)
+    {
+        _Dt dx = std::max({box.x_min - p.x, _Dt(0.0), p.x - box.x_max});
+        _Dt dy = std::max({box.y_min - p.y, _Dt(0.0), p.y - box.y_max});
+        _Dt dz = std::max({box.z_min - p.z, _Dt(0.0), p.z - box.z_max});
+        return dx * dx + dy * dy + dz * dz;
+    }
+};
+
+#endif //B_SPLINE_CURVEINDEX_H
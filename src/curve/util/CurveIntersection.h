@@ -0,0 +1,650 @@
+//
+// Created by haochuanchen on 18-6-2.
+//
+
+#ifndef B_SPLINE_CURVEINTERSECTION_H
+#define B_SPLINE_CURVEINTERSECTION_H
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "../base_type/BoundBox.h"
+#include "BSplineEvaluator.h"
+#include "Parallel.h"
+
+/**
+ * Intersection of B spline curves with each other and with planes.
+ * The curves are decomposed into Bezier segments (see `BSplineCurve::decompose_to_bezier`). Pairs of segments whose
+ * bound boxes are apart are culled; curve-curve intersections are found by subdividing the segments until both are
+ * flat, curve-plane intersections by Bezier clipping of the signed distance. The intersections are then polished by
+ * Newton iteration on the curves.
+ *
+ * Curves closer than the tolerance are reported as intersecting. Where flat pieces of the curves lie on each other,
+ * the end points of the overlap are reported rather than an interval; overlapping curved pieces give a series of
+ * such end points.
+ * @tparam _DataType data type of the coordinate, default double
+ */
+template <typename _DataType = double>
+class CurveIntersection
+{
+public:
+    using _Dt = _DataType;
+    using _Vt = Vector3X<_Dt>;
+
+    /// A plane through `point` with normal `normal`.
+    struct Plane
+    {
+        _Vt point;
+        _Vt normal;
+    };
+
+    /// Intersection of two curves.
+    struct CurveHit
+    {
+        /// parameter on the first curve
+        _Dt u;
+        /// parameter on the second curve
+        _Dt v;
+        /// the intersection point
+        _Vt point;
+    };
+
+    /// Intersection of a curve and a plane.
+    struct PlaneHit
+    {
+        /// parameter on the curve
+        _Dt u;
+        /// the intersection point
+        _Vt point;
+    };
+
+private:
+    /// Bezier segments of a curve.
+    struct _Bezier
+    {
+        int degree = 0;
+        const std::vector<_Vt>* ctrlpts = nullptr;
+        const std::vector<_Dt>* knots = nullptr;
+        std::vector<std::vector<_Vt>> segments;
+        std::vector<_Dt> breakpoints;
+        std::vector<BoundBox<_Dt>> boxes;
+    };
+
+    /// A piece of a Bezier segment over [t0, t1] of the curve parameter.
+    template <typename _Type>
+    struct _Piece
+    {
+        std::vector<_Type> points;
+        _Dt t0;
+        _Dt t1;
+    };
+
+    /// distance tolerance
+    _Dt _tolerance;
+
+    /// max depth of subdivision
+    static constexpr int _max_depth = 64;
+
+    /// minimum number of pairs intersected by a thread
+    static constexpr long _min_grain = 8;
+
+public:
+    /**
+     * Create an intersector.
+     * @param tolerance distance tolerance of the intersection points
+     */
+    explicit CurveIntersection(_Dt tolerance = _Dt(1e-9))
+        : _tolerance(tolerance)
+    {
+        if (!(tolerance > 0))
+        {
+            throw std::invalid_argument("tolerance must be greater than zero.");
+        }
+    }
+
+    /**
+     * Intersect two curves, such as `BSplineCurve`s.
+     * @param a the first curve
+     * @param b the second curve
+     * @return the intersections, ordered by the parameter on the first curve
+     */
+    template <typename _Curve>
+    std::vector<CurveHit> intersect(const _Curve& a, const _Curve& b) const
+    {
+        return _intersect(_decompose(a), _decompose(b));
+    }
+
+    /**
+     * Intersect a curve, such as `BSplineCurve`, and a plane.
+     * @param curve the curve
+     * @param plane the plane
+     * @return the intersections, ordered by the parameter
+     */
+    template <typename _Curve>
+    std::vector<PlaneHit> intersect(const _Curve& curve, const Plane& plane) const
+    {
+        return _intersect(_decompose(curve), _normalized(plane));
+    }
+
+    /**
+     * Intersect pairs of curves, in parallel.
+     * @param curves the curves
+     * @param pairs indices of the pairs of curves
+     * @return the intersections of each pair
+     */
+    template <typename _Curve>
+    std::vector<std::vector<CurveHit>> intersect(const std::vector<const _Curve*>& curves,
+                                                 const std::vector<std::pair<int, int>>& pairs) const
+    {
+        auto beziers = _decompose_all(curves);
+
+        std::vector<std::vector<CurveHit>> hits(pairs.size());
+        parallel_for(0, long(pairs.size()), [&](long first, long last)
+        {
+            for (long i = first; i < last; i++)
+            {
+                hits[i] = _intersect(beziers[pairs[i].first], beziers[pairs[i].second]);
+            }
+        }, _min_grain);
+        return hits;
+    }
+
+    /**
+     * Intersect curves and a plane, such as slicing, in parallel.
+     * @param curves the curves
+     * @param plane the plane
+     * @return the intersections of each curve
+     */
+    template <typename _Curve>
+    std::vector<std::vector<PlaneHit>> intersect(const std::vector<const _Curve*>& curves, const Plane& plane) const
+    {
+        auto normalized = _normalized(plane);
+
+        std::vector<std::vector<PlaneHit>> hits(curves.size());
+        parallel_for(0, long(curves.size()), [&](long first, long last)
+        {
+            for (long i = first; i < last; i++)
+            {
+                hits[i] = _intersect(_decompose(*curves[i]), normalized);
+            }
+        }, _min_grain);
+        return hits;
+    }
+
+private: // curve-curve
+
+    std::vector<CurveHit> _intersect(const _Bezier& a, const _Bezier& b) const
+    {
+        std::vector<CurveHit> hits;
+        for (size_t i = 0; i < a.segments.size(); i++)
+        {
+            for (size_t j = 0; j < b.segments.size(); j++)
+            {
+                if (!_is_overlapping(a.boxes[i], b.boxes[j]))
+                {
+                    continue;
+                }
+                _subdivide(_Piece<_Vt>{a.segments[i], a.breakpoints[i], a.breakpoints[i + 1]},
+                           _Piece<_Vt>{b.segments[j], b.breakpoints[j], b.breakpoints[j + 1]}, 0, hits);
+            }
+        }
+
+        BSplineEvaluator<_Dt> ea(a.degree, *a.ctrlpts, *a.knots, 1);
+        BSplineEvaluator<_Dt> eb(b.degree, *b.ctrlpts, *b.knots, 1);
+        for (auto& hit : hits)
+        {
+            _polish(a, ea, b, eb, hit);
+        }
+
+        std::sort(hits.begin(), hits.end(), [](const CurveHit& x, const CurveHit& y)
+        {
+            return x.u < y.u;
+        });
+        return _unique(hits);
+    }
+
+    /// Subdivide the larger piece until both are flat, then intersect their chords.
+    void _subdivide(const _Piece<_Vt>& a, const _Piece<_Vt>& b, int depth, std::vector<CurveHit>& hits) const
+    {
+        auto box_a = _bound_box(a.points), box_b = _bound_box(b.points);
+        if (!_is_overlapping(box_a, box_b))
+        {
+            return;
+        }
+
+        bool flat_a = _flatness(a.points) <= _tolerance, flat_b = _flatness(b.points) <= _tolerance;
+        if ((flat_a && flat_b) || depth >= _max_depth)
+        {
+            if (flat_a && flat_b && _overlap(a, b, hits))
+            {
+                return;
+            }
+
+            _Dt s, t;
+            _Vt p, q;
+            _closest_points(a.points.front(), a.points.back(), b.points.front(), b.points.back(), s, t, p, q);
+            if ((p - q).length() <= 2 * _tolerance)
+            {
+                hits.push_back(CurveHit{a.t0 + (a.t1 - a.t0) * s, b.t0 + (b.t1 - b.t0) * t, (p + q) * _Dt(0.5)});
+            }
+            return;
+        }
+
+        bool split_a = !flat_a && (flat_b || _diagonal(box_a) >= _diagonal(box_b));
+        const auto& piece = split_a ? a : b;
+
+        _Piece<_Vt> left, right;
+        _split(piece, _Dt(0.5), left, right);
+        if (split_a)
+        {
+            _subdivide(left, b, depth + 1, hits);
+            _subdivide(right, b, depth + 1, hits);
+        }
+        else
+        {
+            _subdivide(a, left, depth + 1, hits);
+            _subdivide(a, right, depth + 1, hits);
+        }
+    }
+
+    /// Intersect the chords of two flat pieces lying on each other, the end points of the overlap are the hits.
+    /// False if the chords are not on a common line or overlap in a point only.
+    bool _overlap(const _Piece<_Vt>& a, const _Piece<_Vt>& b, std::vector<CurveHit>& hits) const
+    {
+        const _Vt &a0 = a.points.front(), &a1 = a.points.back();
+        const _Vt &b0 = b.points.front(), &b1 = b.points.back();
+        _Vt da = a1 - a0, db = b1 - b0;
+        _Dt la = da.length(), lb = db.length();
+        if (la <= _tolerance || lb <= _tolerance)
+        {
+            return false;
+        }
+
+        // every end point lies on the line of the other chord
+        auto distance = [](const _Vt& point, const _Vt& origin, const _Vt& direction, _Dt length)
+        {
+            return (point - origin).cross(direction).length() / length;
+        };
+        if (distance(b0, a0, da, la) > _tolerance || distance(b1, a0, da, la) > _tolerance ||
+            distance(a0, b0, db, lb) > _tolerance || distance(a1, b0, db, lb) > _tolerance)
+        {
+            return false;
+        }
+
+        // the ends of b projected on the chord of a
+        _Dt s0 = (b0 - a0).dot(da) / (la * la), s1 = (b1 - a0).dot(da) / (la * la);
+        _Dt s_min = std::max(std::min(s0, s1), _Dt(0.0)), s_max = std::min(std::max(s0, s1), _Dt(1.0));
+        if ((s_max - s_min) * la <= 2 * _tolerance)
+        {
+            return false;
+        }
+
+        for (_Dt s : {s_min, s_max})
+        {
+            _Vt p = a0 + da * s;
+            _Dt t = std::min(std::max((p - b0).dot(db) / (lb * lb), _Dt(0.0)), _Dt(1.0));
+            _Vt q = b0 + db * t;
+            hits.push_back(CurveHit{a.t0 + (a.t1 - a.t0) * s, b.t0 + (b.t1 - b.t0) * t, (p + q) * _Dt(0.5)});
+        }
+        return true;
+    }
+
+    /// Gauss-Newton iteration on A(u) - B(v) = 0, kept if it converges.
+    void _polish(const _Bezier& a, const BSplineEvaluator<_Dt>& ea, const _Bezier& b,
+                 const BSplineEvaluator<_Dt>& eb, CurveHit& hit) const
+    {
+        _Dt u = hit.u, v = hit.v;
+        _Vt da[2], db[2];
+        for (int iter = 0; iter < 8; iter++)
+        {
+            ea.derivatives(u, 1, da);
+            eb.derivatives(v, 1, db);
+            _Vt f = da[0] - db[0];
+
+            // normal equations of the 3x2 system [A', -B'] [du, dv] = -f
+            _Dt a11 = da[1].dot(da[1]), a12 = -da[1].dot(db[1]), a22 = db[1].dot(db[1]);
+            _Dt b1 = -da[1].dot(f), b2 = db[1].dot(f);
+            _Dt det = a11 * a22 - a12 * a12;
+            if (std::abs(det) <= std::numeric_limits<_Dt>::epsilon() * a11 * a22)
+            {
+                // tangential, keep the subdivision result
+                return;
+            }
+            u = _clamp(u + (b1 * a22 - b2 * a12) / det, a);
+            v = _clamp(v + (a11 * b2 - a12 * b1) / det, b);
+        }
+
+        _Vt p = ea.point(u), q = eb.point(v);
+        if ((p - q).length() <= _tolerance && (p - hit.point).length() <= 4 * _tolerance)
+        {
+            hit = CurveHit{u, v, (p + q) * _Dt(0.5)};
+        }
+    }
+
+    /// Merge the intersections found by adjacent pieces, the hits are ordered by u.
+    std::vector<CurveHit> _unique(const std::vector<CurveHit>& hits) const
+    {
+        std::vector<CurveHit> result;
+        for (const auto& hit : hits)
+        {
+            if (result.empty() || (result.back().point - hit.point).length() > 4 * _tolerance)
+            {
+                result.push_back(hit);
+            }
+        }
+        return result;
+    }
+
+private: // curve-plane
+
+    std::vector<PlaneHit> _intersect(const _Bezier& bezier, const Plane& plane) const
+    {
+        std::vector<PlaneHit> hits;
+        BSplineEvaluator<_Dt> evaluator(bezier.degree, *bezier.ctrlpts, *bezier.knots, 1);
+
+        for (size_t i = 0; i < bezier.segments.size(); i++)
+        {
+            // signed distances of the control points are the Bezier coefficients of the signed distance
+            const auto& segment = bezier.segments[i];
+            _Piece<_Dt> piece{std::vector<_Dt>(segment.size()), bezier.breakpoints[i], bezier.breakpoints[i + 1]};
+            for (size_t k = 0; k < segment.size(); k++)
+            {
+                piece.points[k] = plane.normal.dot(segment[k] - plane.point);
+            }
+            _clip(piece, 0, hits);
+        }
+
+        for (auto& hit : hits)
+        {
+            _polish(bezier, evaluator, plane, hit);
+        }
+
+        std::sort(hits.begin(), hits.end(), [](const PlaneHit& x, const PlaneHit& y)
+        {
+            return x.u < y.u;
+        });
+
+        std::vector<PlaneHit> result;
+        for (const auto& hit : hits)
+        {
+            if (result.empty() || (result.back().point - hit.point).length() > 4 * _tolerance)
+            {
+                result.push_back(hit);
+            }
+        }
+        return result;
+    }
+
+    /// Bezier clipping of the signed distance d(t): clip to the interval where the convex hull of the control points
+    /// (i / p, d_i) crosses zero, subdivide if it does not shrink enough.
+    void _clip(_Piece<_Dt> piece, int depth, std::vector<PlaneHit>& hits) const
+    {
+        int p = int(piece.points.size()) - 1;
+        while (true)
+        {
+            auto range = std::minmax_element(piece.points.begin(), piece.points.end());
+            _Dt d_min = *range.first, d_max = *range.second;
+            if (d_min > _tolerance || d_max < -_tolerance)
+            {
+                return;
+            }
+
+            // flat enough: the chord crosses zero
+            const auto& d = piece.points;
+            if (d_max - d_min <= _tolerance || depth >= _max_depth)
+            {
+                _Dt s = d.front() == d.back() ? _Dt(0.5) : std::min(std::max(d.front() / (d.front() - d.back()),
+                                                                             _Dt(0.0)), _Dt(1.0));
+                hits.push_back(PlaneHit{piece.t0 + (piece.t1 - piece.t0) * s, _Vt()});
+                return;
+            }
+
+            // the convex hull crosses zero between the crossings of the segments joining control points
+            _Dt s_min = 1, s_max = 0;
+            for (int i = 0; i <= p; i++)
+            {
+                if (d[i] == 0)
+                {
+                    s_min = std::min(s_min, _Dt(i) / p);
+                    s_max = std::max(s_max, _Dt(i) / p);
+                }
+                for (int j = i + 1; j <= p; j++)
+                {
+                    if ((d[i] < 0) != (d[j] < 0) && d[i] != 0 && d[j] != 0)
+                    {
+                        _Dt s = (i + (j - i) * d[i] / (d[i] - d[j])) / p;
+                        s_min = std::min(s_min, s);
+                        s_max = std::max(s_max, s);
+                    }
+                }
+            }
+            if (s_min > s_max)
+            {
+                // only touching within the tolerance
+                s_min = 0;
+                s_max = 1;
+            }
+
+            if (s_max - s_min > _Dt(0.8))
+            {
+                _Piece<_Dt> left, right;
+                _split(piece, _Dt(0.5), left, right);
+                _clip(std::move(left), depth + 1, hits);
+                _clip(std::move(right), depth + 1, hits);
+                return;
+            }
+
+            // keep [s_min, s_max]
+            _Piece<_Dt> left, right;
+            _split(piece, s_max, left, right);
+            if (s_max > 0)
+            {
+                _split(left, s_min / s_max, right, piece);
+            }
+            else
+            {
+                piece = _Piece<_Dt>{std::vector<_Dt>(p + 1, left.points.front()), left.t0, left.t0};
+            }
+            depth++;
+        }
+    }
+
+    /// Newton iteration on n . (C(u) - P) = 0, kept if it converges.
+    void _polish(const _Bezier& bezier, const BSplineEvaluator<_Dt>& evaluator, const Plane& plane,
+                 PlaneHit& hit) const
+    {
+        _Dt u = hit.u;
+        _Vt ders[2];
+        for (int iter = 0; iter < 8; iter++)
+        {
+            evaluator.derivatives(u, 1, ders);
+            _Dt slope = plane.normal.dot(ders[1]);
+            if (slope == 0)
+            {
+                break;
+            }
+            u = _clamp(u - plane.normal.dot(ders[0] - plane.point) / slope, bezier);
+        }
+
+        _Vt p = evaluator.point(u);
+        if (std::abs(plane.normal.dot(p - plane.point)) <= _tolerance &&
+            (p - evaluator.point(hit.u)).length() <= 4 * _tolerance)
+        {
+            hit.u = u;
+        }
+        hit.point = evaluator.point(hit.u);
+    }
+
+private: // Bezier segments
+
+    template <typename _Curve>
+    static _Bezier _decompose(const _Curve& curve)
+    {
+        _Bezier bezier;
+        bezier.degree = curve.get_degree();
+        bezier.ctrlpts = &curve.get_control_points();
+        bezier.knots = &curve.get_knot_vector();
+        curve.decompose_to_bezier(bezier.segments, bezier.breakpoints);
+        for (const auto& segment : bezier.segments)
+        {
+            bezier.boxes.push_back(_bound_box(segment));
+        }
+        return bezier;
+    }
+
+    template <typename _Curve>
+    static std::vector<_Bezier> _decompose_all(const std::vector<const _Curve*>& curves)
+    {
+        std::vector<_Bezier> beziers(curves.size());
+        parallel_for(0, long(curves.size()), [&](long first, long last)
+        {
+            for (long i = first; i < last; i++)
+            {
+                beziers[i] = _decompose(*curves[i]);
+            }
+        }, _min_grain);
+        return beziers;
+    }
+
+    /// Split a piece at t in [0, 1] by de Casteljau's algorithm.
+    template <typename _Type>
+    static void _split(const _Piece<_Type>& piece, _Dt t, _Piece<_Type>& left, _Piece<_Type>& right)
+    {
+        int p = int(piece.points.size()) - 1;
+        std::vector<_Type> temp = piece.points;
+        left.points.resize(p + 1);
+        right.points.resize(p + 1);
+
+        left.points[0] = temp[0];
+        right.points[p] = temp[p];
+        for (int k = 1; k <= p; k++)
+        {
+            for (int i = 0; i <= p - k; i++)
+            {
+                temp[i] = (1.0 - t) * temp[i] + t * temp[i + 1];
+            }
+            left.points[k] = temp[0];
+            right.points[p - k] = temp[p - k];
+        }
+
+        _Dt mid = piece.t0 + (piece.t1 - piece.t0) * t;
+        left.t0 = piece.t0;
+        left.t1 = mid;
+        right.t0 = mid;
+        right.t1 = piece.t1;
+    }
+
+    static BoundBox<_Dt> _bound_box(const std::vector<_Vt>& points)
+    {
+        const auto& p = points.front();
+        BoundBox<_Dt> box{p.x, p.x, p.y, p.y, p.z, p.z};
+        for (const auto& q : points)
+        {
+            box.x_min = std::min(box.x_min, q.x);
+            box.x_max = std::max(box.x_max, q.x);
+            box.y_min = std::min(box.y_min, q.y);
+            box.y_max = std::max(box.y_max, q.y);
+            box.z_min = std::min(box.z_min, q.z);
+            box.z_max = std::max(box.z_max, q.z);
+        }
+        return box;
+    }
+
+    static _Dt _diagonal(const BoundBox<_Dt>& box)
+    {
+        return _Vt(box.x_max - box.x_min, box.y_max - box.y_min, box.z_max - box.z_min).length();
+    }
+
+    /// Max distance of the control points from the chord.
+    static _Dt _flatness(const std::vector<_Vt>& points)
+    {
+        const auto& a = points.front();
+        _Vt chord = points.back() - a;
+        _Dt length = chord.length();
+
+        _Dt flatness = 0;
+        for (size_t i = 1; i + 1 < points.size(); i++)
+        {
+            _Vt v = points[i] - a;
+            _Dt distance = length > 0 ? v.cross(chord).length() / length : v.length();
+            flatness = std::max(flatness, distance);
+        }
+        return flatness;
+    }
+
+    bool _is_overlapping(const BoundBox<_Dt>& a, const BoundBox<_Dt>& b) const
+    {
+        return a.x_min <= b.x_max + _tolerance && b.x_min <= a.x_max + _tolerance &&
+               a.y_min <= b.y_max + _tolerance && b.y_min <= a.y_max + _tolerance &&
+               a.z_min <= b.z_max + _tolerance && b.z_min <= a.z_max + _tolerance;
+    }
+
+    /// Closest points p = a0 + s (a1 - a0) and q = b0 + t (b1 - b0) of two segments, s and t in [0, 1].
+    static void _closest_points(const _Vt& a0, const _Vt& a1, const _Vt& b0, const _Vt& b1,
+                                _Dt& s, _Dt& t, _Vt& p, _Vt& q)
+    {
+        _Vt d1 = a1 - a0, d2 = b1 - b0, r = a0 - b0;
+        _Dt a = d1.dot(d1), e = d2.dot(d2), f = d2.dot(r);
+
+        if (a == 0 && e == 0)
+        {
+            s = t = 0;
+        }
+        else if (a == 0)
+        {
+            s = 0;
+            t = std::min(std::max(f / e, _Dt(0.0)), _Dt(1.0));
+        }
+        else
+        {
+            _Dt c = d1.dot(r);
+            if (e == 0)
+            {
+                t = 0;
+                s = std::min(std::max(-c / a, _Dt(0.0)), _Dt(1.0));
+            }
+            else
+            {
+                _Dt b = d1.dot(d2);
+                _Dt denom = a * e - b * b;
+                s = denom > 0 ? std::min(std::max((b * f - c * e) / denom, _Dt(0.0)), _Dt(1.0)) : _Dt(0.0);
+                t = (b * s + f) / e;
+                if (t < 0)
+                {
+                    t = 0;
+                    s = std::min(std::max(-c / a, _Dt(0.0)), _Dt(1.0));
+                }
+                else if (t > 1)
+                {
+                    t = 1;
+                    s = std::min(std::max((b - c) / a, _Dt(0.0)), _Dt(1.0));
+                }
+            }
+        }
+
+        p = a0 + d1 * s;
+        q = b0 + d2 * t;
+    }
+
+    /// Clamp a parameter to the domain of the curve.
+    static _Dt _clamp(_Dt u, const _Bezier& bezier)
+    {
+        return std::min(std::max(u, bezier.breakpoints.front()), bezier.breakpoints.back());
+    }
+
+    static Plane _normalized(const Plane& plane)
+    {
+        _Dt length = plane.normal.length();
+        if (!(length > 0))
+        {
+            throw std::invalid_argument("normal of the plane must not be zero.");
+        }
+        return Plane{plane.point, plane.normal * (_Dt(1.0) / length)};
+    }
+};
+
+#endif //B_SPLINE_CURVEINTERSECTION_H
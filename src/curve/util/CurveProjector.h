@@ -0,0 +1,341 @@
+//
+// Created by haochuanchen on 18-5-30.
+//
+
+#ifndef B_SPLINE_CURVEPROJECTOR_H
+#define B_SPLINE_CURVEPROJECTOR_H
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "../base_type/BoundBox.h"
+#include "BSplineEvaluator.h"
+#include "Parallel.h"
+
+/**
+ * Closest point projection (point inversion) onto a B spline curve.
+ * By the convex hull property, the piece of the curve over a knot span lies in the bound box of the p + 1 control
+ * points of the span. A bounding volume hierarchy is built over these boxes; a query visits the boxes nearest first,
+ * skips the ones farther than the best point found, and refines a candidate span by Newton iteration on
+ * C'(u) . (C(u) - P) = 0.
+ * See: *The NURBS Book* Section 6.1
+ *
+ * The projector is immutable once built. Queries without an evaluator use the projector's own one and are NOT THREAD
+ * SAFETY; pass one `BSplineEvaluator` per thread, or use the batch `project`, which runs in parallel.
+ * The control points and the knot vector are referenced, not copied.
+ * @tparam _DataType data type of the coordinate, default double
+ */
+template <typename _DataType = double>
+class CurveProjector
+{
+public:
+    using _Dt = _DataType;
+    using _Vt = Vector3X<_Dt>;
+    using _Evaluator = BSplineEvaluator<_Dt>;
+
+    /// Projection of a point onto the curve.
+    struct Projection
+    {
+        /// parameter of the closest point
+        _Dt u;
+        /// the closest point
+        _Vt point;
+        /// distance between the point and the curve
+        _Dt distance;
+    };
+
+private:
+    /// Node of the hierarchy, a leaf if `left` < 0.
+    struct _Node
+    {
+        BoundBox<_Dt> box;
+        int left;
+        int right;
+        /// knot span of a leaf
+        int span;
+    };
+
+    int _degree;
+    const std::vector<_Vt>& _ctrlpts;
+    const std::vector<_Dt>& _knots;
+
+    /// nodes of the hierarchy, the root is the first one
+    std::vector<_Node> _nodes;
+
+    /// evaluator of the queries without an evaluator
+    std::unique_ptr<_Evaluator> _evaluator;
+
+    /// samples per span to start Newton iteration from
+    static constexpr int _n_sample = 4;
+
+    /// minimum number of queries projected by a thread
+    static constexpr long _min_grain = 64;
+
+public:
+    /**
+     * Build the projector of a B spline curve.
+     * @param degree degree(order - 1) of the B spline
+     * @param control_points control points of the B spline
+     * @param knots knot vector of the B spline
+     */
+    CurveProjector(int degree, const std::vector<_Vt>& control_points, const std::vector<_Dt>& knots)
+        : _degree(degree), _ctrlpts(control_points), _knots(knots)
+    {
+        std::vector<_Node> leaves;
+        int n = int(control_points.size()) - 1;
+        for (int i = degree; i <= n; i++)
+        {
+            if (knots[i + 1] <= knots[i])
+            {
+                continue;
+            }
+            leaves.push_back(_Node{_bound_box(i - degree, i), -1, -1, i});
+        }
+
+        if (leaves.empty())
+        {
+            throw std::invalid_argument("the curve has no knot span.");
+        }
+
+        // spans are in the order along the curve, so adjacent spans are close: split the sequence in halves
+        _nodes.reserve(leaves.size() * 2);
+        _build(leaves, 0, int(leaves.size()));
+
+        _evaluator = std::make_unique<_Evaluator>(degree, control_points, knots, 2);
+    }
+
+    /**
+     * Build the projector of a B spline curve, such as `BSplineCurve`.
+     * @param curve the curve, must outlive the projector
+     */
+    template <typename _Curve>
+    explicit CurveProjector(const _Curve& curve)
+        : CurveProjector(curve.get_degree(), curve.get_control_points(), curve.get_knot_vector())
+    {
+    }
+
+    CurveProjector(const CurveProjector&) = delete;
+    CurveProjector& operator=(const CurveProjector&) = delete;
+
+    /**
+     * Project a point onto the curve.
+     * @param point the point
+     * @return the projection
+     */
+    Projection project(const _Vt& point) const
+    {
+        return project(point, *_evaluator);
+    }
+
+    /**
+     * Project a point onto the curve.
+     * @param point the point
+     * @param evaluator evaluator of the curve with max derivative order 2 at least, one per thread
+     * @return the projection
+     */
+    Projection project(const _Vt& point, const _Evaluator& evaluator) const
+    {
+        Projection best{_knots[_degree], _Vt(), std::numeric_limits<_Dt>::max()};
+        _Dt best_squared = std::numeric_limits<_Dt>::max();
+
+        // depth first, the nearer child first
+        int stack[64];
+        int top = 0;
+        stack[top++] = 0;
+
+        while (top > 0)
+        {
+            const auto& node = _nodes[stack[--top]];
+            if (_squared_distance(node.box, point) >= best_squared)
+            {
+                continue;
+            }
+
+            if (node.left < 0)
+            {
+                auto candidate = _project_span(point, node.span, evaluator);
+                _Dt squared = candidate.distance * candidate.distance;
+                if (squared < best_squared)
+                {
+                    best_squared = squared;
+                    best = candidate;
+                }
+                continue;
+            }
+
+            _Dt left = _squared_distance(_nodes[node.left].box, point);
+            _Dt right = _squared_distance(_nodes[node.right].box, point);
+            if (left < right)
+            {
+                stack[top++] = node.right;
+                stack[top++] = node.left;
+            }
+            else
+            {
+                stack[top++] = node.left;
+                stack[top++] = node.right;
+            }
+        }
+
+        return best;
+    }
+
+    /**
+     * Project points onto the curve, in parallel.
+     * @param points the points
+     * @return projections of the points
+     */
+    std::vector<Projection> project(const std::vector<_Vt>& points) const
+    {
+        std::vector<Projection> projections(points.size());
+        parallel_for(0, long(points.size()), [&](long first, long last)
+        {
+            _Evaluator evaluator(_degree, _ctrlpts, _knots, 2);
+            for (long i = first; i < last; i++)
+            {
+                projections[i] = project(points[i], evaluator);
+            }
+        }, _min_grain);
+        return projections;
+    }
+
+    /**
+     * Get the bound boxes of the control points of the non-empty knot spans, the leaves of the hierarchy.
+     * @return pairs of the knot span index and its bound box, in the order along the curve
+     */
+    std::vector<std::pair<int, BoundBox<_Dt>>> span_bound_boxes() const
+    {
+        std::vector<std::pair<int, BoundBox<_Dt>>> boxes;
+        for (const auto& node : _nodes)
+        {
+            if (node.left < 0)
+            {
+                boxes.emplace_back(node.span, node.box);
+            }
+        }
+        std::sort(boxes.begin(), boxes.end(), [](const auto& a, const auto& b)
+        {
+            return a.first < b.first;
+        });
+        return boxes;
+    }
+
+private:
+    /// Build the subtree of leaves [first, last).
+    /// \return index of the root of the subtree
+    int _build(const std::vector<_Node>& leaves, int first, int last)
+    {
+        if (last - first == 1)
+        {
+            _nodes.push_back(leaves[first]);
+            return int(_nodes.size()) - 1;
+        }
+
+        int index = int(_nodes.size());
+        _nodes.emplace_back();
+
+        int mid = (first + last) / 2;
+        int left = _build(leaves, first, mid);
+        int right = _build(leaves, mid, last);
+
+        const auto& a = _nodes[left].box;
+        const auto& b = _nodes[right].box;
+        _nodes[index] = _Node{BoundBox<_Dt>{std::min(a.x_min, b.x_min), std::max(a.x_max, b.x_max),
+                                            std::min(a.y_min, b.y_min), std::max(a.y_max, b.y_max),
+                                            std::min(a.z_min, b.z_min), std::max(a.z_max, b.z_max)},
+                              left, right, -1};
+        return index;
+    }
+
+    /// Bound box of control points [first, last].
+    BoundBox<_Dt> _bound_box(int first, int last) const
+    {
+        const auto& p = _ctrlpts[first];
+        BoundBox<_Dt> box{p.x, p.x, p.y, p.y, p.z, p.z};
+        for (int i = first + 1; i <= last; i++)
+        {
+            const auto& q = _ctrlpts[i];
+            box.x_min = std::min(box.x_min, q.x);
+            box.x_max = std::max(box.x_max, q.x);
+            box.y_min = std::min(box.y_min, q.y);
+            box.y_max = std::max(box.y_max, q.y);
+            box.z_min = std::min(box.z_min, q.z);
+            box.z_max = std::max(box.z_max, q.z);
+        }
+        return box;
+    }
+
+    /// Squared distance between a point and a box, 0 inside.
+    static _Dt _squared_distance(const BoundBox<_Dt>& box, const _Vt& p)
+    {
+        _Dt dx = std::max({box.x_min - p.x, _Dt(0.0), p.x - box.x_max});
+        _Dt dy = std::max({box.y_min - p.y, _Dt(0.0), p.y - box.y_max});
+        _Dt dz = std::max({box.z_min - p.z, _Dt(0.0), p.z - box.z_max});
+        return dx * dx + dy * dy + dz * dz;
+    }
+
+    /// Closest point on the piece of the curve over knot span `span`.
+    Projection _project_span(const _Vt& point, int span, const _Evaluator& evaluator) const
+    {
+        _Dt a = _knots[span], b = _knots[span + 1];
+
+        // the nearest sample, the ends included
+        _Dt u = a;
+        _Dt best = std::numeric_limits<_Dt>::max();
+        for (int i = 0; i <= _n_sample; i++)
+        {
+            _Dt t = a + (b - a) * i / _n_sample;
+            _Dt squared = (evaluator.point(span, t) - point).squared_length();
+            if (squared < best)
+            {
+                best = squared;
+                u = t;
+            }
+        }
+        _Dt sample = u;
+
+        // Newton iteration on f(u) = C'(u) . (C(u) - P), clamped to the span
+        _Vt ders[3];
+        const _Dt epsilon = std::numeric_limits<_Dt>::epsilon() * 16;
+        for (int iter = 0; iter < 16; iter++)
+        {
+            evaluator.derivatives(span, u, 2, ders);
+            _Vt diff = ders[0] - point;
+
+            _Dt f = ders[1].dot(diff);
+            _Dt df = ders[2].dot(diff) + ders[1].squared_length();
+            if (std::abs(f) <= epsilon * ders[1].length() * diff.length() || df == 0)
+            {
+                break;
+            }
+
+            _Dt next = std::min(std::max(u - f / df, a), b);
+            if (std::abs((next - u) * ders[1].length()) <= epsilon)
+            {
+                u = next;
+                break;
+            }
+            u = next;
+        }
+
+        _Vt closest = evaluator.point(span, u);
+        _Dt distance = (closest - point).length();
+
+        // Newton may converge to a farther critical point than the nearest sample
+        if (distance * distance > best)
+        {
+            u = sample;
+            closest = evaluator.point(span, u);
+            distance = std::sqrt(best);
+        }
+
+        return Projection{u, closest, distance};
+    }
+};
+
+#endif //B_SPLINE_CURVEPROJECTOR_H
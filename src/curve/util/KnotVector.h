@@ -0,0 +1,126 @@
+//
+// Created by haochuanchen on 18-6-4.
+//
+
+#ifndef B_SPLINE_KNOTVECTOR_H
+#define B_SPLINE_KNOTVECTOR_H
+
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * Operations on knot vectors, shared by `BSplineCurve` and `NURBSCurve`.
+ * @tparam _DataType data type of the knots, default `double`
+ */
+template <typename _DataType = double>
+struct KnotVector
+{
+    using _Dt = _DataType;
+
+    /**
+     * Check that the knots are ascending.
+     * @param knots the knot vector
+     * @throw std::logic_error if a knot is less than the one before it
+     */
+    static void check_ascending(const std::vector<_Dt>& knots)
+    {
+        for (size_t i = 1; i < knots.size(); i++)
+        {
+            if (knots[i - 1] > knots[i])
+            {
+                throw std::logic_error("the knot vector is not ascending.");
+            }
+        }
+    }
+
+    /**
+     * Map the knots onto [0, 1] linearly. All the knots become 1 if they are equal.
+     * @param knots the ascending knot vector
+     */
+    static void normalize(std::vector<_Dt>& knots)
+    {
+        if (knots.size() < 2)
+        {
+            return;
+        }
+        _Dt knot_min = knots[0], knot_max = knots[knots.size() - 1];
+        _Dt knot_range = knot_max - knot_min;
+
+        if (std::abs(knot_range) == 0.0)
+        {
+            for (size_t i = 0; i < knots.size(); i++)
+            {
+                knots[i] = 1.0;
+            }
+            return;
+        }
+
+        for (size_t i = 0; i < knots.size(); i++)
+        {
+            knots[i] = (knots[i] - knot_min) / knot_range;
+        }
+    }
+
+    /**
+     * Check that the knots are ascending, and normalize them.
+     * @param knots the knot vector
+     * @return the normalized knot vector
+     */
+    static std::vector<_Dt> normalized(const std::vector<_Dt>& knots)
+    {
+        check_ascending(knots);
+        std::vector<_Dt> result = knots;
+        normalize(result);
+        return result;
+    }
+
+    /**
+     * Get the clamped knot vector on [0, 1] with uniformly spaced inner knots.
+     * @param degree degree(order - 1) of the B spline
+     * @param n_control_point the number of control points
+     * @return (`n_control_point` + `degree` + 1) knots
+     */
+    static std::vector<_Dt> uniform(int degree, int n_control_point)
+    {
+        // min and max knot vector values
+        _Dt knot_min = _Dt(0.0);
+        _Dt knot_max = _Dt(1.0);
+
+        int n = n_control_point - 1;
+
+        // equation to use: m = n + p + 1
+        // p: degree, n + 1: number of control points; m + 1: number of knots
+        int m = degree + n + 1;
+
+        // calculate a uniform interval for middle knots
+        // number of segments in the middle
+        int num_segments = (m - (degree + 1) * 2) + 2;
+        // spacing between the knots (uniform)
+        _Dt spacing = (knot_max - knot_min) / num_segments;
+
+        std::vector<_Dt> knot_vector(m + 1);
+
+        // first degree + 1 knots are `knot_min`
+        for (int i = 0; i <= degree; i++)
+        {
+            knot_vector[i] = knot_min;
+        }
+
+        // middle knots
+        for (int i = degree + 1; i <= n; i++)
+        {
+            knot_vector[i] = spacing * (i - degree);
+        }
+
+        // Last degree + 1 knots are `knot_max`
+        for (int i = n + 1; i <= m; i++)
+        {
+            knot_vector[i] = knot_max;
+        }
+
+        return knot_vector;
+    }
+};
+
+#endif //B_SPLINE_KNOTVECTOR_H
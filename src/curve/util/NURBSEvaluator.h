@@ -0,0 +1,224 @@
+//
+// Created by haochuanchen on 18-6-4.
+//
+
+#ifndef B_SPLINE_NURBSEVALUATOR_H
+#define B_SPLINE_NURBSEVALUATOR_H
+
+#include <stdexcept>
+#include <vector>
+
+#include "../base_type/Vector4X.h"
+#include "BSplineFunction.h"
+
+/**
+ * Evaluate points and derivatives of a NURBS curve at arbitrary parameters.
+ * The curve is evaluated as a non-rational B spline of the homogeneous control points (wx, wy, wz, w) by the same
+ * basis function kernels as `BSplineEvaluator`, then projected; derivatives follow from the homogeneous ones.
+ * It keeps the scratch arrays, so evaluation does not allocate. It is NOT THREAD SAFETY, create one evaluator per
+ * thread. The control points and the knot vector are referenced, not copied.
+ * @tparam _DataType data type of the coordinate, default double
+ */
+template <typename _DataType = double>
+class NURBSEvaluator
+{
+public:
+    using _Dt = _DataType;
+    using _Vt = Vector3X<_Dt>;
+    using _Ht = Vector4X<_Dt>;
+
+private:
+    /// degree(order - 1) of the B spline
+    int _degree;
+
+    /// homogeneous control points
+    const std::vector<_Ht>& _ctrlpts;
+
+    /// knot vector
+    const std::vector<_Dt>& _knots;
+
+    /// basis functions
+    BSplineFunction<_Dt> _bf;
+
+    /// max derivative order supported
+    int _max_order;
+
+    /// basis functions and their derivatives, _Dt[_max_order + 1][degree + 1], scratch of the const evaluations
+    mutable std::vector<std::vector<_Dt>> _ders;
+    mutable std::vector<_Dt*> _ders_rows;
+    /// derivatives of the homogeneous curve, _Ht[_max_order + 1]
+    mutable std::vector<_Ht> _homogeneous;
+
+    /// binomial coefficients, _Dt[_max_order + 1][_max_order + 1]
+    std::vector<std::vector<_Dt>> _binomial;
+
+public:
+    /**
+     * Create an evaluator of the NURBS curve.
+     * @param degree degree(order - 1) of the B spline
+     * @param control_points homogeneous control points of the B spline
+     * @param knots knot vector of the B spline
+     * @param max_order max derivative order to evaluate
+     */
+    NURBSEvaluator(int degree, const std::vector<_Ht>& control_points, const std::vector<_Dt>& knots,
+                   int max_order = 3)
+        : _degree(degree), _ctrlpts(control_points), _knots(knots),
+          _bf(int(control_points.size()) - 1, degree, knots), _max_order(max_order)
+    {
+        _ders.assign(max_order + 1, std::vector<_Dt>(degree + 1));
+        for (auto& row : _ders)
+        {
+            _ders_rows.push_back(row.data());
+        }
+        _homogeneous.resize(max_order + 1);
+
+        _binomial.assign(max_order + 1, std::vector<_Dt>(max_order + 1, _Dt(0.0)));
+        for (int k = 0; k <= max_order; k++)
+        {
+            _binomial[k][0] = 1;
+            for (int i = 1; i <= k; i++)
+            {
+                _binomial[k][i] = _binomial[k - 1][i - 1] + (i < k ? _binomial[k - 1][i] : _Dt(0.0));
+            }
+        }
+    }
+
+    /**
+     * Create an evaluator of a NURBS curve, such as `NURBSCurve`.
+     * @param curve the curve, must outlive the evaluator
+     * @param max_order max derivative order to evaluate
+     */
+    template <typename _Curve>
+    explicit NURBSEvaluator(const _Curve& curve, int max_order = 3)
+        : NURBSEvaluator(curve.get_degree(), curve.get_homogeneous_control_points(), curve.get_knot_vector(),
+                         max_order)
+    {
+    }
+
+    NURBSEvaluator(const NURBSEvaluator&) = delete;
+    NURBSEvaluator& operator=(const NURBSEvaluator&) = delete;
+
+    /**
+     * Determine the knot span index of parameter u.
+     * @param u the parameter
+     * @return the knot span index
+     */
+    int find_span(_Dt u) const
+    {
+        return _bf.find_span(u);
+    }
+
+    /**
+     * Compute the point on the curve.
+     * See: *The NURBS Book* Algorithm A4.1
+     * @param u the parameter
+     * @return the point
+     */
+    _Vt point(_Dt u) const
+    {
+        return point(_bf.find_span(u), u);
+    }
+
+    /**
+     * Compute the point on the curve, with known knot span.
+     * @param span the index of the knot span containing u
+     * @param u the parameter
+     * @return the point
+     */
+    _Vt point(int span, _Dt u) const
+    {
+        _Dt* func_values = _ders_rows[0];
+        _bf.basis_funcs(span, u, func_values);
+
+        _Ht result;
+        for (int i = 0; i <= _degree; i++)
+        {
+            result += func_values[i] * _ctrlpts[span - _degree + i];
+        }
+        return result.project();
+    }
+
+    /**
+     * Compute the point and derivatives on the curve.
+     * See: *The NURBS Book* Algorithm A4.2
+     * @param u the parameter
+     * @param order max derivative order, no more than `max_order` of the evaluator
+     * @param ders pre-alloced array to store C(u), C'(u), ..., _Vt[order + 1]
+     */
+    void derivatives(_Dt u, int order, _Vt* ders) const
+    {
+        derivatives(_bf.find_span(u), u, order, ders);
+    }
+
+    /**
+     * Compute the point and derivatives on the curve, with known knot span.
+     * @param span the index of the knot span containing u
+     * @param u the parameter
+     * @param order max derivative order, no more than `max_order` of the evaluator
+     * @param ders pre-alloced array to store C(u), C'(u), ..., _Vt[order + 1]
+     */
+    void derivatives(int span, _Dt u, int order, _Vt* ders) const
+    {
+        if (order > _max_order)
+        {
+            throw std::invalid_argument("derivative order is greater than the max order of the evaluator.");
+        }
+
+        // derivatives of the homogeneous curve, zero above the degree
+        int du = order < _degree ? order : _degree;
+        _bf.ders_basis_funcs(span, u, du, _ders_rows.data());
+
+        for (int k = 0; k <= order; k++)
+        {
+            _homogeneous[k] = _Ht();
+        }
+        for (int k = 0; k <= du; k++)
+        {
+            for (int j = 0; j <= _degree; j++)
+            {
+                _homogeneous[k] += _ders_rows[k][j] * _ctrlpts[span - _degree + j];
+            }
+        }
+
+        // C(k) = (A(k) - sum_{i=1}^{k} binomial(k, i) w(i) C(k - i)) / w
+        _Dt w = _homogeneous[0].w;
+        for (int k = 0; k <= order; k++)
+        {
+            _Vt v = _homogeneous[k].weighted();
+            for (int i = 1; i <= k; i++)
+            {
+                v -= (_binomial[k][i] * _homogeneous[i].w) * ders[k - i];
+            }
+            ders[k] = v / w;
+        }
+    }
+
+    /**
+     * Get the degree of the curve.
+     * @return degree
+     */
+    int get_degree() const
+    {
+        return _degree;
+    }
+
+    /**
+     * Get the homogeneous control points of the curve.
+     * @return homogeneous control points
+     */
+    const std::vector<_Ht>& get_homogeneous_control_points() const
+    {
+        return _ctrlpts;
+    }
+
+    /**
+     * Get the knot vector of the curve.
+     * @return knot vector
+     */
+    const std::vector<_Dt>& get_knot_vector() const
+    {
+        return _knots;
+    }
+};
+
+#endif //B_SPLINE_NURBSEVALUATOR_H
@@ -0,0 +1,132 @@
+//
+// Created by haochuanchen on 18-5-10.
+//
+
+#ifndef B_SPLINE_PARALLEL_H
+#define B_SPLINE_PARALLEL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "ThreadPool.h"
+
+/**
+ * Get the number of chunks to split a range of `size` elements for parallel processing.
+ * Each chunk contains at least `min_grain` elements, and there are no more chunks than hardware threads.
+ * @param size the number of elements
+ * @param min_grain the minimum number of elements of a chunk
+ * @return the number of chunks, at least 1
+ */
+inline unsigned parallel_chunk_count(long size, long min_grain = 4096)
+{
+    long n_chunk = min_grain > 0 ? size / min_grain : size;
+    long n_thread = ThreadPool::default_thread_count();
+    n_chunk = n_chunk < n_thread ? n_chunk : n_thread;
+    return n_chunk < 1 ? 1 : unsigned(n_chunk);
+}
+
+/**
+ * Split [`begin`, `end`) into `n_chunk` contiguous chunks of nearly the same size, and call
+ * `func(chunk_index, chunk_begin, chunk_end)` for every chunk in parallel.
+ * The chunks are claimed one by one by the calling thread and by helper tasks on `ThreadPool::shared()`, so no thread
+ * is created per call, and a call nested in a chunk or in a pool task never waits for a chunk nobody runs: at worst
+ * the calling thread runs all of them. A single chunk runs inline.
+ * If `func` throws, the chunks not started yet are skipped, and the first exception is rethrown once the running
+ * chunks are done.
+ * @param begin first index of the range
+ * @param end one past the last index of the range
+ * @param n_chunk the number of chunks
+ * @param func the function to call
+ */
+template <typename _Func>
+void parallel_for_chunk(long begin, long end, unsigned n_chunk, _Func&& func)
+{
+    long size = end - begin;
+    if (n_chunk <= 1 || size <= 1)
+    {
+        func(0u, begin, end);
+        return;
+    }
+
+    // shared with the helper tasks, which may start after the call has returned
+    struct _State
+    {
+        std::atomic<unsigned> next{0};
+        unsigned n_done = 0;
+        std::exception_ptr error;
+        std::mutex mutex;
+        std::condition_variable condition;
+    };
+    auto state = std::make_shared<_State>();
+
+    // `func` is only used for a claimed chunk, while the calling thread is still waiting
+    auto run = [state, begin, size, n_chunk, &func]
+    {
+        for (unsigned i = state->next++; i < n_chunk; i = state->next++)
+        {
+            bool failed;
+            {
+                std::unique_lock<std::mutex> lock(state->mutex);
+                failed = bool(state->error);
+            }
+
+            if (!failed)
+            {
+                try
+                {
+                    func(i, begin + size * long(i) / long(n_chunk), begin + size * long(i + 1) / long(n_chunk));
+                }
+                catch (...)
+                {
+                    std::unique_lock<std::mutex> lock(state->mutex);
+                    if (!state->error)
+                    {
+                        state->error = std::current_exception();
+                    }
+                }
+            }
+
+            std::unique_lock<std::mutex> lock(state->mutex);
+            if (++state->n_done == n_chunk)
+            {
+                state->condition.notify_all();
+            }
+        }
+    };
+
+    auto& pool = ThreadPool::shared();
+    for (unsigned i = 1; i < n_chunk && i <= pool.size(); i++)
+    {
+        pool.submit(run);
+    }
+
+    run();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->condition.wait(lock, [&state, n_chunk] { return state->n_done == n_chunk; });
+    if (state->error)
+    {
+        std::rethrow_exception(state->error);
+    }
+}
+
+/**
+ * Call `func(chunk_begin, chunk_end)` on the chunks of [`begin`, `end`) in parallel.
+ * Small ranges run inline on the calling thread.
+ * @param begin first index of the range
+ * @param end one past the last index of the range
+ * @param func the function to call
+ * @param min_grain the minimum number of elements of a chunk
+ */
+template <typename _Func>
+void parallel_for(long begin, long end, _Func&& func, long min_grain = 4096)
+{
+    parallel_for_chunk(begin, end, parallel_chunk_count(end - begin, min_grain),
+                       [&func](unsigned, long chunk_begin, long chunk_end) { func(chunk_begin, chunk_end); });
+}
+
+#endif //B_SPLINE_PARALLEL_H
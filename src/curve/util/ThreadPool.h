@@ -0,0 +1,150 @@
+//
+// Created by haochuanchen on 18-5-8.
+//
+
+#ifndef B_SPLINE_THREADPOOL_H
+#define B_SPLINE_THREADPOOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+/**
+ * Fixed size thread pool. Tasks are executed in FIFO order by the worker threads.
+ * The destructor waits for all the submitted tasks.
+ */
+class ThreadPool
+{
+private:
+    /// worker threads
+    std::vector<std::thread> _workers;
+
+    /// pending tasks
+    std::queue<std::function<void()>> _tasks;
+
+    std::mutex _mutex;
+    std::condition_variable _condition;
+
+    /// is the pool stopping
+    bool _stop = false;
+
+public:
+    /**
+     * Create a thread pool.
+     * @param n_thread the number of worker threads, 0 means the number of hardware threads
+     */
+    explicit ThreadPool(unsigned n_thread = 0)
+    {
+        if (n_thread == 0)
+        {
+            n_thread = default_thread_count();
+        }
+
+        _workers.reserve(n_thread);
+        for (unsigned i = 0; i < n_thread; i++)
+        {
+            _workers.emplace_back([this] { _work(); });
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool()
+    {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+        _condition.notify_all();
+
+        for (auto& worker : _workers)
+        {
+            worker.join();
+        }
+    }
+
+    /**
+     * Submit a task to the pool.
+     * @param func the task
+     * @return future of the result of the task
+     */
+    template <typename _Func>
+    auto submit(_Func&& func) -> std::future<decltype(func())>
+    {
+        using _Ret = decltype(func());
+
+        auto task = std::make_shared<std::packaged_task<_Ret()>>(std::forward<_Func>(func));
+        auto result = task->get_future();
+
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            if (_stop)
+            {
+                throw std::logic_error("submit task to a stopped thread pool.");
+            }
+            _tasks.emplace([task] { (*task)(); });
+        }
+        _condition.notify_one();
+
+        return result;
+    }
+
+    /**
+     * Get the number of the worker threads.
+     * @return the number of the worker threads
+     */
+    unsigned size() const
+    {
+        return _workers.size();
+    }
+
+    /**
+     * The pool shared by the parallel loops of the process, see `parallel_for_chunk`. Its threads, with the calling
+     * thread of a loop, are as many as the hardware threads.
+     * @return the shared pool
+     */
+    static ThreadPool& shared()
+    {
+        static ThreadPool pool(default_thread_count() > 1 ? default_thread_count() - 1 : 1);
+        return pool;
+    }
+
+    /**
+     * The number of the hardware threads, at least 1.
+     * @return the number of threads
+     */
+    static unsigned default_thread_count()
+    {
+        unsigned n = std::thread::hardware_concurrency();
+        return n == 0 ? 1 : n;
+    }
+
+private:
+    void _work()
+    {
+        while (true)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _condition.wait(lock, [this] { return _stop || !_tasks.empty(); });
+                if (_stop && _tasks.empty())
+                {
+                    return;
+                }
+                task = std::move(_tasks.front());
+                _tasks.pop();
+            }
+            task();
+        }
+    }
+};
+
+#endif //B_SPLINE_THREADPOOL_H
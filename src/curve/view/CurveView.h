@@ -22,7 +22,7 @@ private:
     using _Pt = typename _Ct::_Pt;
     using _Dt = typename _Pt::_Dt;
 
-    static_assert(std::is_base_of<Curve<typename _Ct::_Pt>, _Ct>::value);
+    static_assert(std::is_base_of<Curve<typename _Ct::_Pt, typename _Ct::_Storage>, _Ct>::value);
 
 private:
      /// The curve to show
@@ -0,0 +1,186 @@
+//
+// Created by haochuanchen on 18-5-15.
+//
+
+#include "AdaptiveFitting.h"
+#include "../curve/util/BSplineEvaluator.h"
+
+#include <algorithm>
+
+AdaptiveFitting::AdaptiveFitting(const _In_Ct& curve_to_fit, int degree, _Dt tolerance, int max_control_point)
+    : BSplineCurveFitting_Base(curve_to_fit, degree, degree + 1), _tolerance(tolerance)
+{
+    int n_vertex = _src_curve.get_vertices().size();
+    _max_control_point = max_control_point > 0 ? std::min(max_control_point, n_vertex) : n_vertex;
+
+    if (_max_control_point < degree + 1)
+    {
+        throw std::invalid_argument("too few vertices for the degree.");
+    }
+}
+
+std::vector<AdaptiveFitting::_Dt> AdaptiveFitting::select_knot_vector()
+{
+    _n_trial = 0;
+
+    // a single Bezier segment
+    std::vector<_Dt> knots(2 * (_degree + 1), _Dt(0.0));
+    std::fill(knots.begin() + _degree + 1, knots.end(), _Dt(1.0));
+
+    _n = _degree;
+    _n_trial++;
+    Trial coarse = _measure(_Out_Ct(_degree, _Base::minimum_squared_optimize(knots), knots));
+
+    Trial best = coarse;
+
+    // galloping: split every span exceeding the tolerance
+    std::vector<_Dt> new_knots;
+    while (coarse.max_error > _tolerance)
+    {
+        int n_control_point = coarse.curve.get_control_points().size();
+        new_knots = _candidate_knots(coarse, _max_control_point - n_control_point);
+        if (new_knots.empty())
+        {
+            break;
+        }
+
+        Trial fine = _refine(coarse, new_knots);
+        if (fine.max_error < best.max_error)
+        {
+            best = fine;
+        }
+
+        if (fine.max_error <= _tolerance)
+        {
+            break;
+        }
+        coarse = std::move(fine);
+    }
+
+    // bisection on the knots inserted by the last round, keeping the worst spans first; it assumes the error falls
+    // with every prefix, which usually but not always holds, so the result is an approximate minimum
+    if (best.max_error <= _tolerance && coarse.max_error > _tolerance && new_knots.size() > 1)
+    {
+        int low = 0, high = new_knots.size();
+        while (high - low > 1)
+        {
+            int middle = (low + high) / 2;
+
+            std::vector<_Dt> subset(new_knots.begin(), new_knots.begin() + middle);
+            Trial trial = _refine(coarse, subset);
+
+            if (trial.max_error <= _tolerance)
+            {
+                high = middle;
+                best = std::move(trial);
+            }
+            else
+            {
+                low = middle;
+            }
+        }
+    }
+
+    _result = std::move(best.curve);
+    _n = int(_result.get_control_points().size()) - 1;
+
+    return _result.get_knot_vector();
+}
+
+int AdaptiveFitting::get_trial_count() const
+{
+    return _n_trial;
+}
+
+std::vector<AdaptiveFitting::_Vt> AdaptiveFitting::minimum_squared_optimize(const std::vector<_Dt>& knots)
+{
+    if (knots == _result.get_knot_vector())
+    {
+        return _result.get_control_points();
+    }
+
+    return _Base::minimum_squared_optimize(knots);
+}
+
+AdaptiveFitting::Trial AdaptiveFitting::_refine(const Trial& coarse, const std::vector<_Dt>& new_knots)
+{
+    // the same curve on the finer knot vector
+    _Out_Ct curve = coarse.curve;
+
+    curve.refine_knot_vector(new_knots);
+
+    _n = int(curve.get_control_points().size()) - 1;
+    _n_trial++;
+
+    auto control_points = warm_minimum_squared_optimize(curve.get_knot_vector(), curve.get_control_points());
+    curve.set_control_points(control_points);
+
+    return _measure(std::move(curve));
+}
+
+AdaptiveFitting::Trial AdaptiveFitting::_measure(_Out_Ct curve) const
+{
+    const auto& vertices = _src_curve.get_vertices();
+
+    Trial trial{std::move(curve), _Dt(0.0), {}};
+    trial.span_error.assign(trial.curve.get_knot_vector().size(), _Dt(0.0));
+
+    BSplineEvaluator<_Dt> evaluator(trial.curve, 0);
+
+    for (const auto& vertex : vertices)
+    {
+        int span = evaluator.find_span(vertex.trait.u);
+        _Dt error = (evaluator.point(span, vertex.trait.u) - vertex.vertex).length();
+
+        trial.span_error[span] = std::max(trial.span_error[span], error);
+        trial.max_error = std::max(trial.max_error, error);
+    }
+
+    return trial;
+}
+
+std::vector<AdaptiveFitting::_Dt> AdaptiveFitting::_candidate_knots(const Trial& trial, int max_count) const
+{
+    const auto& vertices = _src_curve.get_vertices();
+    const auto& knots = trial.curve.get_knot_vector();
+
+    // (error, knot) of the spans to split
+    std::vector<std::pair<_Dt, _Dt>> candidates;
+
+    int k = 0, m = vertices.size() - 1;
+    for (int span = _degree; span + 1 < knots.size() - _degree; span++)
+    {
+        // vertices in [knots[span], knots[span + 1])
+        while (k <= m && vertices[k].trait.u < knots[span])
+        {
+            k++;
+        }
+        int first = k, last = k;
+        while (last <= m && vertices[last].trait.u < knots[span + 1])
+        {
+            last++;
+        }
+
+        if (trial.span_error[span] <= _tolerance || last - first < 2)
+        {
+            continue;
+        }
+
+        // the median parameter keeps vertices on both sides of the new knot
+        _Dt u = vertices[(first + last) / 2].trait.u;
+        if (u > knots[span] && u < knots[span + 1])
+        {
+            candidates.emplace_back(trial.span_error[span], u);
+        }
+    }
+
+    std::sort(candidates.begin(), candidates.end(),
+              [](const std::pair<_Dt, _Dt>& a, const std::pair<_Dt, _Dt>& b) { return a.first > b.first; });
+
+    std::vector<_Dt> result;
+    for (int i = 0; i < candidates.size() && i < max_count; i++)
+    {
+        result.push_back(candidates[i].second);
+    }
+    return result;
+}
@@ -0,0 +1,90 @@
+//
+// Created by haochuanchen on 18-5-15.
+//
+
+#ifndef B_SPLINE_ADAPTIVEFITTING_H
+#define B_SPLINE_ADAPTIVEFITTING_H
+
+#include "BSplineCurveFitting_Base.h"
+
+/**
+ * Fitting with a small number of control points meeting an error tolerance.
+ * Starting from a single Bezier segment, knots are inserted into all the spans exceeding the tolerance (galloping,
+ * the number of control points nearly doubles per round) until the tolerance is met, then the inserted knots of the
+ * last round are bisected, worst span first. Knot vectors of all the trials are nested, so every trial is warm
+ * started from the control polygon of the last failed one refined by knot insertion, and solved iteratively.
+ * The search is greedy: the knots are placed at span medians and the bisection assumes the error falls as more of
+ * them are inserted, so the number of control points is an approximate minimum, not the smallest possible one.
+ */
+class AdaptiveFitting : public BSplineCurveFitting_Base
+{
+public:
+    using _Base = BSplineCurveFitting_Base;
+
+    using _Dt = _Base::_Dt;
+    using _Vt = _Base::_Vt;
+
+public:
+    /// Initial adaptive B spline curve fitting.
+    /// \param curve_to_fit a parameterized curve
+    /// \param degree degree(order - 1) of the B spline curve
+    /// \param tolerance max distance between the vertices and the fitted curve
+    /// \param max_control_point upper limit of the number of control points, 0 means the number of vertices
+    AdaptiveFitting(const _In_Ct& curve_to_fit, int degree, _Dt tolerance, int max_control_point = 0);
+
+    /// Search a knot vector with few control points meeting the tolerance, see the class comment for how close to
+    /// the minimum it gets. If the tolerance can not be met within the limit, the best knot vector found is returned.
+    std::vector<_Dt> select_knot_vector() override;
+
+    /// Get the number of least squares solves of the last search.
+    /// \return the number of trials
+    int get_trial_count() const;
+
+protected:
+    /// Reuse the control points of the search if `knots` is the knot vector found.
+    std::vector<_Vt> minimum_squared_optimize(const std::vector<_Dt>& knots) override;
+
+protected:
+    /// A fitted curve and its error.
+    struct Trial
+    {
+        _Out_Ct curve;
+        /// max error of the whole curve
+        _Dt max_error;
+        /// max error of every knot span
+        std::vector<_Dt> span_error;
+    };
+
+    /// Fit with the knots of `coarse` plus `new_knots`, warm started from `coarse`.
+    /// \param coarse a fitted coarser curve
+    /// \param new_knots ascending knots to insert
+    /// \return the trial
+    Trial _refine(const Trial& coarse, const std::vector<_Dt>& new_knots);
+
+    /// Measure the error of every knot span.
+    /// \param curve the fitted curve
+    /// \return the trial
+    Trial _measure(_Out_Ct curve) const;
+
+    /// Knots to insert into the spans exceeding the tolerance, worst span first.
+    /// \param trial a fitted curve
+    /// \param max_count max number of knots
+    /// \return knots to insert
+    std::vector<_Dt> _candidate_knots(const Trial& trial, int max_count) const;
+
+protected:
+    /// max distance between the vertices and the fitted curve
+    _Dt _tolerance;
+
+    /// upper limit of the number of control points
+    int _max_control_point;
+
+    /// the number of least squares solves
+    int _n_trial = 0;
+
+    /// the fitted curve found by the search
+    _Out_Ct _result;
+};
+
+
+#endif //B_SPLINE_ADAPTIVEFITTING_H
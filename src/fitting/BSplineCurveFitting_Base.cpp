@@ -3,9 +3,13 @@
 //
 
 #include "BSplineCurveFitting_Base.h"
+#include "../curve/util/CurveDecimation.h"
+#include "../curve/util/BSplineEvaluator.h"
 
 #include <Eigen/Sparse>
 
+#include <algorithm>
+
 using SpMat = typename Eigen::SparseMatrix<BSplineCurveFitting_Base::_Dt>;
 using Triplet = typename Eigen::Triplet<BSplineCurveFitting_Base::_Dt>;
 
@@ -23,8 +27,108 @@ BSplineCurveFitting_Base::fitting()
     return BSplineCurveFitting_Base::_Out_Ct(_degree, control_point, knot_vector);
 }
 
+BSplineCurveFitting_Base::FittingError BSplineCurveFitting_Base::fitting_error(const _Out_Ct& fitted) const
+{
+    const auto& vertices = _src_curve.get_vertices();
+
+    BSplineEvaluator<_Dt> evaluator(fitted, 0);
+
+    FittingError error{_Dt(0.0), _Dt(0.0)};
+    for (const auto& vertex : vertices)
+    {
+        _Dt dist = (evaluator.point(vertex.trait.u) - vertex.vertex).length();
+        error.max_error = dist > error.max_error ? dist : error.max_error;
+        error.mean_error += dist;
+    }
+
+    if (!vertices.empty())
+    {
+        error.mean_error /= vertices.size();
+    }
+
+    return error;
+}
+
+int BSplineCurveFitting_Base::decimate(_Dt tolerance, _Dt max_gap)
+{
+    _src_curve = CurveDecimation<_In_Ct>(tolerance, max_gap).decimate(_src_curve);
+
+    int m = _src_curve.get_vertices().size() - 1;
+    if (_n > m)
+    {
+        throw std::invalid_argument("too few vertices are kept for the number of control points.");
+    }
+
+    return m + 1;
+}
+
+void BSplineCurveFitting_Base::add_point_constraint(_Dt u, const _Vt& point)
+{
+    add_derivative_constraint(u, 0, point);
+}
+
+void BSplineCurveFitting_Base::add_derivative_constraint(_Dt u, int order, const _Vt& derivative)
+{
+    if (u < _Dt(0.0) || u > _Dt(1.0))
+    {
+        throw std::out_of_range("parameter of the constraint is out of [0, 1].");
+    }
+
+    if (order < 0 || order > _degree)
+    {
+        throw std::invalid_argument("derivative order of the constraint must be in [0, degree].");
+    }
+
+    _constraints.push_back(Constraint{u, order, derivative});
+}
+
+void BSplineCurveFitting_Base::set_end_derivatives(int order, const _Vt& start, const _Vt& end)
+{
+    add_derivative_constraint(_Dt(0.0), order, start);
+    add_derivative_constraint(_Dt(1.0), order, end);
+}
+
+void BSplineCurveFitting_Base::clear_constraints()
+{
+    _constraints.clear();
+}
+
+const std::vector<BSplineCurveFitting_Base::Constraint>& BSplineCurveFitting_Base::get_constraints() const
+{
+    return _constraints;
+}
+
 std::vector<BSplineCurveFitting_Base::_Vt>
 BSplineCurveFitting_Base::minimum_squared_optimize(const std::vector<_Dt>& knots)
+{
+    if (!_constraints.empty())
+    {
+        return constrained_minimum_squared_optimize(knots);
+    }
+
+    return _unconstrained_minimum_squared_optimize(knots, nullptr);
+}
+
+std::vector<BSplineCurveFitting_Base::_Vt>
+BSplineCurveFitting_Base::warm_minimum_squared_optimize(const std::vector<_Dt>& knots,
+                                                        const std::vector<_Vt>& initial_guess)
+{
+    if (!_constraints.empty())
+    {
+        return constrained_minimum_squared_optimize(knots);
+    }
+
+    if (initial_guess.size() != _n + 1)
+    {
+        throw std::invalid_argument("the initial guess does not match the number of control points.");
+    }
+
+    return _unconstrained_minimum_squared_optimize(knots, &initial_guess);
+}
+
+std::vector<BSplineCurveFitting_Base::_Vt>
+BSplineCurveFitting_Base::_unconstrained_minimum_squared_optimize(const std::vector<_Dt>& knots,
+                                                                  const std::vector<_Vt>* initial_guess)
 {
     int m = _src_curve.get_vertices().size() - 1;
     int row = m - 1;
@@ -101,9 +205,36 @@ BSplineCurveFitting_Base::minimum_squared_optimize(const std::vector<_Dt>& knots
 
     N.setFromTriplets(coefficients.begin(), coefficients.end());
 
-    Eigen::SparseQR<SpMat, Eigen::AMDOrdering<int>> qr(N.transpose() * N);
+    SpMat NtN = N.transpose() * N;
+    Eigen::MatrixXd P;
+
+    bool solved = false;
+    if (initial_guess != nullptr)
+    {
+        // N^T N is symmetric positive definite, and a good guess converges in a few iterations
+        Eigen::MatrixXd P0(col, 3);
+        for (int i = 1; i <= _n - 1; i++)
+        {
+            P0(i - 1, 0) = (*initial_guess)[i].x;
+            P0(i - 1, 1) = (*initial_guess)[i].y;
+            P0(i - 1, 2) = (*initial_guess)[i].z;
+        }
+
+        Eigen::ConjugateGradient<SpMat, Eigen::Lower | Eigen::Upper> cg(NtN);
+        cg.setTolerance(1e-10);
+
+        P = cg.solveWithGuess(R, P0);
+
+        // clustered knots make N^T N ill-conditioned, and CG may stop at the iteration limit: solve directly then
+        solved = cg.info() == Eigen::Success;
+    }
+
+    if (!solved)
+    {
+        Eigen::SparseQR<SpMat, Eigen::AMDOrdering<int>> qr(NtN);
 
-    Eigen::MatrixXd P = qr.solve(R);
+        P = qr.solve(R);
+    }
 
     delete[] func_values;
 
@@ -124,3 +255,165 @@ BSplineCurveFitting_Base::minimum_squared_optimize(const std::vector<_Dt>& knots
 
     return result;
 }
+
+std::vector<BSplineCurveFitting_Base::_Vt>
+BSplineCurveFitting_Base::constrained_minimum_squared_optimize(const std::vector<_Dt>& knots)
+{
+    const auto& src_vertices = _src_curve.get_vertices();
+
+    int m = src_vertices.size() - 1;
+
+    // the end points are interpolated as usual, unless the caller has pinned them already
+    std::vector<Constraint> constraints = _constraints;
+    bool has_start = false, has_end = false;
+    for (const auto& c : constraints)
+    {
+        has_start = has_start || (c.order == 0 && c.u == _Dt(0.0));
+        has_end = has_end || (c.order == 0 && c.u == _Dt(1.0));
+    }
+    if (!has_start)
+    {
+        constraints.push_back(Constraint{_Dt(0.0), 0, src_vertices[0].vertex});
+    }
+    if (!has_end)
+    {
+        constraints.push_back(Constraint{_Dt(1.0), 0, src_vertices[m].vertex});
+    }
+
+    int n_unknown = _n + 1;
+    int n_constraint = constraints.size();
+
+    if (n_constraint > n_unknown)
+    {
+        throw std::invalid_argument("too many constraints for the number of control points.");
+    }
+
+    BSplineFunction bf(_n, _degree, knots);
+
+    _Dt *func_values = new _Dt[_degree + 1];
+
+    int max_order = 0;
+    for (const auto& c : constraints)
+    {
+        max_order = c.order > max_order ? c.order : max_order;
+    }
+
+    _Dt **ders = new _Dt*[max_order + 1];
+    for (int k = 0; k <= max_order; k++)
+    {
+        ders[k] = new _Dt[_degree + 1];
+    }
+
+    // KKT system:
+    // | N^T N  M^T | | P      |   | N^T Q |
+    // | M      0   | | lambda | = | T     |
+    // where N holds the basis functions of the unconstrained points, M the (derivatives of) basis functions of the
+    // constraints. Every row of N and M has at most p + 1 non-zeros. The multiplier of a constraint is numbered right
+    // after the last control point it acts on, so the interleaved system stays banded and is factorized in its own
+    // order, in time linear in the number of control points.
+    std::vector<int> spans(n_constraint);
+    for (int c = 0; c < n_constraint; c++)
+    {
+        spans[c] = bf.find_span(constraints[c].u);
+    }
+
+    std::vector<int> order(n_constraint);
+    for (int c = 0; c < n_constraint; c++)
+    {
+        order[c] = c;
+    }
+    std::stable_sort(order.begin(), order.end(), [&spans](int a, int b) { return spans[a] < spans[b]; });
+
+    // position of control point i and of the multiplier of constraint c in the interleaved system
+    std::vector<int> point_index(n_unknown), multiplier_index(n_constraint);
+    for (int i = 0, c = 0, index = 0; i < n_unknown; i++)
+    {
+        point_index[i] = index++;
+        for (; c < n_constraint && spans[order[c]] == i; c++)
+        {
+            multiplier_index[order[c]] = index++;
+        }
+    }
+
+    std::vector<Triplet> coefficients;
+    Eigen::MatrixXd R = Eigen::MatrixXd::Zero(n_unknown + n_constraint, 3);
+
+    _Dt u;
+
+    for (int k = 1; k <= m - 1; k++)
+    {
+        u = src_vertices[k].trait.u;
+        int span = bf.find_span(u);
+        bf.basis_funcs(span, u, func_values);
+
+        for (int i = 0; i <= _degree; i++)
+        {
+            int row = point_index[span - _degree + i];
+            for (int j = 0; j <= _degree; j++)
+            {
+                coefficients.emplace_back(row, point_index[span - _degree + j], func_values[i] * func_values[j]);
+            }
+
+            R(row, 0) += func_values[i] * src_vertices[k].vertex.x;
+            R(row, 1) += func_values[i] * src_vertices[k].vertex.y;
+            R(row, 2) += func_values[i] * src_vertices[k].vertex.z;
+        }
+    }
+
+    for (int c = 0; c < n_constraint; c++)
+    {
+        const auto& constraint = constraints[c];
+        int span = spans[c];
+        bf.ders_basis_funcs(span, constraint.u, constraint.order, ders);
+
+        int row = multiplier_index[c];
+        for (int j = 0; j <= _degree; j++)
+        {
+            coefficients.emplace_back(row, point_index[span - _degree + j], ders[constraint.order][j]);
+            coefficients.emplace_back(point_index[span - _degree + j], row, ders[constraint.order][j]);
+        }
+
+        R(row, 0) = constraint.value.x;
+        R(row, 1) = constraint.value.y;
+        R(row, 2) = constraint.value.z;
+    }
+
+    SpMat K(n_unknown + n_constraint, n_unknown + n_constraint);
+    K.setFromTriplets(coefficients.begin(), coefficients.end());
+
+    // K is symmetric indefinite, so use LU rather than Cholesky; the natural order keeps the fill-in in the band
+    Eigen::SparseLU<SpMat, Eigen::NaturalOrdering<int>> lu;
+    lu.compute(K);
+
+    if (lu.info() != Eigen::Success)
+    {
+        delete[] func_values;
+        for (int k = 0; k <= max_order; k++)
+        {
+            delete[] ders[k];
+        }
+        delete[] ders;
+
+        throw std::logic_error("the constraints are inconsistent or degenerate on the knot vector.");
+    }
+
+    Eigen::MatrixXd P = lu.solve(R);
+
+    delete[] func_values;
+    for (int k = 0; k <= max_order; k++)
+    {
+        delete[] ders[k];
+    }
+    delete[] ders;
+
+    std::vector<_Vt> result;
+    result.reserve(n_unknown);
+
+    for (int i = 0; i < n_unknown; i++)
+    {
+        int index = point_index[i];
+        result.emplace_back(P(index, 0), P(index, 1), P(index, 2));
+    }
+
+    return result;
+}
@@ -22,6 +22,27 @@ public:
     using _Out_Pt = CurvePoint<_Dt, BSplinePointTrait<_Dt>>;
     using _Out_Ct = BSplineCurve<_Out_Pt>;
 
+    /// Equality constraint of the fitted curve: the `order`-th derivative at parameter `u` equals `value`.
+    /// `order` 0 interpolates a point, 1 fixes the tangent, 2 fixes the second derivative (curvature).
+    struct Constraint
+    {
+        /// parameter of the constraint
+        _Dt u;
+        /// derivative order, no more than the degree
+        int order;
+        /// the required point or derivative
+        _Vt value;
+    };
+
+    /// Deviation of a fitted curve from the curve to fit, measured at the parameters of the vertices.
+    struct FittingError
+    {
+        /// max distance
+        _Dt max_error;
+        /// mean distance
+        _Dt mean_error;
+    };
+
 public:
     /// Initial B spline curve fitting.
     /// \param curve_to_fit a parameterized curve.
@@ -34,6 +55,44 @@ public:
     /// \return get fitted B Spline curve
     _Out_Ct fitting();
 
+    /// Measure the deviation of a fitted curve from the curve to fit.
+    /// \param fitted the fitted curve
+    /// \return max and mean distance between the vertices and the fitted curve at their parameters
+    FittingError fitting_error(const _Out_Ct& fitted) const;
+
+public: // pre-processing
+    /// Drop the redundant vertices of the curve to fit, keeping their parameters. Call it before `fitting()` for
+    /// oversampled curves. The end points are always kept.
+    /// \param tolerance maximum distance between a dropped vertex and the decimated polyline
+    /// \param max_gap maximum distance between two adjacent kept vertices, 0 means no limit
+    /// \return the number of vertices after decimation
+    int decimate(_Dt tolerance, _Dt max_gap = _Dt(0.0));
+
+public: // constraints
+    /// Force the fitted curve to pass `point` at parameter `u`.
+    /// \param u parameter in [0, 1]
+    /// \param point the point to interpolate
+    void add_point_constraint(_Dt u, const _Vt& point);
+
+    /// Force the `order`-th derivative of the fitted curve at parameter `u` to be `derivative`.
+    /// \param u parameter in [0, 1]
+    /// \param order derivative order, 1 for tangent, 2 for second derivative
+    /// \param derivative the derivative vector, w.r.t. the parameter of the curve
+    void add_derivative_constraint(_Dt u, int order, const _Vt& derivative);
+
+    /// Constrain the `order`-th derivatives at both ends of the fitted curve.
+    /// \param order derivative order, 1 for end tangents, 2 for end second derivatives
+    /// \param start derivative at u = 0
+    /// \param end derivative at u = 1
+    void set_end_derivatives(int order, const _Vt& start, const _Vt& end);
+
+    /// Remove all the constraints. The end points are still interpolated.
+    void clear_constraints();
+
+    /// Get the constraints of the fitting.
+    /// \return constraints
+    const std::vector<Constraint>& get_constraints() const;
+
 protected:
     /// Select knot vector to fit curve.
     /// See: *The NURBS Book* (Sect. 9.4.1)
@@ -45,9 +104,27 @@ protected:
     /// \return control points
     virtual std::vector<_Vt> minimum_squared_optimize(const std::vector<_Dt>& knots);
 
-protected:
+    /// Minimum squared optimization solved iteratively from an initial guess, such as the control points of a
+    /// coarser fit refined to `knots` by knot insertion. The direct solver is used if there are constraints.
+    /// \param knots knot vector
+    /// \param initial_guess initial control points, (`_n` + 1) points
+    /// \return control points
+    std::vector<_Vt> warm_minimum_squared_optimize(const std::vector<_Dt>& knots,
+                                                   const std::vector<_Vt>& initial_guess);
+
+    /// Minimum squared optimization subject to the equality constraints, solved with Lagrange multipliers. Every
+    /// multiplier is interleaved with the control points of its knot span, so the KKT system keeps the band structure
+    /// of N^T N and its cost is still linear in the number of control points.
+    /// See: *The NURBS Book* (Sect. 9.4.2)
+    /// \param knots knot vector
+    /// \return control points
+    std::vector<_Vt> constrained_minimum_squared_optimize(const std::vector<_Dt>& knots);
 
 
+private:
+    std::vector<_Vt> _unconstrained_minimum_squared_optimize(const std::vector<_Dt>& knots,
+                                                             const std::vector<_Vt>* initial_guess);
+
 protected: // --------- field ---------
     /// Original discrete curve to fit
     _In_Ct _src_curve;
@@ -57,6 +134,9 @@ protected: // --------- field ---------
 
     /// degree(order - 1) of the B spline
     int _degree;
+
+    /// equality constraints besides the end points
+    std::vector<Constraint> _constraints;
 };
 
 
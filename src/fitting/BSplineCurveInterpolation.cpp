@@ -0,0 +1,241 @@
+//
+// Created by haochuanchen on 18-6-8.
+//
+
+#include "BSplineCurveInterpolation.h"
+#include "../curve/util/BSplineFunction.h"
+#include "../curve/util/Parallel.h"
+
+#include <algorithm>
+#include <cmath>
+
+BSplineCurveInterpolation::BSplineCurveInterpolation(const _In_Ct& curve_to_interpolate)
+    : _src_curve(curve_to_interpolate)
+{
+}
+
+BSplineCurveInterpolation::_Out_Ct BSplineCurveInterpolation::global_interpolation(int degree) const
+{
+    const auto& vertices = _src_curve.get_vertices();
+
+    int n = int(vertices.size()) - 1;
+    int p = degree;
+
+    if (p < 1 || p > n)
+    {
+        throw std::invalid_argument("degree of the interpolation must be in [1, number of vertices - 1].");
+    }
+
+    // knots: average of p adjacent parameters, Eq. (9.8)
+    std::vector<_Dt> knots(n + p + 2);
+    for (int j = 0; j <= p; j++)
+    {
+        knots[j] = vertices[0].trait.u;
+        knots[n + 1 + j] = vertices[n].trait.u;
+    }
+    for (int j = 1; j <= n - p; j++)
+    {
+        _Dt sum = 0;
+        for (int i = j; i <= j + p - 1; i++)
+        {
+            sum += vertices[i].trait.u;
+        }
+        knots[p + j] = sum / p;
+    }
+
+    // collocation matrix: row k holds the p + 1 basis functions nonzero at the k-th parameter
+    int width = p + 1;
+    std::vector<_Dt> rows(std::size_t(n + 1) * width);
+    std::vector<int> first(n + 1);
+    std::vector<_Vt> ctrlpts(n + 1);
+
+    parallel_for(0, n + 1, [&](long begin, long end)
+    {
+        // the basis functions keep scratch arrays, one per thread
+        BSplineFunction<_Dt> bf(n, p, knots);
+        for (long k = begin; k < end; k++)
+        {
+            _Dt u = vertices[k].trait.u;
+            int span = bf.find_span(u);
+            bf.basis_funcs(span, u, &rows[k * width]);
+            first[k] = span - p;
+            ctrlpts[k] = vertices[k].vertex;
+        }
+    }, _min_grain);
+
+    _banded_lu_solve(rows, first, width, ctrlpts);
+
+    return _Out_Ct(p, ctrlpts, knots);
+}
+
+BSplineCurveInterpolation::_Out_Ct
+BSplineCurveInterpolation::local_cubic_interpolation(std::vector<_Dt>* parameters) const
+{
+    const auto& vertices = _src_curve.get_vertices();
+
+    long n = long(vertices.size()) - 1;
+    if (n < 1)
+    {
+        throw std::invalid_argument("at least 2 vertices are needed to interpolate.");
+    }
+
+    auto tangents = _estimate_tangents();
+
+    // speed of every segment, the root of Eq. (9.33) making the three legs of the Bezier polygon equally long
+    std::vector<_Dt> speed(n);
+    parallel_for(0, n, [&](long begin, long end)
+    {
+        for (long k = begin; k < end; k++)
+        {
+            _Vt chord = vertices[k + 1].vertex - vertices[k].vertex;
+            _Vt sum = tangents[k] + tangents[k + 1];
+            _Dt a = 16 - sum.squared_length();
+            _Dt b = 12 * chord.dot(sum);
+            _Dt c = -36 * chord.squared_length();
+            speed[k] = (-b + std::sqrt(b * b - 4 * a * c)) / (2 * a);
+        }
+    }, _min_grain);
+
+    // parameters: the chord length of the Bezier polygons, 3 * (speed / 3)
+    std::vector<_Dt> params(n + 1, _Dt(0.0));
+    for (long k = 0; k < n; k++)
+    {
+        if (!(speed[k] > 0))
+        {
+            throw std::invalid_argument("adjacent vertices to interpolate coincide.");
+        }
+        params[k + 1] = params[k] + speed[k];
+    }
+
+    // cubic Bezier segments joined by double knots
+    std::vector<_Vt> ctrlpts(2 * n + 2);
+    std::vector<_Dt> knots(2 * n + 6);
+    ctrlpts[0] = vertices[0].vertex;
+    ctrlpts[2 * n + 1] = vertices[n].vertex;
+    for (int j = 0; j < 4; j++)
+    {
+        knots[j] = _Dt(0.0);
+        knots[2 * n + 2 + j] = _Dt(1.0);
+    }
+
+    _Dt total = params[n];
+    parallel_for(0, n, [&](long begin, long end)
+    {
+        for (long k = begin; k < end; k++)
+        {
+            ctrlpts[2 * k + 1] = vertices[k].vertex + tangents[k] * (speed[k] / 3);
+            ctrlpts[2 * k + 2] = vertices[k + 1].vertex - tangents[k + 1] * (speed[k] / 3);
+            if (k > 0)
+            {
+                knots[2 * k + 2] = knots[2 * k + 3] = params[k] / total;
+            }
+        }
+    }, _min_grain);
+
+    if (parameters != nullptr)
+    {
+        parameters->resize(n + 1);
+        for (long k = 0; k < n; k++)
+        {
+            (*parameters)[k] = params[k] / total;
+        }
+        (*parameters)[n] = _Dt(1.0);
+    }
+
+    return _Out_Ct(3, ctrlpts, knots);
+}
+
+std::vector<BSplineCurveInterpolation::_Vt> BSplineCurveInterpolation::_estimate_tangents() const
+{
+    const auto& vertices = _src_curve.get_vertices();
+
+    long n = long(vertices.size()) - 1;
+
+    // q_k = Q_k - Q_{k-1}, extended beyond both ends by Eq. (9.32)
+    auto q = [&vertices, n](long k) -> _Vt
+    {
+        if (n < 2)
+        {
+            return vertices[n].vertex - vertices[0].vertex;
+        }
+        if (k < 1)
+        {
+            _Vt q1 = vertices[1].vertex - vertices[0].vertex, q2 = vertices[2].vertex - vertices[1].vertex;
+            return k == 0 ? 2 * q1 - q2 : 3 * q1 - 2 * q2;
+        }
+        if (k > n)
+        {
+            _Vt qn = vertices[n].vertex - vertices[n - 1].vertex;
+            _Vt qn_1 = vertices[n - 1].vertex - vertices[n - 2].vertex;
+            return k == n + 1 ? 2 * qn - qn_1 : 3 * qn - 2 * qn_1;
+        }
+        return vertices[k].vertex - vertices[k - 1].vertex;
+    };
+
+    std::vector<_Vt> tangents(n + 1);
+    parallel_for(0, n + 1, [&](long begin, long end)
+    {
+        for (long k = begin; k < end; k++)
+        {
+            _Vt q_prev = q(k - 1), q0 = q(k), q1 = q(k + 1), q_next = q(k + 2);
+
+            // at a corner, where the neighbours on one side are collinear, the tangent follows that side
+            _Dt c0 = q_prev.cross(q0).length(), c1 = q1.cross(q_next).length();
+            _Dt alpha = c0 + c1 > 0 ? c0 / (c0 + c1) : _Dt(0.5);
+
+            _Vt v = (1 - alpha) * q0 + alpha * q1;
+            if (!(v.length() > 0))
+            {
+                v = q1.length() > 0 ? q1 : q0;
+            }
+            _Dt length = v.length();
+            tangents[k] = length > 0 ? v / length : v;
+        }
+    }, _min_grain);
+
+    return tangents;
+}
+
+void BSplineCurveInterpolation::_banded_lu_solve(std::vector<_Dt>& rows, const std::vector<int>& first, int width,
+                                                 std::vector<_Vt>& b)
+{
+    int n = int(first.size());
+
+    auto at = [&](int k, int j) -> _Dt& { return rows[std::size_t(k) * width + (j - first[k])]; };
+
+    // Doolittle elimination row by row: the multipliers replace the entries left of the diagonal; a pivot row never
+    // reaches right of the row it reduces, as the rows start at ascending columns with the same width
+    for (int k = 0; k < n; k++)
+    {
+        if (first[k] > k || first[k] + width <= k)
+        {
+            throw std::invalid_argument("the parameters to interpolate do not fit the knot vector.");
+        }
+
+        for (int j = first[k]; j < k; j++)
+        {
+            _Dt l = at(k, j) / at(j, j);
+            at(k, j) = l;
+            for (int c = j + 1, last = first[j] + width; c < last; c++)
+            {
+                at(k, c) -= l * at(j, c);
+            }
+            b[k] -= l * b[j];
+        }
+
+        if (at(k, k) == 0)
+        {
+            throw std::invalid_argument("the collocation matrix is singular, parameters must be distinct.");
+        }
+    }
+
+    // back substitution
+    for (int k = n - 1; k >= 0; k--)
+    {
+        for (int c = k + 1, last = std::min(first[k] + width, n); c < last; c++)
+        {
+            b[k] -= at(k, c) * b[c];
+        }
+        b[k] = b[k] / at(k, k);
+    }
+}
@@ -0,0 +1,74 @@
+//
+// Created by haochuanchen on 18-6-8.
+//
+
+#ifndef B_SPLINE_BSPLINECURVEINTERPOLATION_H
+#define B_SPLINE_BSPLINECURVEINTERPOLATION_H
+
+#include "BSplineCurveFitting_Base.h"
+
+/**
+ * B spline curves passing exactly through the vertices of a curve, cheaper alternatives to least squares fitting with
+ * as many control points as vertices for dense and clean data.
+ * Global interpolation solves the collocation system, banded with bandwidth p, by LU factorization without pivoting,
+ * O(n * p^2). Local cubic interpolation builds every segment from the neighbouring vertices only, O(n) without any
+ * linear solve.
+ */
+class BSplineCurveInterpolation
+{
+public:
+    using _Base = BSplineCurveFitting_Base;
+
+    using _Dt = _Base::_Dt;
+    using _Vt = _Base::_Vt;
+
+    using _In_Pt = _Base::_In_Pt;
+    using _In_Ct = _Base::_In_Ct;
+
+    using _Out_Pt = _Base::_Out_Pt;
+    using _Out_Ct = _Base::_Out_Ct;
+
+public:
+    /// Initial B spline curve interpolation.
+    /// \param curve_to_interpolate a parameterized curve
+    explicit BSplineCurveInterpolation(const _In_Ct& curve_to_interpolate);
+
+    /// Interpolate the vertices at their parameters, with knots averaging the parameters.
+    /// See: *The NURBS Book* Algorithm A9.1
+    /// \param degree degree(order - 1) of the B spline curve, less than the number of vertices
+    /// \return the curve with as many control points as vertices
+    _Out_Ct global_interpolation(int degree = 3) const;
+
+    /// Interpolate the vertices by a C1 cubic B spline of Bezier segments with unit tangent speed at the vertices.
+    /// The tangents are estimated from the neighbouring vertices, so corners are kept. The parameters of the vertices
+    /// are not used, every vertex gets a double knot at its parameter along the curve.
+    /// See: *The NURBS Book* (Sect. 9.3.4)
+    /// \param parameters parameters of the vertices on the cubic curve, may be nullptr
+    /// \return the cubic curve with (2 * number of vertices) control points
+    _Out_Ct local_cubic_interpolation(std::vector<_Dt>* parameters = nullptr) const;
+
+protected:
+    /// Estimate the unit tangents at the vertices by the weighted differences of *The NURBS Book* Eq. (9.31).
+    /// \return the unit tangent at every vertex
+    std::vector<_Vt> _estimate_tangents() const;
+
+    /// Solve A x = b in place, A stored by rows of `width` entries from column `first[k]`, `first` ascending.
+    /// The factorization is Gaussian elimination without pivoting, stable for the totally positive collocation
+    /// matrices of B splines; the fill-in stays within the rows.
+    /// \param rows A, (number of rows * width) entries, overwritten by its LU factors
+    /// \param first column of the first entry of every row
+    /// \param width the number of entries of every row
+    /// \param b right hand side, overwritten by the solution
+    static void _banded_lu_solve(std::vector<_Dt>& rows, const std::vector<int>& first, int width,
+                                 std::vector<_Vt>& b);
+
+protected: // --------- field ---------
+    /// Original discrete curve to interpolate
+    _In_Ct _src_curve;
+
+    /// minimum number of vertices processed by a thread
+    static constexpr long _min_grain = 4096;
+};
+
+
+#endif //B_SPLINE_BSPLINECURVEINTERPOLATION_H
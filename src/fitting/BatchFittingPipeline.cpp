@@ -0,0 +1,262 @@
+//
+// Created by haochuanchen on 18-5-23.
+//
+
+#include "BatchFittingPipeline.h"
+#include "../curve/util/BoundedQueue.h"
+#include "../curve/util/ThreadPool.h"
+
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    long long elapsed_ns(Clock::time_point start)
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+    }
+}
+
+BatchFittingPipeline::BatchFittingPipeline(Fitter fitter, int n_io_thread, int n_compute_thread,
+                                           size_t queue_capacity)
+    : _fitter(std::move(fitter)), _n_io_thread(n_io_thread), _n_compute_thread(n_compute_thread),
+      _queue_capacity(queue_capacity)
+{
+    if (!_fitter)
+    {
+        throw std::invalid_argument("fitter is empty.");
+    }
+    if (n_io_thread < 1 || n_compute_thread < 0 || queue_capacity == 0)
+    {
+        throw std::invalid_argument("pipeline needs at least one I/O thread and a non-empty queue.");
+    }
+    if (_n_compute_thread == 0)
+    {
+        _n_compute_thread = int(ThreadPool::default_thread_count());
+    }
+
+    _parameterizer = [](_In_Ct& curve) { curve.chordal_parameterization(); };
+}
+
+void BatchFittingPipeline::set_parameterizer(Parameterizer parameterizer)
+{
+    _parameterizer = std::move(parameterizer);
+}
+
+void BatchFittingPipeline::set_normalize(bool normalize)
+{
+    _normalize = normalize;
+}
+
+void BatchFittingPipeline::set_consumer(std::function<void(Result&&)> consumer)
+{
+    _consumer = std::move(consumer);
+}
+
+std::vector<BatchFittingPipeline::Result> BatchFittingPipeline::run(const std::vector<QString>& filenames)
+{
+    _n_loaded = 0;
+    _n_vertex = 0;
+    _n_fitted = 0;
+    _n_failed = 0;
+    _load_ns = 0;
+    _load_blocked_ns = 0;
+    _fit_ns = 0;
+    _fit_starved_ns = 0;
+    _wall_ns = 0;
+
+    auto wall_start = Clock::now();
+
+    struct Loaded
+    {
+        size_t index;
+        std::unique_ptr<_In_Ct> curve;
+    };
+
+    BoundedQueue<Loaded> queue(_queue_capacity);
+    std::atomic<size_t> next_file{0};
+
+    std::vector<Result> results;
+    if (!_consumer)
+    {
+        results.resize(filenames.size());
+    }
+
+    // the first exception of the consumer, rethrown when all the threads are joined
+    std::exception_ptr consumer_error;
+    std::mutex consumer_error_mutex;
+
+    auto emit = [&](Result&& result)
+    {
+        if (_consumer)
+        {
+            try
+            {
+                _consumer(std::move(result));
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(consumer_error_mutex);
+                if (!consumer_error)
+                {
+                    consumer_error = std::current_exception();
+                }
+            }
+        }
+        else
+        {
+            // every index is written by one thread only
+            results[result.index] = std::move(result);
+        }
+    };
+
+    auto fail = [&](size_t index, std::string error)
+    {
+        Result result;
+        result.index = index;
+        result.filename = filenames[index];
+        result.error = std::move(error);
+        _n_failed++;
+        emit(std::move(result));
+    };
+
+    // I/O stage: read and parse the files, files are taken in order
+    auto load = [&]
+    {
+        for (size_t index = next_file++; index < filenames.size(); index = next_file++)
+        {
+            auto start = Clock::now();
+            std::unique_ptr<_In_Ct> curve;
+            try
+            {
+                curve = std::make_unique<_In_Ct>();
+                curve->init_from_file(filenames[index], _normalize);
+            }
+            catch (const std::exception& e)
+            {
+                _load_ns += elapsed_ns(start);
+                fail(index, e.what());
+                continue;
+            }
+            catch (...)
+            {
+                _load_ns += elapsed_ns(start);
+                fail(index, "unknown error while reading the curve.");
+                continue;
+            }
+            _load_ns += elapsed_ns(start);
+
+            if (curve->get_vertices().size() < 2)
+            {
+                fail(index, "cannot read the curve.");
+                continue;
+            }
+            _n_loaded++;
+            _n_vertex += curve->get_vertices().size();
+
+            start = Clock::now();
+            queue.push(Loaded{index, std::move(curve)});
+            _load_blocked_ns += elapsed_ns(start);
+        }
+    };
+
+    // compute stage: parameterize and fit
+    auto compute = [&]
+    {
+        Loaded loaded;
+        while (true)
+        {
+            auto start = Clock::now();
+            bool ok = queue.pop(loaded);
+            _fit_starved_ns += elapsed_ns(start);
+            if (!ok)
+            {
+                break;
+            }
+
+            start = Clock::now();
+            Result result;
+            result.index = loaded.index;
+            result.filename = filenames[loaded.index];
+            try
+            {
+                _parameterizer(*loaded.curve);
+                result.curve = _fitter(*loaded.curve);
+                result.ok = true;
+            }
+            catch (const std::exception& e)
+            {
+                result.error = e.what();
+            }
+            catch (...)
+            {
+                result.error = "unknown error while fitting the curve.";
+            }
+            loaded.curve.reset();
+            _fit_ns += elapsed_ns(start);
+
+            if (result.ok)
+            {
+                _n_fitted++;
+                emit(std::move(result));
+            }
+            else
+            {
+                fail(result.index, std::move(result.error));
+            }
+        }
+    };
+
+    std::vector<std::thread> compute_threads;
+    for (int i = 0; i < _n_compute_thread; i++)
+    {
+        compute_threads.emplace_back(compute);
+    }
+
+    std::vector<std::thread> io_threads;
+    for (int i = 0; i < _n_io_thread; i++)
+    {
+        io_threads.emplace_back(load);
+    }
+    for (auto& thread : io_threads)
+    {
+        thread.join();
+    }
+
+    // no more curves, the compute threads finish the queued ones and exit
+    queue.close();
+    for (auto& thread : compute_threads)
+    {
+        thread.join();
+    }
+
+    _wall_ns = elapsed_ns(wall_start);
+
+    if (consumer_error)
+    {
+        std::rethrow_exception(consumer_error);
+    }
+    return results;
+}
+
+BatchFittingPipeline::Statistics BatchFittingPipeline::get_statistics() const
+{
+    const double ns = 1e-9;
+
+    Statistics statistics;
+    statistics.n_loaded = _n_loaded;
+    statistics.n_vertex = _n_vertex;
+    statistics.n_fitted = _n_fitted;
+    statistics.n_failed = _n_failed;
+    statistics.load_seconds = _load_ns * ns;
+    statistics.load_blocked_seconds = _load_blocked_ns * ns;
+    statistics.fit_seconds = _fit_ns * ns;
+    statistics.fit_starved_seconds = _fit_starved_ns * ns;
+    statistics.wall_seconds = _wall_ns * ns;
+    return statistics;
+}
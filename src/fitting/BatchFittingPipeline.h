@@ -0,0 +1,142 @@
+//
+// Created by haochuanchen on 18-5-23.
+//
+
+#ifndef B_SPLINE_BATCHFITTINGPIPELINE_H
+#define B_SPLINE_BATCHFITTINGPIPELINE_H
+
+#include <atomic>
+#include <functional>
+#include <string>
+
+#include "BSplineCurveFitting_Base.h"
+
+/**
+ * Fit many curve files with I/O and computation overlapped.
+ * I/O threads read and parse the files (`init_from_file`) into a bounded queue; compute threads take the curves,
+ * parameterize and fit them. The bounded queue stops the I/O threads from running ahead of the fitting.
+ * Every stage counts its items and its busy/blocked time, see `Statistics`.
+ */
+class BatchFittingPipeline
+{
+public:
+    using _Dt = BSplineCurveFitting_Base::_Dt;
+    using _In_Ct = BSplineCurveFitting_Base::_In_Ct;
+    using _Out_Ct = BSplineCurveFitting_Base::_Out_Ct;
+
+    /// Parameterize a loaded curve, e.g. `chordal_parameterization`.
+    using Parameterizer = std::function<void(_In_Ct&)>;
+    /// Fit a parameterized curve, e.g. with `KTPFitting`.
+    using Fitter = std::function<_Out_Ct(const _In_Ct&)>;
+
+    /// Fitting result of a file.
+    struct Result
+    {
+        /// index of the file in the input list
+        size_t index = 0;
+        QString filename;
+        /// is fitted successfully
+        bool ok = false;
+        /// error message if failed
+        std::string error;
+        _Out_Ct curve;
+    };
+
+    /// Throughput counters of a run.
+    struct Statistics
+    {
+        /// files read
+        size_t n_loaded = 0;
+        /// vertices read
+        size_t n_vertex = 0;
+        /// curves fitted
+        size_t n_fitted = 0;
+        /// files failed to read or fit
+        size_t n_failed = 0;
+
+        /// time spent reading, summed over I/O threads
+        double load_seconds = 0;
+        /// time I/O threads were blocked by a full queue
+        double load_blocked_seconds = 0;
+        /// time spent parameterizing and fitting, summed over compute threads
+        double fit_seconds = 0;
+        /// time compute threads were starved by an empty queue
+        double fit_starved_seconds = 0;
+        /// wall time of the run
+        double wall_seconds = 0;
+
+        /// files per second of an I/O thread while busy
+        double load_throughput() const
+        {
+            return load_seconds > 0 ? n_loaded / load_seconds : 0;
+        }
+
+        /// curves per second of a compute thread while busy
+        double fit_throughput() const
+        {
+            return fit_seconds > 0 ? n_fitted / fit_seconds : 0;
+        }
+
+        /// curves per second of the whole pipeline
+        double overall_throughput() const
+        {
+            return wall_seconds > 0 ? n_fitted / wall_seconds : 0;
+        }
+    };
+
+public:
+    /// Create a pipeline.
+    /// \param fitter fitting of a parameterized curve
+    /// \param n_io_thread the number of threads reading files
+    /// \param n_compute_thread the number of threads fitting, 0 means the number of hardware threads
+    /// \param queue_capacity max number of loaded curves waiting to be fitted
+    explicit BatchFittingPipeline(Fitter fitter, int n_io_thread = 2, int n_compute_thread = 0,
+                                  size_t queue_capacity = 16);
+
+    /// Set the parameterization, chordal by default.
+    /// \param parameterizer the parameterization
+    void set_parameterizer(Parameterizer parameterizer);
+
+    /// Whether to normalize the curves when reading, true by default.
+    /// \param normalize is normalizing
+    void set_normalize(bool normalize);
+
+    /// Receive the results as soon as they are ready instead of collecting them. The consumer is called on the I/O
+    /// threads for the files failing to read, and on the compute threads for the others. If it throws, the other
+    /// results are still delivered, and `run` rethrows the first exception when all the threads have finished.
+    /// \param consumer result consumer, must be thread safe
+    void set_consumer(std::function<void(Result&&)> consumer);
+
+    /// Read and fit the files.
+    /// \param filenames the files
+    /// \return results in the order of `filenames`, empty if a consumer is set
+    std::vector<Result> run(const std::vector<QString>& filenames);
+
+    /// Get the counters of the last run, or the current one if it is running.
+    /// \return counters
+    Statistics get_statistics() const;
+
+private:
+    Fitter _fitter;
+    Parameterizer _parameterizer;
+    std::function<void(Result&&)> _consumer;
+
+    int _n_io_thread;
+    int _n_compute_thread;
+    size_t _queue_capacity;
+    bool _normalize = true;
+
+    // counters, times are in nanoseconds
+    std::atomic<size_t> _n_loaded{0};
+    std::atomic<size_t> _n_vertex{0};
+    std::atomic<size_t> _n_fitted{0};
+    std::atomic<size_t> _n_failed{0};
+    std::atomic<long long> _load_ns{0};
+    std::atomic<long long> _load_blocked_ns{0};
+    std::atomic<long long> _fit_ns{0};
+    std::atomic<long long> _fit_starved_ns{0};
+    std::atomic<long long> _wall_ns{0};
+};
+
+
+#endif //B_SPLINE_BATCHFITTINGPIPELINE_H
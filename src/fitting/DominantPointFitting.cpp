@@ -0,0 +1,128 @@
+//
+// Created by haochuanchen on 18-5-12.
+//
+
+#include "DominantPointFitting.h"
+#include "../curve/util/CurveFeatures.h"
+
+#include <algorithm>
+#include <queue>
+
+std::vector<DominantPointFitting::_Dt> DominantPointFitting::select_knot_vector()
+{
+    const auto& vertices = _src_curve.get_vertices();
+
+    int n = _n;
+    int p = _degree;
+
+    auto dominant = select_dominant_points();
+
+    std::vector<_Dt> knots(n + p + 2);
+
+    // first p + 1 knots: 0.0
+    for (int j = 0; j <= p; j++)
+    {
+        knots[j] = 0.0;
+    }
+
+    // middle knots: average of p adjacent dominant parameters
+    for (int j = 1; j <= n - p; j++)
+    {
+        _Dt sum = 0;
+        for (int i = j; i <= j + p - 1; i++)
+        {
+            sum += vertices[dominant[i]].trait.u;
+        }
+        knots[p + j] = sum / p;
+    }
+
+    // last p + 1 knots: 1.0
+    for (int j = n + 1; j <= n + p + 1; j++)
+    {
+        knots[j] = 1.0;
+    }
+    return knots;
+}
+
+std::vector<int> DominantPointFitting::select_dominant_points() const
+{
+    const auto& vertices = _src_curve.get_vertices();
+
+    int m = vertices.size() - 1;
+
+    if (_n > m)
+    {
+        throw std::invalid_argument("the number of control points is greater than the number of vertices.");
+    }
+
+    auto features = CurveFeatures<_In_Ct>().extract(_src_curve);
+    const auto& angle = features.angle;
+    const auto& feature = features.measure;
+
+    std::vector<char> is_dominant(m + 1, 0);
+    is_dominant[0] = 1;
+    is_dominant[m] = 1;
+    int n_dominant = 2;
+
+    // seeds: sharpest corners, at most half of the dominant points
+    auto corners = features.corners;
+    std::sort(corners.begin(), corners.end(), [&angle](int a, int b) { return angle[a] > angle[b]; });
+
+    int max_seed = (_n + 1) / 2 - 1;
+    for (int i = 0; i < corners.size() && i < max_seed; i++)
+    {
+        is_dominant[corners[i]] = 1;
+        n_dominant++;
+    }
+
+    // refinement: split the interval with the largest feature measure at its feature midpoint
+    using Interval = std::pair<_Dt, std::pair<int, int>>;
+    std::priority_queue<Interval> intervals;
+
+    auto push_interval = [&intervals, &feature](int first, int last)
+    {
+        if (last - first >= 2)
+        {
+            intervals.push(Interval(feature[last] - feature[first], std::make_pair(first, last)));
+        }
+    };
+
+    int last_dominant = 0;
+    for (int k = 1; k <= m; k++)
+    {
+        if (is_dominant[k])
+        {
+            push_interval(last_dominant, k);
+            last_dominant = k;
+        }
+    }
+
+    while (n_dominant < _n + 1 && !intervals.empty())
+    {
+        int first = intervals.top().second.first;
+        int last = intervals.top().second.second;
+        intervals.pop();
+
+        _Dt middle = (feature[first] + feature[last]) / 2;
+        int split = std::lower_bound(feature.begin() + first + 1, feature.begin() + last, middle) - feature.begin();
+        split = std::min(std::max(split, first + 1), last - 1);
+
+        is_dominant[split] = 1;
+        n_dominant++;
+
+        push_interval(first, split);
+        push_interval(split, last);
+    }
+
+    std::vector<int> dominant;
+    dominant.reserve(n_dominant);
+    for (int k = 0; k <= m; k++)
+    {
+        if (is_dominant[k])
+        {
+            dominant.push_back(k);
+        }
+    }
+
+    return dominant;
+}
@@ -0,0 +1,37 @@
+//
+// Created by haochuanchen on 18-5-12.
+//
+
+#ifndef B_SPLINE_DOMINANTPOINTFITTING_H
+#define B_SPLINE_DOMINANTPOINTFITTING_H
+
+#include "BSplineCurveFitting_Base.h"
+
+/**
+ * Fitting with knots placed by dominant points.
+ * Dominant points are seeded at the corners found by `CurveFeatures`, then refined by splitting the interval with the
+ * largest feature measure (share of arc length plus share of turning angle). The knots average the parameters of the
+ * dominant points, so the control points concentrate on the features instead of following the vertex density.
+ * See: Park, H., Lee, J.-H. B-spline curve fitting based on adaptive curve refinement using dominant points. CAD 2007.
+ */
+class DominantPointFitting : public BSplineCurveFitting_Base
+{
+public:
+    using _Base = BSplineCurveFitting_Base;
+
+    using _Dt = _Base::_Dt;
+    using _Vt = _Base::_Vt;
+
+public:
+    using BSplineCurveFitting_Base::BSplineCurveFitting_Base;
+
+    /// Select knots by averaging the parameters of the dominant points.
+    std::vector<_Dt> select_knot_vector() override;
+
+    /// Select (`_n` + 1) dominant points.
+    /// \return ascending indices of the dominant vertices, including both end points
+    std::vector<int> select_dominant_points() const;
+};
+
+
+#endif //B_SPLINE_DOMINANTPOINTFITTING_H
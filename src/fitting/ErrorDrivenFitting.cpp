@@ -0,0 +1,166 @@
+//
+// Created by haochuanchen on 18-5-12.
+//
+
+#include "ErrorDrivenFitting.h"
+#include "../curve/util/BSplineEvaluator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+void ErrorDrivenFitting::set_iteration_count(int n_iteration)
+{
+    _n_iteration = n_iteration;
+}
+
+std::vector<ErrorDrivenFitting::_Dt> ErrorDrivenFitting::select_knot_vector()
+{
+    const auto& vertices = _src_curve.get_vertices();
+
+    auto knots = KTPFitting::select_knot_vector();
+
+    auto best_knots = knots;
+    std::vector<_Dt> best_span_error;
+    _Dt best_error = std::numeric_limits<_Dt>::max();
+    _Dt relaxation = _relaxation;
+
+    for (int iteration = 0; iteration <= _n_iteration; iteration++)
+    {
+        auto control_points = minimum_squared_optimize(knots);
+
+        BSplineEvaluator<_Dt> evaluator(_degree, control_points, knots, 0);
+
+        // max squared error of every knot span
+        std::vector<_Dt> span_error(_n + 1, _Dt(0.0));
+        _Dt max_error = 0;
+        for (const auto& vertex : vertices)
+        {
+            int span = evaluator.find_span(vertex.trait.u);
+            _Dt error = (evaluator.point(span, vertex.trait.u) - vertex.vertex).squared_length();
+            span_error[span] = std::max(span_error[span], error);
+            max_error = std::max(max_error, error);
+        }
+
+        if (max_error < best_error)
+        {
+            best_error = max_error;
+            best_knots = knots;
+            best_span_error = span_error;
+        }
+        else
+        {
+            // overshoot: move from the best knots again, less far
+            relaxation /= 2;
+        }
+
+        if (iteration == _n_iteration)
+        {
+            break;
+        }
+
+        knots = _redistribute(best_knots, best_span_error, relaxation);
+        if (knots.empty())
+        {
+            break;
+        }
+    }
+
+    return best_knots;
+}
+
+std::vector<ErrorDrivenFitting::_Dt>
+ErrorDrivenFitting::_redistribute(const std::vector<_Dt>& knots, const std::vector<_Dt>& span_error,
+                                  _Dt relaxation) const
+{
+    int n = _n;
+    int p = _degree;
+
+    // the error of a span of length h is about c * h^(p + 1), so the knots equidistribute error^(1 / (p + 1)), the
+    // density being constant on every span; a small floor keeps any span from collapsing
+    std::vector<_Dt> measure(n + 1, _Dt(0.0));
+    _Dt total_measure = 0;
+    for (int j = p; j <= n; j++)
+    {
+        measure[j] = std::pow(span_error[j], _Dt(0.5) / (p + 1));
+        total_measure += measure[j];
+    }
+    if (total_measure <= 0)
+    {
+        return std::vector<_Dt>();
+    }
+
+    std::vector<_Dt> cumulative(n + 2, _Dt(0.0));
+    _Dt floor_measure = total_measure / (n - p + 1) * _Dt(0.1);
+    for (int j = p; j <= n; j++)
+    {
+        cumulative[j + 1] = cumulative[j] + measure[j] + floor_measure;
+    }
+    _Dt total = cumulative[n + 1];
+
+    // inverse of the piecewise linear cumulative error
+    std::vector<_Dt> target_knots = knots;
+    int j = p;
+    for (int i = 1; i <= n - p; i++)
+    {
+        _Dt target = total * i / (n - p + 1);
+        while (j < n && cumulative[j + 1] < target)
+        {
+            j++;
+        }
+        _Dt ratio = (target - cumulative[j]) / (cumulative[j + 1] - cumulative[j]);
+        target_knots[p + i] = knots[j] + ratio * (knots[j + 1] - knots[j]);
+    }
+
+    // a weaker relaxation moves the knots less, down to the valid knots of this iteration
+    for (; relaxation > _Dt(1e-3); relaxation /= 2)
+    {
+        std::vector<_Dt> result = knots;
+        for (int i = p + 1; i <= n; i++)
+        {
+            result[i] = (1 - relaxation) * knots[i] + relaxation * target_knots[i];
+        }
+
+        if (_repair(result))
+        {
+            return result;
+        }
+    }
+
+    return std::vector<_Dt>();
+}
+
+bool ErrorDrivenFitting::_repair(std::vector<_Dt>& knots) const
+{
+    const auto& vertices = _src_curve.get_vertices();
+
+    int n = _n;
+    int p = _degree;
+    int m = vertices.size() - 1;
+
+    // every span must contain the parameter of a vertex, otherwise the normal equations are singular: sweep the
+    // inner knots forward, a knot reaching the first vertex of its span moves between that vertex and the next one
+    int k = 0;
+    for (int i = p; i < n; i++)
+    {
+        while (k <= m && vertices[k].trait.u < knots[i])
+        {
+            k++;
+        }
+        if (k >= m)
+        {
+            return false;
+        }
+        if (knots[i + 1] <= vertices[k].trait.u)
+        {
+            knots[i + 1] = (vertices[k].trait.u + vertices[k + 1].trait.u) / 2;
+        }
+    }
+
+    // the last span ends at the last vertex
+    while (k <= m && vertices[k].trait.u < knots[n])
+    {
+        k++;
+    }
+    return k <= m && vertices[k].trait.u < knots[n + 1];
+}
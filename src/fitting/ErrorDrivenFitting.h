@@ -0,0 +1,58 @@
+//
+// Created by haochuanchen on 18-5-12.
+//
+
+#ifndef B_SPLINE_ERRORDRIVENFITTING_H
+#define B_SPLINE_ERRORDRIVENFITTING_H
+
+#include "KTPFitting.h"
+
+/**
+ * Fitting with knots redistributed by the fitting error.
+ * Starting from the KTP knots, the curve is fitted, the error of every knot span is measured, and the inner knots
+ * are moved so that every span holds an equal share of the error. An iteration that does not lower the max error
+ * starts again from the best knots with half the relaxation. The knot vector of the best fit is kept.
+ */
+class ErrorDrivenFitting : public KTPFitting
+{
+public:
+    using _Base = KTPFitting;
+
+    using _Dt = _Base::_Dt;
+    using _Vt = _Base::_Vt;
+
+public:
+    using KTPFitting::KTPFitting;
+
+    /// Set the number of redistribution iterations.
+    /// \param n_iteration the number of iterations
+    void set_iteration_count(int n_iteration);
+
+    /// Select knots by iterative error-driven redistribution.
+    std::vector<_Dt> select_knot_vector() override;
+
+protected:
+    /// Redistribute the inner knots so that every span holds an equal share of `span_error`. The knots leaving a
+    /// span without vertex are repaired, and the relaxation is lowered until the knots are valid.
+    /// \param knots knot vector
+    /// \param span_error max squared error of every knot span, indexed by knot span
+    /// \param relaxation weight of the new knots against the old ones
+    /// \return the new knot vector, empty if there is no error to redistribute
+    std::vector<_Dt> _redistribute(const std::vector<_Dt>& knots, const std::vector<_Dt>& span_error,
+                                   _Dt relaxation) const;
+
+    /// Move the inner knots forward so that every span contains the parameter of a vertex.
+    /// \param knots knot vector, repaired in place
+    /// \return whether the knots are valid
+    bool _repair(std::vector<_Dt>& knots) const;
+
+protected:
+    /// the number of redistribution iterations
+    int _n_iteration = 5;
+
+    /// weight of the new knots against the old ones in the first iteration
+    _Dt _relaxation = 0.5;
+};
+
+
+#endif //B_SPLINE_ERRORDRIVENFITTING_H
@@ -0,0 +1,303 @@
+//
+// Created by haochuanchen on 18-5-8.
+//
+
+#include "SegmentedFitting.h"
+#include "../curve/util/BSplineEvaluator.h"
+#include "../curve/util/CurveFeatures.h"
+#include "../curve/util/Parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+SegmentedFitting::SegmentedFitting(const _In_Ct& curve_to_fit, int degree, int n_control_point, Continuity continuity)
+    : _src_curve(curve_to_fit), _degree(degree), _n_control_point(n_control_point), _continuity(continuity)
+{
+    if (static_cast<int>(continuity) > degree)
+    {
+        throw std::invalid_argument("continuity at the breakpoints is higher than the degree.");
+    }
+}
+
+void SegmentedFitting::set_chunk_size(int n_vertex)
+{
+    if (n_vertex < 2)
+    {
+        throw std::invalid_argument("a segment contains at least 2 vertices.");
+    }
+    _chunk_size = n_vertex;
+}
+
+void SegmentedFitting::set_corner_angle(_Dt angle)
+{
+    _corner_angle = angle;
+}
+
+void SegmentedFitting::set_breakpoints(const std::vector<int>& breakpoints)
+{
+    _breakpoints = breakpoints;
+    std::sort(_breakpoints.begin(), _breakpoints.end());
+    _breakpoints.erase(std::unique(_breakpoints.begin(), _breakpoints.end()), _breakpoints.end());
+}
+
+void SegmentedFitting::set_thread_count(int n_thread)
+{
+    _n_thread = n_thread;
+}
+
+SegmentedFitting::_Out_Ct SegmentedFitting::fitting()
+{
+    const auto& vertices = _src_curve.get_vertices();
+
+    std::vector<char> is_corner;
+    auto breakpoints = segment_breakpoints(is_corner);
+    int n_segment = breakpoints.size() - 1;
+
+    int order = static_cast<int>(_continuity);
+
+    // at least p + 1 control points, and enough freedom for the constraints
+    int min_control_point = std::max(_degree + 1, 2 + 2 * order);
+    auto n_control_points = _distribute_control_points(breakpoints, min_control_point);
+
+    // the derivatives at the smooth joints are taken from a local fit around each of them, so every segment is
+    // fitted once
+    std::vector<std::vector<_Vt>> ders(breakpoints.size());
+    if (order > 0)
+    {
+        parallel_for_chunk(1, n_segment, _chunk_count(n_segment - 1), [&](unsigned, long first, long last)
+        {
+            for (long i = first; i < last; i++)
+            {
+                if (!is_corner[i])
+                {
+                    ders[i] = _joint_derivatives(breakpoints, n_control_points, i);
+                }
+            }
+        });
+    }
+
+    auto segments = _fit_segments(breakpoints, n_control_points, ders);
+
+    // stitch: the segments share their end control points, and the joint knot has multiplicity p
+    std::vector<_Vt> control_points;
+    std::vector<_Dt> knots;
+
+    for (int i = 0; i < n_segment; i++)
+    {
+        const auto& seg_ctrlpts = segments[i].get_control_points();
+        const auto& seg_knots = segments[i].get_knot_vector();
+
+        _Dt u_first = vertices[breakpoints[i]].trait.u;
+        _Dt u_range = vertices[breakpoints[i + 1]].trait.u - u_first;
+
+        // skip the first control point and the first p + 1 knots, they are shared with the last segment
+        int first_knot = i == 0 ? 0 : _degree + 1;
+        int last_knot = i == n_segment - 1 ? int(seg_knots.size()) : int(seg_knots.size()) - 1;
+
+        control_points.insert(control_points.end(), seg_ctrlpts.begin() + (i == 0 ? 0 : 1), seg_ctrlpts.end());
+        for (int k = first_knot; k < last_knot; k++)
+        {
+            knots.push_back(u_first + seg_knots[k] * u_range);
+        }
+    }
+
+    return _Out_Ct(_degree, control_points, knots);
+}
+
+std::vector<int> SegmentedFitting::segment_breakpoints(std::vector<char>& is_corner) const
+{
+    int m = _src_curve.get_vertices().size() - 1;
+
+    std::vector<int> breakpoints{0};
+    is_corner.assign(1, 0);
+
+    if (!_breakpoints.empty())
+    {
+        for (auto b : _breakpoints)
+        {
+            if (b > 0 && b < m)
+            {
+                breakpoints.push_back(b);
+                is_corner.push_back(0);
+            }
+        }
+        breakpoints.push_back(m);
+        is_corner.push_back(0);
+        return breakpoints;
+    }
+
+    // natural breakpoints: the corners, apart enough for a segment of p + 1 control points between them
+    auto features = CurveFeatures<_In_Ct>(_corner_angle).extract(_src_curve);
+    int min_gap = 2 * (_degree + 1);
+
+    std::vector<int> corners{0};
+    for (auto c : features.corners)
+    {
+        if (c - corners.back() >= min_gap && m - c >= min_gap)
+        {
+            corners.push_back(c);
+        }
+    }
+    corners.push_back(m);
+
+    // the pieces between the corners are split into chunks, the last chunk is merged into the previous one if it is
+    // too short
+    for (int i = 0; i + 1 < corners.size(); i++)
+    {
+        for (int b = corners[i] + _chunk_size; b < corners[i + 1] - _chunk_size / 2; b += _chunk_size)
+        {
+            breakpoints.push_back(b);
+            is_corner.push_back(0);
+        }
+        breakpoints.push_back(corners[i + 1]);
+        is_corner.push_back(1);
+    }
+    is_corner.back() = 0;
+
+    return breakpoints;
+}
+
+std::vector<int> SegmentedFitting::_distribute_control_points(const std::vector<int>& breakpoints,
+                                                              int min_control_point) const
+{
+    int m = _src_curve.get_vertices().size() - 1;
+    int n_segment = breakpoints.size() - 1;
+
+    // adjacent segments share a control point
+    int total = _n_control_point + n_segment - 1;
+
+    // largest remainder, so that the shares sum up to the total
+    std::vector<int> counts(n_segment);
+    std::vector<std::pair<_Dt, int>> remainders(n_segment);
+    int assigned = 0;
+    for (int i = 0; i < n_segment; i++)
+    {
+        _Dt share = _Dt(total) * (breakpoints[i + 1] - breakpoints[i]) / m;
+        counts[i] = static_cast<int>(std::floor(share));
+        remainders[i] = std::make_pair(share - counts[i], i);
+        assigned += counts[i];
+    }
+    std::sort(remainders.begin(), remainders.end(), std::greater<std::pair<_Dt, int>>());
+    for (int i = 0; i < total - assigned && i < n_segment; i++)
+    {
+        counts[remainders[i].second]++;
+    }
+
+    for (int i = 0; i < n_segment; i++)
+    {
+        counts[i] = std::max(counts[i], min_control_point);
+        if (counts[i] > breakpoints[i + 1] - breakpoints[i] + 1)
+        {
+            throw std::invalid_argument("too few vertices in a segment for its control points.");
+        }
+    }
+
+    return counts;
+}
+
+std::vector<SegmentedFitting::_Out_Ct> SegmentedFitting::_fit_segments(const std::vector<int>& breakpoints,
+                                                                       const std::vector<int>& n_control_points,
+                                                                       const std::vector<std::vector<_Vt>>& ders) const
+{
+    int n_segment = breakpoints.size() - 1;
+
+    std::vector<_Out_Ct> segments(n_segment);
+    parallel_for_chunk(0, n_segment, _chunk_count(n_segment), [&](unsigned, long first, long last)
+    {
+        for (long i = first; i < last; i++)
+        {
+            segments[i] = _fit_segment(breakpoints[i], breakpoints[i + 1], n_control_points[i], ders[i], ders[i + 1]);
+        }
+    });
+    return segments;
+}
+
+std::vector<SegmentedFitting::_Vt> SegmentedFitting::_joint_derivatives(const std::vector<int>& breakpoints,
+                                                                        const std::vector<int>& n_control_points,
+                                                                        int joint) const
+{
+    const auto& vertices = _src_curve.get_vertices();
+
+    int order = static_cast<int>(_continuity);
+
+    // a window of half the shorter neighbour on both sides, and at least p + 1 vertices, fitted with the density of
+    // control points of the neighbours; the joint is inside the window, where a least squares fit is more accurate
+    // than at its ends
+    int b = breakpoints[joint];
+    int half = std::max(std::min(b - breakpoints[joint - 1], breakpoints[joint + 1] - b) / 2, (_degree + 1) / 2);
+    int n_vertex = breakpoints[joint + 1] - breakpoints[joint - 1];
+    int n_control_point = static_cast<int>(std::lround(
+            _Dt(n_control_points[joint - 1] + n_control_points[joint]) * (2 * half) / n_vertex));
+    n_control_point = std::min(std::max(n_control_point, _degree + 1), 2 * half + 1);
+
+    auto window = _fit_segment(b - half, b + half, n_control_point, {}, {});
+
+    _Dt u_first = vertices[b - half].trait.u;
+    _Dt u_range = vertices[b + half].trait.u - u_first;
+
+    BSplineEvaluator<_Dt> evaluator(window, order);
+    std::vector<_Vt> window_ders(order + 1);
+    evaluator.derivatives((vertices[b].trait.u - u_first) / u_range, order, window_ders.data());
+
+    // d^k C / du^k = d^k C / dt^k / (du / dt)^k
+    std::vector<_Vt> ders;
+    _Dt scale = 1;
+    for (int k = 1; k <= order; k++)
+    {
+        scale *= u_range;
+        ders.push_back(window_ders[k] / scale);
+    }
+    return ders;
+}
+
+unsigned SegmentedFitting::_chunk_count(int n_task) const
+{
+    return _n_thread > 0 ? unsigned(std::min(_n_thread, n_task)) : unsigned(std::max(n_task, 1));
+}
+
+SegmentedFitting::_Out_Ct SegmentedFitting::_fit_segment(int first, int last, int n_control_point,
+                                                         const std::vector<_Vt>& start_ders,
+                                                         const std::vector<_Vt>& end_ders) const
+{
+    const auto& vertices = _src_curve.get_vertices();
+
+    _Dt u_first = vertices[first].trait.u;
+    _Dt u_range = vertices[last].trait.u - u_first;
+
+    if (u_range <= _Dt(0.0))
+    {
+        throw std::logic_error("the segment is degenerated.");
+    }
+
+    // reparameterize the segment to [0, 1]
+    _In_Ct segment;
+    auto& seg_vertices = segment.get_vertices();
+    seg_vertices.reserve(last - first + 1);
+    for (int k = first; k <= last; k++)
+    {
+        seg_vertices.push_back(vertices[k]);
+        seg_vertices.back().trait.u = (vertices[k].trait.u - u_first) / u_range;
+    }
+    seg_vertices.front().trait.u = _Dt(0.0);
+    seg_vertices.back().trait.u = _Dt(1.0);
+
+    KTPFitting fit(segment, _degree, n_control_point);
+
+    // d^k C / dt^k = d^k C / du^k * (du / dt)^k
+    _Dt scale = u_range;
+    for (int k = 0; k < start_ders.size(); k++)
+    {
+        fit.add_derivative_constraint(_Dt(0.0), k + 1, start_ders[k] * scale);
+        scale *= u_range;
+    }
+
+    scale = u_range;
+    for (int k = 0; k < end_ders.size(); k++)
+    {
+        fit.add_derivative_constraint(_Dt(1.0), k + 1, end_ders[k] * scale);
+        scale *= u_range;
+    }
+
+    return fit.fitting();
+}
@@ -0,0 +1,141 @@
+//
+// Created by haochuanchen on 18-5-8.
+//
+
+#ifndef B_SPLINE_SEGMENTEDFITTING_H
+#define B_SPLINE_SEGMENTEDFITTING_H
+
+#include "KTPFitting.h"
+
+/**
+ * Fit a long curve segment by segment.
+ * The curve is split at the given breakpoints, or else at its natural breakpoints, the corners found by
+ * `CurveFeatures`, and the pieces longer than the chunk size are split into chunks. The segments are fitted
+ * concurrently and stitched into one B spline curve with a merged knot vector. The segments share their end points;
+ * at the corners the curve is only C0, elsewhere it is C1/C2: the derivatives at the joints are taken from a local,
+ * unconstrained fit around each joint, and the segments are fitted with them as constraints.
+ */
+class SegmentedFitting
+{
+public:
+    using _Base = BSplineCurveFitting_Base;
+
+    using _Dt = _Base::_Dt;
+    using _Vt = _Base::_Vt;
+
+    using _In_Pt = _Base::_In_Pt;
+    using _In_Ct = _Base::_In_Ct;
+
+    using _Out_Pt = _Base::_Out_Pt;
+    using _Out_Ct = _Base::_Out_Ct;
+
+    /// Continuity of the fitted curve at the breakpoints.
+    enum class Continuity
+    {
+        C0,
+        C1,
+        C2,
+    };
+
+public:
+    /// Initial segmented B spline curve fitting.
+    /// \param curve_to_fit a parameterized curve
+    /// \param degree degree(order - 1) of the B spline curve
+    /// \param n_control_point the number of control points of the fitted curve, distributed among the segments in
+    /// proportion to their number of vertices; more if a segment needs more than its share for the constraints
+    /// \param continuity continuity at the breakpoints except the corners, no more than the degree
+    SegmentedFitting(const _In_Ct& curve_to_fit, int degree, int n_control_point,
+                     Continuity continuity = Continuity::C2);
+
+    /// Split the pieces between the corners into segments of `n_vertex` vertices. Ignored if breakpoints are set.
+    /// \param n_vertex the number of vertices of each segment
+    void set_chunk_size(int n_vertex);
+
+    /// Set the minimum turning angle at a vertex for it to be a corner, where the curve is split with C0 continuity.
+    /// Ignored if breakpoints are set.
+    /// \param angle turning angle in radians, pi or more for no corners
+    void set_corner_angle(_Dt angle);
+
+    /// Split the curve at the given vertices, instead of the corners and chunks.
+    /// \param breakpoints indices of the vertices to split at, the end points are not needed
+    void set_breakpoints(const std::vector<int>& breakpoints);
+
+    /// Set the maximum number of segments fitted at once. The segments are fitted on `ThreadPool::shared()`.
+    /// \param n_thread the number of threads, 0 means as many as the shared pool runs
+    void set_thread_count(int n_thread);
+
+    /// Fit the curve.
+    /// \return get fitted B Spline curve
+    _Out_Ct fitting();
+
+    /// Get the breakpoints, including both end points.
+    /// \param is_corner whether every breakpoint is a corner, to join with C0 continuity
+    /// \return indices of the breakpoint vertices
+    std::vector<int> segment_breakpoints(std::vector<char>& is_corner) const;
+
+protected:
+    /// Distribute the control points among the segments, so that the stitched curve has `_n_control_point`.
+    /// \param breakpoints the breakpoints, including both end points
+    /// \param min_control_point the minimum number of control points of a segment
+    /// \return the number of control points of every segment
+    std::vector<int> _distribute_control_points(const std::vector<int>& breakpoints, int min_control_point) const;
+
+    /// Fit all the segments concurrently.
+    /// \param breakpoints the breakpoints, including both end points
+    /// \param n_control_points the number of control points of every segment
+    /// \param ders derivatives w.r.t. u at every breakpoint, empty if they are free
+    /// \return fitted segments, parameterized on [0, 1]
+    std::vector<_Out_Ct> _fit_segments(const std::vector<int>& breakpoints, const std::vector<int>& n_control_points,
+                                       const std::vector<std::vector<_Vt>>& ders) const;
+
+    /// Estimate the derivatives at a smooth joint from an unconstrained fit of the vertices around it.
+    /// \param breakpoints the breakpoints, including both end points
+    /// \param n_control_points the number of control points of every segment
+    /// \param joint index of the breakpoint, neither end point
+    /// \return derivatives w.r.t. u of order 1 to the continuity at the joint
+    std::vector<_Vt> _joint_derivatives(const std::vector<int>& breakpoints, const std::vector<int>& n_control_points,
+                                        int joint) const;
+
+    /// Get the number of chunks to run `n_task` tasks, no more than the number of threads.
+    /// \param n_task the number of tasks
+    /// \return the number of chunks
+    unsigned _chunk_count(int n_task) const;
+
+    /// Fit vertices [`first`, `last`] of the curve.
+    /// \param first first vertex of the segment
+    /// \param last last vertex of the segment
+    /// \param n_control_point the number of control points of the segment
+    /// \param start_ders derivatives at the start, empty if it is free
+    /// \param end_ders derivatives at the end, empty if it is free
+    /// \return fitted segment, parameterized on [0, 1]
+    _Out_Ct _fit_segment(int first, int last, int n_control_point,
+                         const std::vector<_Vt>& start_ders, const std::vector<_Vt>& end_ders) const;
+
+protected: // --------- field ---------
+    /// Original discrete curve to fit
+    _In_Ct _src_curve;
+
+    /// degree(order - 1) of the B spline
+    int _degree;
+
+    /// the total number of control points
+    int _n_control_point;
+
+    /// continuity at the breakpoints
+    Continuity _continuity;
+
+    /// the number of vertices of each segment
+    int _chunk_size = 100000;
+
+    /// minimum turning angle of a corner, 45 degrees
+    _Dt _corner_angle = _Dt(0.7853981633974483);
+
+    /// user defined breakpoints
+    std::vector<int> _breakpoints;
+
+    /// the maximum number of segments fitted at once, 0 means no limit
+    int _n_thread = 0;
+};
+
+
+#endif //B_SPLINE_SEGMENTEDFITTING_H
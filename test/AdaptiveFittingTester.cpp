@@ -0,0 +1,76 @@
+//
+// Created by haochuanchen on 18-5-15.
+//
+
+#include "../src/fitting/AdaptiveFitting.h"
+#include "../src/fitting/KTPFitting.h"
+#include "TestCurves.h"
+#include <gmock/gmock.h>
+
+#include <cmath>
+
+using namespace testing;
+using namespace std;
+
+namespace
+{
+
+using _Fitting = BSplineCurveFitting_Base;
+using _Ct = _Fitting::_In_Ct;
+using _Dt = _Fitting::_Dt;
+
+TEST(AdaptiveFitting, meets_tolerance)
+{
+    auto curve = make_curve(2001, [](_Dt t)
+    {
+        return t < 0.5 ? Vertex<_Dt>(t, 0.02 * std::sin(40 * t), 0.1 * std::sin(20 * t * t))
+                       : Vertex<_Dt>(0.5, t - 0.5, 0.1 * std::sin(20 * t * t));
+    });
+
+    for (_Dt tolerance : {1e-2, 1e-3, 1e-4})
+    {
+        AdaptiveFitting fitting(curve, 3, tolerance);
+        auto fitted = fitting.fitting();
+        int n_control_point = fitted.get_control_points().size();
+
+        EXPECT_LE(fitting.fitting_error(fitted).max_error, tolerance) << "tolerance = " << tolerance;
+
+        // galloping and bisection both take a logarithmic number of trials
+        EXPECT_LE(fitting.get_trial_count(), 2 * std::log2(n_control_point) + 4) << "tolerance = " << tolerance;
+    }
+}
+
+TEST(AdaptiveFitting, close_to_linear_scan)
+{
+    auto curve = make_curve(2001, [](_Dt t) { return Vertex<_Dt>(std::cos(6 * t), std::sin(6 * t), t); });
+    _Dt tolerance = 1e-4;
+
+    AdaptiveFitting fitting(curve, 3, tolerance);
+    int n_control_point = fitting.fitting().get_control_points().size();
+
+    // the smallest number of uniformly distributed control points meeting the tolerance
+    int n_scan = 4;
+    for (; n_scan < 2001; n_scan++)
+    {
+        KTPFitting ktp(curve, 3, n_scan);
+        if (ktp.fitting_error(ktp.fitting()).max_error <= tolerance)
+        {
+            break;
+        }
+    }
+
+    // the greedy search is an approximate minimum
+    EXPECT_LE(n_control_point, n_scan * 3 / 2);
+}
+
+TEST(AdaptiveFitting, limit)
+{
+    auto curve = make_curve(500, [](_Dt t) { return Vertex<_Dt>(t, std::sin(50 * t), 0); });
+
+    AdaptiveFitting fitting(curve, 3, 1e-12, 20);
+    auto fitted = fitting.fitting();
+    EXPECT_LE(fitted.get_control_points().size(), 20);
+    EXPECT_GT(fitting.fitting_error(fitted).max_error, 1e-12);
+}
+
+}
@@ -0,0 +1,120 @@
+//
+// Created by haochuanchen on 18-4-19.
+//
+
+#include "../src/fitting/KTPFitting.h"
+#include "../src/curve/util/BSplineEvaluator.h"
+#include "TestCurves.h"
+#include <gmock/gmock.h>
+
+#include <algorithm>
+
+using namespace testing;
+using namespace std;
+
+namespace
+{
+
+using _Fitting = BSplineCurveFitting_Base;
+using _Ct = _Fitting::_In_Ct;
+using _Dt = _Fitting::_Dt;
+using _Vt = _Fitting::_Vt;
+
+Vertex<_Dt> shape(_Dt t)
+{
+    return Vertex<_Dt>(std::cos(3 * t), std::sin(5 * t), t * t);
+}
+
+void expect_derivative(const _Fitting::_Out_Ct& fitted, _Dt u, int order, const _Vt& expected)
+{
+    BSplineEvaluator<_Dt> evaluator(fitted, 2);
+    _Vt ders[3];
+    evaluator.derivatives(u, order, ders);
+    EXPECT_NEAR(0, (ders[order] - expected).length(), 1e-8) << "u = " << u << ", order = " << order;
+}
+
+TEST(BSplineCurveFitting_constraint, point_and_derivative)
+{
+    auto curve = make_curve(500, shape);
+
+    KTPFitting fitting(curve, 3, 20);
+    _Vt point(0.5, 0.2, 0.1), tangent(1, -2, 0.5);
+    fitting.add_point_constraint(0.3, point);
+    fitting.add_derivative_constraint(0.6, 1, tangent);
+    fitting.add_derivative_constraint(0.6, 2, _Vt(0, 0, 0));
+
+    auto fitted = fitting.fitting();
+    ASSERT_EQ(20, fitted.get_control_points().size());
+
+    expect_derivative(fitted, 0.3, 0, point);
+    expect_derivative(fitted, 0.6, 1, tangent);
+    expect_derivative(fitted, 0.6, 2, _Vt(0, 0, 0));
+
+    // the end points are still interpolated
+    const auto& vertices = curve.get_vertices();
+    expect_derivative(fitted, 0.0, 0, vertices.front().vertex);
+    expect_derivative(fitted, 1.0, 0, vertices.back().vertex);
+}
+
+TEST(BSplineCurveFitting_constraint, end_derivatives)
+{
+    auto curve = make_curve(500, shape);
+
+    KTPFitting fitting(curve, 3, 30);
+    _Vt start(1, 0, 0), end(0, -1, 2);
+    fitting.set_end_derivatives(1, start, end);
+    fitting.set_end_derivatives(2, _Vt(0, 0, 0), _Vt(0, 0, 0));
+
+    auto fitted = fitting.fitting();
+
+    expect_derivative(fitted, 0.0, 1, start);
+    expect_derivative(fitted, 1.0, 1, end);
+    expect_derivative(fitted, 0.0, 2, _Vt(0, 0, 0));
+    expect_derivative(fitted, 1.0, 2, _Vt(0, 0, 0));
+
+    // away from the constrained ends the fit is still close
+    EXPECT_LT(fitting.fitting_error(fitted).mean_error, 1e-2);
+
+    EXPECT_THROW(fitting.add_derivative_constraint(1.5, 1, start), std::out_of_range);
+    EXPECT_THROW(fitting.add_derivative_constraint(0.5, 4, start), std::invalid_argument);
+}
+
+/// Exposes the least squares solvers.
+class SolverFitting : public KTPFitting
+{
+public:
+    using KTPFitting::KTPFitting;
+    using KTPFitting::minimum_squared_optimize;
+    using KTPFitting::warm_minimum_squared_optimize;
+};
+
+TEST(BSplineCurveFitting_warm, clustered_knots)
+{
+    auto curve = make_curve(5000, shape);
+
+    // knots clustered after 0.5, a few vertices per span, make N^T N ill-conditioned, and a poor guess is far from the solution
+    std::vector<_Dt> knots(4, 0.0);
+    for (int i = 1; i < 20; i++)
+    {
+        knots.push_back(i / 20.0);
+    }
+    for (int i = 1; i < 40; i++)
+    {
+        knots.push_back(0.5 + i * 1e-3);
+    }
+    std::sort(knots.begin(), knots.end());
+    knots.insert(knots.end(), 4, 1.0);
+    int n_control_point = int(knots.size()) - 4;
+
+    SolverFitting fitting(curve, 3, n_control_point);
+    auto direct = fitting.minimum_squared_optimize(knots);
+    auto warm = fitting.warm_minimum_squared_optimize(knots, std::vector<_Vt>(n_control_point, _Vt(0, 0, 0)));
+
+    ASSERT_EQ(direct.size(), warm.size());
+    for (size_t i = 0; i < direct.size(); i++)
+    {
+        EXPECT_NEAR(0, (direct[i] - warm[i]).length(), 1e-6 * (1 + direct[i].length())) << "i = " << i;
+    }
+}
+
+}
@@ -0,0 +1,94 @@
+//
+// Created by haochuanchen on 18-6-8.
+//
+
+#include "../src/fitting/BSplineCurveInterpolation.h"
+#include "../src/curve/util/BSplineEvaluator.h"
+#include "TestCurves.h"
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <memory>
+
+using namespace testing;
+using namespace std;
+
+namespace
+{
+
+using _Interpolation = BSplineCurveInterpolation;
+using _Ct = _Interpolation::_In_Ct;
+using _Dt = _Interpolation::_Dt;
+
+/// A helix, and a corner at the middle.
+Vertex<_Dt> helix_shape(_Dt t)
+{
+    return t < 0.5 ? Vertex<_Dt>(std::cos(6 * t), std::sin(6 * t), t)
+                   : Vertex<_Dt>(std::cos(3), std::sin(3) + t - 0.5, 0.5);
+}
+
+/// Max distance between the vertices and the interpolated curve at `parameters`.
+_Dt max_error(const _Ct& curve, const _Interpolation::_Out_Ct& interpolated, const std::vector<_Dt>& parameters)
+{
+    BSplineEvaluator<_Dt> evaluator(interpolated, 0);
+    const auto& vertices = curve.get_vertices();
+
+    _Dt error = 0;
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+        error = std::max(error, (evaluator.point(parameters[i]) - vertices[i].vertex).length());
+    }
+    return error;
+}
+
+TEST(BSplineCurveInterpolation, global)
+{
+    auto curve = make_curve(1001, helix_shape);
+    std::vector<_Dt> parameters;
+    for (const auto& vertex : curve.get_vertices())
+    {
+        parameters.push_back(vertex.trait.u);
+    }
+
+    for (int degree : {1, 2, 3, 5})
+    {
+        auto interpolated = _Interpolation(curve).global_interpolation(degree);
+        EXPECT_EQ(degree, interpolated.get_degree());
+        EXPECT_EQ(1001, interpolated.get_control_points().size());
+        EXPECT_NEAR(0, max_error(curve, interpolated, parameters), 1e-12) << "degree = " << degree;
+    }
+
+    EXPECT_THROW(_Interpolation(make_curve(3, helix_shape)).global_interpolation(3), std::invalid_argument);
+}
+
+TEST(BSplineCurveInterpolation, local_cubic)
+{
+    auto curve = make_curve(1001, helix_shape);
+
+    std::vector<_Dt> parameters;
+    auto interpolated = _Interpolation(curve).local_cubic_interpolation(&parameters);
+    EXPECT_EQ(3, interpolated.get_degree());
+    EXPECT_EQ(2 * 1001, interpolated.get_control_points().size());
+
+    // the vertices are at the breakpoints, the double knots
+    const auto& knots = interpolated.get_knot_vector();
+    ASSERT_EQ(1001, parameters.size());
+    for (size_t i = 1; i + 1 < parameters.size(); i++)
+    {
+        EXPECT_EQ(2, std::count(knots.begin(), knots.end(), parameters[i])) << "i = " << i;
+    }
+    EXPECT_NEAR(0, max_error(curve, interpolated, parameters), 1e-12);
+}
+
+TEST(BSplineCurveInterpolation, source_is_copied)
+{
+    // the interpolation outlives the curve it was created from
+    std::unique_ptr<_Interpolation> interpolation;
+    {
+        auto curve = make_curve(101, helix_shape);
+        interpolation = std::make_unique<_Interpolation>(curve);
+    }
+    EXPECT_EQ(101, interpolation->global_interpolation().get_control_points().size());
+}
+
+}
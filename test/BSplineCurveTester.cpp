@@ -3,8 +3,11 @@
 //
 
 #include "../src/curve/BSplineCurve.h"
+#include "../src/curve/util/BSplineEvaluator.h"
 #include <gmock/gmock.h>
 
+#include <functional>
+
 using namespace testing;
 using namespace std;
 
@@ -297,4 +300,493 @@ TEST(BSplineCurve_recalculate, control_points_and_knots)
     }
 }
 
-}
\ No newline at end of file
+}
+
+namespace // BSplineCurve knot insertion
+{
+
+TEST(BSplineCurve_insert_knot, shape_unchanged)
+{
+    double ctrlpts_src[][3] ={{ 0,  0,  0},
+                              {-1,  3,  2},
+                              { 3,  3, -2},
+                              { 2, -1,  1},
+                              { 7, -1,  1},
+                              { 6,  2, -1}};
+    using _Dt = double;
+    using _Pt = CurvePoint<_Dt, BSplinePointTrait<_Dt>>;
+
+    std::vector<Vertex<_Dt>> ctrlpts;
+
+    for (int i = 0; i < 6; i++)
+    {
+        ctrlpts.emplace_back(Vector3X<_Dt>(ctrlpts_src[i][0], ctrlpts_src[i][1], ctrlpts_src[i][2]));
+    }
+
+    BSplineCurve<_Pt> origin(3, ctrlpts);
+    BSplineCurve<_Pt> bc(3, ctrlpts);
+
+    bc.insert_knot(0.5);
+    bc.insert_knot(1.0 / 3.0, 2);
+
+    EXPECT_EQ(9, bc.get_control_points().size());
+    EXPECT_EQ(13, bc.get_knot_vector().size());
+
+    EXPECT_THROW(bc.insert_knot(1.0 / 3.0, 1), std::invalid_argument);
+
+    BSplineEvaluator<_Dt> origin_eval(origin);
+    BSplineEvaluator<_Dt> bc_eval(bc);
+
+    for (int i = 0; i <= 100; i++)
+    {
+        _Dt u = 0.01 * i;
+        EXPECT_LT((origin_eval.point(u) - bc_eval.point(u)).length(), 1e-10) << "u = " << u;
+    }
+}
+
+}
+
+namespace // BSplineCurve knot refinement
+{
+
+TEST(BSplineCurve_refine_knot_vector, same_as_insertion)
+{
+    using _Dt = double;
+    using _Pt = CurvePoint<_Dt, BSplinePointTrait<_Dt>>;
+
+    std::vector<Vertex<_Dt>> ctrlpts;
+    for (int i = 0; i < 8; i++)
+    {
+        ctrlpts.emplace_back(Vector3X<_Dt>(i, std::sin(i), std::cos(2 * i)));
+    }
+    BSplineCurve<_Pt> refined(3, ctrlpts), inserted(3, ctrlpts);
+
+    // unsorted, repeated, and an existing knot
+    std::vector<_Dt> new_knots = {0.7, 0.1, 0.45, 0.45, 0.2, 0.93, 0.1};
+    refined.refine_knot_vector(new_knots);
+    for (auto u : new_knots)
+    {
+        inserted.insert_knot(u);
+    }
+
+    ASSERT_EQ(inserted.get_knot_vector(), refined.get_knot_vector());
+    ASSERT_EQ(inserted.get_control_points().size(), refined.get_control_points().size());
+    for (size_t i = 0; i < refined.get_control_points().size(); i++)
+    {
+        EXPECT_NEAR(0, (inserted.get_control_points()[i] - refined.get_control_points()[i]).length(), 1e-12);
+    }
+
+    EXPECT_THROW(refined.refine_knot_vector({0.45, 0.45}), std::invalid_argument);
+    EXPECT_THROW(refined.refine_knot_vector({0.0}), std::out_of_range);
+}
+
+TEST(BSplineCurve_split, halves_match)
+{
+    using _Dt = double;
+    using _Pt = CurvePoint<_Dt, BSplinePointTrait<_Dt>>;
+
+    std::vector<Vertex<_Dt>> ctrlpts;
+    for (int i = 0; i < 8; i++)
+    {
+        ctrlpts.emplace_back(Vector3X<_Dt>(i, std::sin(i), std::cos(2 * i)));
+    }
+    BSplineCurve<_Pt> bc(3, ctrlpts);
+    BSplineEvaluator<_Dt> evaluator(bc);
+
+    // inside a span, and at a knot
+    for (_Dt u : {0.37, bc.get_knot_vector()[5]})
+    {
+        BSplineCurve<_Pt> left, right;
+        bc.split(u, left, right);
+        BSplineEvaluator<_Dt> left_evaluator(left), right_evaluator(right);
+
+        for (int i = 0; i <= 20; i++)
+        {
+            _Dt t = i / 20.0;
+            EXPECT_NEAR(0, (left_evaluator.point(t) - evaluator.point(u * t)).length(), 1e-12) << "u = " << u;
+            EXPECT_NEAR(0, (right_evaluator.point(t) - evaluator.point(u + (1 - u) * t)).length(), 1e-12)
+                << "u = " << u;
+        }
+    }
+}
+
+}
+
+namespace // BSplineCurve knot removal
+{
+
+TEST(BSplineCurve_remove_knot, undo_insertion)
+{
+    double ctrlpts_src[][3] ={{ 0,  0,  0},
+                              {-1,  3,  2},
+                              { 3,  3, -2},
+                              { 2, -1,  1},
+                              { 7, -1,  1},
+                              { 6,  2, -1}};
+    using _Dt = double;
+    using _Pt = CurvePoint<_Dt, BSplinePointTrait<_Dt>>;
+
+    std::vector<Vertex<_Dt>> ctrlpts;
+
+    for (int i = 0; i < 6; i++)
+    {
+        ctrlpts.emplace_back(Vector3X<_Dt>(ctrlpts_src[i][0], ctrlpts_src[i][1], ctrlpts_src[i][2]));
+    }
+
+    BSplineCurve<_Pt> origin(3, ctrlpts);
+    BSplineCurve<_Pt> bc(3, ctrlpts);
+
+    bc.insert_knot(0.5, 2);
+    bc.insert_knot(0.1);
+
+    EXPECT_EQ(2, bc.remove_knot(0.5, 3));
+    EXPECT_EQ(1, bc.remove_knot(0.1));
+    EXPECT_EQ(6, bc.get_control_points().size());
+
+    // original knots are not removable without moving the curve
+    EXPECT_EQ(0, bc.remove_knot(1.0 / 3.0));
+    EXPECT_THROW(bc.remove_knot(0.2), std::invalid_argument);
+
+    for (int i = 0; i < 6; i++)
+    {
+        EXPECT_LT((origin.get_control_points()[i] - bc.get_control_points()[i]).length(), 1e-10) << "i = " << i;
+    }
+}
+
+TEST(BSplineCurve_remove_knot, bounded_deviation)
+{
+    using _Dt = double;
+    using _Pt = CurvePoint<_Dt, BSplinePointTrait<_Dt>>;
+
+    std::vector<Vertex<_Dt>> ctrlpts;
+    for (int i = 0; i < 8; i++)
+    {
+        ctrlpts.emplace_back(Vector3X<_Dt>(i, std::sin(i * 0.7), std::cos(i * 0.3)));
+    }
+
+    BSplineCurve<_Pt> origin(3, ctrlpts);
+    BSplineCurve<_Pt> bc(3, ctrlpts);
+    for (int i = 1; i < 20; i++)
+    {
+        bc.insert_knot(0.05 * i + 0.001);
+    }
+
+    // the inserted knots are exactly removable
+    BSplineCurve<_Pt> exact = bc;
+    exact.remove_knots(1e-9);
+    EXPECT_EQ(8, exact.get_control_points().size());
+
+    const _Dt tolerance = 0.05;
+    _Dt bound = bc.remove_knots(tolerance);
+
+    EXPECT_LE(bound, tolerance);
+    EXPECT_LT(bc.get_control_points().size(), 27u);
+
+    BSplineEvaluator<_Dt> origin_eval(origin);
+    BSplineEvaluator<_Dt> bc_eval(bc);
+    for (int i = 0; i <= 1000; i++)
+    {
+        _Dt u = 0.001 * i;
+        EXPECT_LE((origin_eval.point(u) - bc_eval.point(u)).length(), bound + 1e-10) << "u = " << u;
+    }
+}
+
+}
+
+namespace // BSplineCurve arc length
+{
+
+TEST(BSplineCurve_arc_length, straight_line)
+{
+    using _Dt = double;
+    using _Pt = CurvePoint<_Dt, BSplinePointTrait<_Dt>>;
+
+    // collinear control points spaced unevenly: the speed varies but the length is 10
+    std::vector<Vertex<_Dt>> ctrlpts;
+    for (auto x : {0.0, 0.5, 4.0, 5.0, 9.0, 10.0})
+    {
+        ctrlpts.emplace_back(Vector3X<_Dt>(x, 0, 0));
+    }
+    BSplineCurve<_Pt> bc(3, ctrlpts);
+
+    ArcLengthTable<_Dt> table(bc);
+    EXPECT_NEAR(10, table.length(), 1e-12);
+
+    BSplineEvaluator<_Dt> evaluator(bc);
+    for (int i = 0; i <= 20; i++)
+    {
+        _Dt s = 0.5 * i;
+        _Dt u = table.parameter(s);
+        EXPECT_NEAR(s, evaluator.point(u).x, 1e-10) << "s = " << s;
+        EXPECT_NEAR(s, table.arc_length(u), 1e-10) << "s = " << s;
+    }
+}
+
+TEST(BSplineCurve_arc_length, resample_circle)
+{
+    using _Dt = double;
+    using _Pt = CurvePoint<_Dt, BSplinePointTrait<_Dt>>;
+
+    std::vector<Vertex<_Dt>> ctrlpts;
+    for (int i = 0; i < 12; i++)
+    {
+        _Dt t = 2 * M_PI * i / 11;
+        ctrlpts.emplace_back(Vector3X<_Dt>(std::cos(t) * (1 + 0.3 * (i % 2)), std::sin(t), 0));
+    }
+    BSplineCurve<_Pt> bc(3, ctrlpts);
+
+    ArcLengthTable<_Dt> fine_table(bc, 64);
+    ArcLengthTable<_Dt> table(bc);
+    EXPECT_NEAR(fine_table.length(), table.length(), 1e-6);
+
+    const int count = 1001;
+    bc.resample_by_arclength(count);
+    const auto& vertices = bc.get_vertices();
+    ASSERT_EQ(count, vertices.size());
+    EXPECT_EQ(0, vertices.front().trait.u);
+    EXPECT_EQ(1, vertices.back().trait.u);
+
+    _Dt step = table.length() / (count - 1);
+    for (int i = 0; i < count; i++)
+    {
+        EXPECT_NEAR(step * i, fine_table.arc_length(vertices[i].trait.u), 1e-6) << "i = " << i;
+    }
+}
+
+}
+
+namespace // BSplineCurve Bezier decomposition
+{
+
+TEST(BSplineCurve_decompose_to_bezier, same_shape)
+{
+    using _Dt = double;
+    using _Pt = CurvePoint<_Dt, BSplinePointTrait<_Dt>>;
+
+    std::vector<Vertex<_Dt>> ctrlpts;
+    for (int i = 0; i < 9; i++)
+    {
+        ctrlpts.emplace_back(Vector3X<_Dt>(i, std::sin(i), std::cos(2 * i)));
+    }
+    BSplineCurve<_Pt> bc(3, ctrlpts);
+    // a double knot, so spans of different multiplicities are decomposed
+    bc.insert_knot(bc.get_knot_vector()[5]);
+
+    std::vector<std::vector<Vertex<_Dt>>> segments;
+    std::vector<_Dt> breakpoints;
+    bc.decompose_to_bezier(segments, breakpoints);
+    ASSERT_EQ(6, segments.size());
+    ASSERT_EQ(segments.size() + 1, breakpoints.size());
+
+    BSplineEvaluator<_Dt> evaluator(bc);
+    for (size_t k = 0; k < segments.size(); k++)
+    {
+        ASSERT_EQ(4, segments[k].size());
+        EXPECT_LT(breakpoints[k], breakpoints[k + 1]);
+        for (int i = 0; i <= 10; i++)
+        {
+            // de Casteljau
+            _Dt t = i / 10.0;
+            auto points = segments[k];
+            for (int r = 1; r < 4; r++)
+            {
+                for (int j = 0; j < 4 - r; j++)
+                {
+                    points[j] = (1 - t) * points[j] + t * points[j + 1];
+                }
+            }
+            _Dt u = breakpoints[k] + (breakpoints[k + 1] - breakpoints[k]) * t;
+            EXPECT_NEAR(0, (points[0] - evaluator.point(u)).length(), 1e-12) << "k = " << k << ", t = " << t;
+        }
+    }
+}
+
+}
+
+namespace // BSplineCurve degree elevation and reduction
+{
+
+TEST(BSplineCurve_elevate_degree, same_shape)
+{
+    using _Dt = double;
+    using _Pt = CurvePoint<_Dt, BSplinePointTrait<_Dt>>;
+
+    std::vector<Vertex<_Dt>> ctrlpts;
+    for (int i = 0; i < 9; i++)
+    {
+        ctrlpts.emplace_back(Vector3X<_Dt>(i, std::sin(i), std::cos(2 * i)));
+    }
+    BSplineCurve<_Pt> original(3, ctrlpts);
+    // a double knot
+    original.insert_knot(original.get_knot_vector()[6]);
+
+    BSplineCurve<_Pt> bc(original);
+    bc.elevate_degree(2);
+    EXPECT_EQ(5, bc.get_degree());
+
+    // every inner knot gains multiplicity 2
+    const auto& knots = original.get_knot_vector();
+    const auto& elevated_knots = bc.get_knot_vector();
+    for (auto u : knots)
+    {
+        int s = int(std::count(knots.begin(), knots.end(), u));
+        EXPECT_EQ(s + 2, std::count(elevated_knots.begin(), elevated_knots.end(), u)) << "u = " << u;
+    }
+    EXPECT_EQ(bc.get_control_points().size() + 6, elevated_knots.size());
+
+    BSplineEvaluator<_Dt> expected(original), actual(bc);
+    for (int i = 0; i <= 100; i++)
+    {
+        _Dt u = i / 100.0;
+        EXPECT_NEAR(0, (expected.point(u) - actual.point(u)).length(), 1e-12) << "u = " << u;
+    }
+}
+
+TEST(BSplineCurve_elevate_degree, large_coordinates)
+{
+    using _Dt = double;
+    using _Pt = CurvePoint<_Dt, BSplinePointTrait<_Dt>>;
+
+    // the round-off of the knot removal is far above an absolute tolerance of 1e-9
+    std::vector<Vertex<_Dt>> ctrlpts;
+    for (int i = 0; i < 12; i++)
+    {
+        ctrlpts.emplace_back(Vector3X<_Dt>(1e6 + i * 1e3, 1e6 * std::sin(i), 1e6 * std::cos(2 * i)));
+    }
+    BSplineCurve<_Pt> original(3, ctrlpts);
+
+    BSplineCurve<_Pt> bc(original);
+    bc.elevate_degree();
+    // 9 Bezier segments of degree 4, joined with C2 continuity
+    EXPECT_EQ(21, bc.get_control_points().size());
+
+    BSplineEvaluator<_Dt> expected(original), actual(bc);
+    for (int i = 0; i <= 100; i++)
+    {
+        _Dt u = i / 100.0;
+        EXPECT_NEAR(0, (expected.point(u) - actual.point(u)).length(), 1e-6) << "u = " << u;
+    }
+}
+
+TEST(BSplineCurve_reduce_degree, bounded_deviation)
+{
+    using _Dt = double;
+    using _Pt = CurvePoint<_Dt, BSplinePointTrait<_Dt>>;
+
+    std::vector<Vertex<_Dt>> ctrlpts;
+    for (int i = 0; i < 9; i++)
+    {
+        ctrlpts.emplace_back(Vector3X<_Dt>(i, std::sin(i), std::cos(2 * i)));
+    }
+    BSplineCurve<_Pt> original(3, ctrlpts);
+    BSplineEvaluator<_Dt> expected(original);
+
+    // an elevated curve is reduced back exactly
+    BSplineCurve<_Pt> bc(original);
+    bc.elevate_degree();
+    _Dt error = -1;
+    ASSERT_TRUE(bc.reduce_degree(1e-9, &error));
+    EXPECT_EQ(3, bc.get_degree());
+    EXPECT_EQ(original.get_knot_vector().size(), bc.get_knot_vector().size());
+    EXPECT_LE(error, 1e-9);
+
+    BSplineEvaluator<_Dt> reduced(bc);
+    for (int i = 0; i <= 100; i++)
+    {
+        _Dt u = i / 100.0;
+        EXPECT_NEAR(0, (expected.point(u) - reduced.point(u)).length(), 1e-9) << "u = " << u;
+    }
+
+    // a true cubic is not reduced within a small tolerance, and is reduced within the bound otherwise
+    bc = original;
+    EXPECT_FALSE(bc.reduce_degree(1e-3));
+    EXPECT_EQ(original.get_control_points(), bc.get_control_points());
+
+    ASSERT_TRUE(bc.reduce_degree(1.0, &error));
+    EXPECT_EQ(2, bc.get_degree());
+    EXPECT_LE(error, 1.0);
+
+    BSplineEvaluator<_Dt> quadratic(bc);
+    for (int i = 0; i <= 100; i++)
+    {
+        _Dt u = i / 100.0;
+        EXPECT_LE((expected.point(u) - quadratic.point(u)).length(), error + 1e-12) << "u = " << u;
+    }
+}
+
+}
+
+namespace // BSplineCurve local edit
+{
+
+TEST(BSplineCurve_move_control_point, update_dirty_spans)
+{
+    using _Dt = double;
+    using _Pt = CurvePoint<_Dt, BSplinePointTrait<_Dt>>;
+
+    std::vector<Vertex<_Dt>> ctrlpts;
+    for (int i = 0; i < 200; i++)
+    {
+        ctrlpts.emplace_back(Vector3X<_Dt>(i, std::sin(i), std::cos(2 * i)));
+    }
+    BSplineCurve<_Pt> bc(3, ctrlpts);
+    bc.recalculate_curve(1e-4);
+    auto n_vertex = long(bc.get_vertices().size());
+
+    bc.move_control_point(10, Vector3X<_Dt>(0, 1, 0));
+    bc.move_control_point(12, Vector3X<_Dt>(0, 0, -2));
+    bc.move_control_point(150, Vector3X<_Dt>(3, 0, 0));
+    EXPECT_THROW(bc.move_control_point(200, Vector3X<_Dt>()), std::out_of_range);
+
+    long count = bc.update_curve();
+    EXPECT_GT(count, 0);
+    EXPECT_LT(count, n_vertex / 10);
+    EXPECT_EQ(0, bc.update_curve());
+
+    BSplineCurve<_Pt> expected(3, bc.get_control_points());
+    expected.recalculate_curve(1e-4);
+    ASSERT_EQ(expected.get_vertices().size(), bc.get_vertices().size());
+    for (long k = 0; k < n_vertex; k++)
+    {
+        const auto& a = expected.get_vertices()[k];
+        const auto& b = bc.get_vertices()[k];
+        EXPECT_EQ(a.trait.u, b.trait.u);
+        EXPECT_NEAR(0, (a.vertex - b.vertex).length(), 1e-12) << "k = " << k;
+    }
+}
+
+TEST(BSplineCurve_move_control_point, cleared_by_other_changes)
+{
+    using _Dt = double;
+    using _Pt = CurvePoint<_Dt, BSplinePointTrait<_Dt>>;
+
+    std::vector<Vertex<_Dt>> ctrlpts;
+    for (int i = 0; i < 20; i++)
+    {
+        ctrlpts.emplace_back(Vector3X<_Dt>(i, std::sin(i), std::cos(2 * i)));
+    }
+
+    // the indices of moved control points are stale once the control points, the knots or the degree change
+    std::vector<std::function<void(BSplineCurve<_Pt>&)>> changes = {
+        [&ctrlpts](BSplineCurve<_Pt>& bc) { bc.set_control_points(ctrlpts); },
+        [](BSplineCurve<_Pt>& bc) { bc.set_knot_vector(bc.get_knot_vector()); },
+        [](BSplineCurve<_Pt>& bc) { bc.set_degree(bc.get_degree()); },
+        [](BSplineCurve<_Pt>& bc) { bc.insert_knot(0.55); },
+        [](BSplineCurve<_Pt>& bc) { bc.refine_knot_vector({0.25, 0.55}); },
+        [](BSplineCurve<_Pt>& bc) { EXPECT_GT(bc.remove_knots(1e3), 0); },
+        [](BSplineCurve<_Pt>& bc) { bc.elevate_degree(); },
+        [](BSplineCurve<_Pt>& bc) { EXPECT_TRUE(bc.reduce_degree(1e3)); },
+    };
+
+    for (size_t k = 0; k < changes.size(); k++)
+    {
+        BSplineCurve<_Pt> bc(3, ctrlpts);
+        bc.recalculate_curve(1e-2);
+        bc.move_control_point(19, Vector3X<_Dt>(0, 1, 0));
+
+        changes[k](bc);
+        EXPECT_EQ(0, bc.update_curve()) << "change " << k;
+    }
+}
+
+}
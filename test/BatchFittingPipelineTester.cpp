@@ -0,0 +1,89 @@
+//
+// Created by haochuanchen on 18-5-23.
+//
+
+#include "../src/fitting/BatchFittingPipeline.h"
+#include "../src/fitting/KTPFitting.h"
+#include <gmock/gmock.h>
+
+#include <atomic>
+#include <fstream>
+#include <stdexcept>
+
+using namespace testing;
+using namespace std;
+
+namespace
+{
+
+/// A small open arc.
+QString write_arc(const std::string& name)
+{
+    std::string filename = testing::TempDir() + name;
+    std::ofstream out(filename);
+    for (int i = 0; i < 100; i++)
+    {
+        double t = 3.0 * i / 99;
+        out << "v " << std::cos(t) << " " << std::sin(t) << " 0\n";
+    }
+    return QString::fromStdString(filename);
+}
+
+std::vector<QString> write_arcs(int count)
+{
+    std::vector<QString> filenames;
+    for (int i = 0; i < count; i++)
+    {
+        filenames.push_back(write_arc("pipeline_arc_" + std::to_string(i) + ".obj"));
+    }
+    return filenames;
+}
+
+TEST(BatchFittingPipeline, fitter_exception)
+{
+    auto filenames = write_arcs(6);
+    filenames.push_back(QString::fromStdString(testing::TempDir() + "pipeline_missing.obj"));
+
+    // any exception of the fitter fails its file only
+    BatchFittingPipeline pipeline([](const BatchFittingPipeline::_In_Ct& curve)
+    {
+        if (curve.get_vertices().front().vertex.x > 0)
+        {
+            throw 1;
+        }
+        return KTPFitting(curve, 3, 8).fitting();
+    }, 2, 2, 2);
+    auto results = pipeline.run(filenames);
+
+    ASSERT_EQ(filenames.size(), results.size());
+    for (const auto& result : results)
+    {
+        EXPECT_FALSE(result.ok);
+        EXPECT_FALSE(result.error.empty());
+    }
+    EXPECT_EQ(filenames.size(), pipeline.get_statistics().n_failed);
+}
+
+TEST(BatchFittingPipeline, consumer_exception)
+{
+    auto filenames = write_arcs(8);
+    filenames.push_back(QString::fromStdString(testing::TempDir() + "pipeline_missing.obj"));
+
+    BatchFittingPipeline pipeline([](const BatchFittingPipeline::_In_Ct& curve)
+    {
+        return KTPFitting(curve, 3, 8).fitting();
+    }, 2, 2, 2);
+
+    // the consumer fails on every result, on the I/O threads as well as on the compute threads
+    std::atomic<int> n_consumed(0);
+    pipeline.set_consumer([&n_consumed](BatchFittingPipeline::Result&&)
+    {
+        n_consumed++;
+        throw std::runtime_error("consumer failed.");
+    });
+
+    EXPECT_THROW(pipeline.run(filenames), std::runtime_error);
+    EXPECT_EQ(int(filenames.size()), n_consumed.load());
+}
+
+}
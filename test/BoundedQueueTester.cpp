@@ -0,0 +1,97 @@
+//
+// Created by haochuanchen on 18-5-23.
+//
+
+#include "../src/curve/util/BoundedQueue.h"
+#include <gmock/gmock.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace testing;
+using namespace std;
+
+namespace
+{
+
+TEST(BoundedQueue_test, keep_order)
+{
+    BoundedQueue<int> queue(4);
+    for (int i = 0; i < 4; i++)
+    {
+        EXPECT_TRUE(queue.push(i));
+    }
+    EXPECT_EQ(queue.size(), 4u);
+
+    int item;
+    for (int i = 0; i < 4; i++)
+    {
+        EXPECT_TRUE(queue.pop(item));
+        EXPECT_EQ(item, i);
+    }
+}
+
+TEST(BoundedQueue_test, drain_after_close)
+{
+    BoundedQueue<int> queue(2);
+    queue.push(1);
+    queue.close();
+
+    EXPECT_FALSE(queue.push(2));
+
+    int item;
+    EXPECT_TRUE(queue.pop(item));
+    EXPECT_EQ(item, 1);
+    EXPECT_FALSE(queue.pop(item));
+}
+
+TEST(BoundedQueue_test, producers_and_consumers)
+{
+    const int n_item = 10000;
+    BoundedQueue<int> queue(3);
+
+    std::atomic<long> sum{0};
+    std::atomic<int> count{0};
+    std::vector<std::thread> consumers;
+    for (int i = 0; i < 3; i++)
+    {
+        consumers.emplace_back([&]
+        {
+            int item;
+            while (queue.pop(item))
+            {
+                EXPECT_LE(queue.size(), 3u);
+                sum += item;
+                count++;
+            }
+        });
+    }
+
+    std::vector<std::thread> producers;
+    for (int i = 0; i < 2; i++)
+    {
+        producers.emplace_back([&, i]
+        {
+            for (int j = i; j < n_item; j += 2)
+            {
+                queue.push(j);
+            }
+        });
+    }
+
+    for (auto& thread : producers)
+    {
+        thread.join();
+    }
+    queue.close();
+    for (auto& thread : consumers)
+    {
+        thread.join();
+    }
+
+    EXPECT_EQ(count, n_item);
+    EXPECT_EQ(sum, long(n_item) * (n_item - 1) / 2);
+}
+
+}
@@ -0,0 +1,120 @@
+//
+// Created by haochuanchen on 18-5-19.
+//
+
+#include "../src/curve/BSplineCurve.h"
+#include "../src/curve/io/CurveBinaryIO.h"
+#include <gmock/gmock.h>
+
+#include <fstream>
+
+using namespace testing;
+using namespace std;
+
+namespace
+{
+
+using _Dt = double;
+using _Pt = CurvePoint<_Dt, BSplinePointTrait<_Dt>>;
+
+/// Write a small B spline curve, then let `modify` change its header.
+template <typename _Func>
+QString write_with_header(const std::string& name, _Func modify)
+{
+    BSplineCurve<_Pt> origin(2, {Vertex<_Dt>(0, 0, 0), Vertex<_Dt>(1, 1, 0), Vertex<_Dt>(2, 0, 0)});
+    origin.recalculate_curve(0.1);
+
+    std::string filename = testing::TempDir() + name;
+    CurveBinaryIO<_Dt>::write(QString::fromStdString(filename), origin);
+
+    std::fstream file(filename, std::ios::in | std::ios::out | std::ios::binary);
+    CurveBinaryHeader header;
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    modify(header);
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    return QString::fromStdString(filename);
+}
+
+TEST(CurveBinaryIO, b_spline_round_trip)
+{
+    std::vector<Vertex<_Dt>> ctrlpts = {Vertex<_Dt>(0, 0, 0), Vertex<_Dt>(-1, 3, 2), Vertex<_Dt>(3, 3, -2),
+                                        Vertex<_Dt>(2, -1, 1), Vertex<_Dt>(7, -1, 1), Vertex<_Dt>(6, 2, -1)};
+    std::vector<_Dt> knots = {1.0, 1.0, 1.0, 1.0, 2.0, 5.0, 8.0, 8.0, 8.0, 8.0};
+
+    BSplineCurve<_Pt> origin(3, ctrlpts, knots);
+    origin.recalculate_curve(0.1);
+
+    QString filename = QString::fromStdString(testing::TempDir() + "b_spline_round_trip.bsc");
+    ASSERT_TRUE(CurveBinaryIO<_Dt>::write(filename, origin));
+
+    CurveBinaryIO<_Dt> io;
+    ASSERT_TRUE(io.open(filename));
+
+    const auto& view = io.get_view();
+    EXPECT_EQ(11, view.n_vertex);
+    EXPECT_EQ(3, view.degree);
+    EXPECT_EQ(10, view.n_knot);
+    EXPECT_EQ(6, view.n_ctrlpt);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(view.y) % alignof(_Dt));
+
+    BSplineCurve<_Pt> loaded;
+    io.load(loaded);
+
+    EXPECT_EQ(origin.get_degree(), loaded.get_degree());
+    EXPECT_EQ(origin.get_knot_vector(), loaded.get_knot_vector());
+    EXPECT_EQ(origin.get_control_points(), loaded.get_control_points());
+
+    const auto& a = origin.get_vertices();
+    const auto& b = loaded.get_vertices();
+    ASSERT_EQ(a.size(), b.size());
+    for (int i = 0; i < a.size(); i++)
+    {
+        EXPECT_EQ(a[i].vertex, b[i].vertex);
+        EXPECT_EQ(a[i].trait.u, b[i].trait.u);
+        EXPECT_EQ(a[i].trait.span, b[i].trait.span);
+    }
+}
+
+TEST(CurveBinaryIO, reject_other_scalar)
+{
+    BSplineCurve<_Pt> origin(2, {Vertex<_Dt>(0, 0, 0), Vertex<_Dt>(1, 1, 0), Vertex<_Dt>(2, 0, 0)});
+
+    QString filename = QString::fromStdString(testing::TempDir() + "reject_other_scalar.bsc");
+    ASSERT_TRUE(CurveBinaryIO<_Dt>::write(filename, origin));
+
+    CurveBinaryIO<float> io;
+    EXPECT_FALSE(io.open(filename));
+}
+
+TEST(CurveBinaryIO, reject_corrupt_header)
+{
+    CurveBinaryIO<_Dt> io;
+    EXPECT_TRUE(io.open(write_with_header("unchanged.bsc", [](CurveBinaryHeader&) {})));
+
+    // n_vertex * sizeof(double) wraps around to 0
+    EXPECT_FALSE(io.open(write_with_header("overflow.bsc", [](CurveBinaryHeader& header)
+    {
+        header.n_vertex = uint64_t(1) << 61;
+    })));
+    EXPECT_FALSE(io.open(write_with_header("too_many_vertices.bsc", [](CurveBinaryHeader& header)
+    {
+        header.n_vertex += 100;
+    })));
+    EXPECT_FALSE(io.open(write_with_header("knot_count.bsc", [](CurveBinaryHeader& header)
+    {
+        header.n_knot--;
+    })));
+    EXPECT_FALSE(io.open(write_with_header("no_control_point.bsc", [](CurveBinaryHeader& header)
+    {
+        header.n_knot = header.degree + 1;
+        header.n_ctrlpt = 0;
+    })));
+    EXPECT_FALSE(io.open(write_with_header("negative_degree.bsc", [](CurveBinaryHeader& header)
+    {
+        header.degree = -1;
+    })));
+}
+
+}
@@ -0,0 +1,133 @@
+//
+// Created by haochuanchen on 18-5-24.
+//
+
+#include "../src/curve/io/CurveCompactCodec.h"
+#include <gmock/gmock.h>
+
+using namespace testing;
+using namespace std;
+
+namespace
+{
+
+using _Dt = double;
+using _Pt = CurvePoint<_Dt, BSplinePointTrait<_Dt>>;
+using _Ct = BSplineCurve<_Pt>;
+
+_Ct make_curve()
+{
+    std::vector<Vertex<_Dt>> ctrlpts;
+    for (int i = 0; i < 12; i++)
+    {
+        ctrlpts.emplace_back(Vector3X<_Dt>(std::cos(i * 0.5), std::sin(i * 0.5), i * 0.1));
+    }
+
+    _Ct curve(3, ctrlpts);
+    // redundant knots, as a fitting may leave
+    for (int i = 1; i < 10; i++)
+    {
+        curve.insert_knot(0.1 * i + 0.01);
+    }
+    return curve;
+}
+
+_Dt max_deviation(const _Ct& a, const _Ct& b)
+{
+    BSplineEvaluator<_Dt> a_eval(a);
+    BSplineEvaluator<_Dt> b_eval(b);
+
+    _Dt max_error = 0;
+    for (int i = 0; i <= 2000; i++)
+    {
+        _Dt u = i / 2000.0;
+        max_error = std::max(max_error, (a_eval.point(u) - b_eval.point(u)).length());
+    }
+    return max_error;
+}
+
+/// An encoded curve with the given counts, knots 0, ..., 0, 1, ..., 1 and control points at the origin.
+std::vector<uint8_t> make_encoded(int degree, int n_knot, int n_ctrlpt)
+{
+    std::vector<uint8_t> data = {'B', 'S', 'C', 'C', CurveCompactCodec<_Dt>::VERSION, uint8_t(degree), 8, 0};
+    data.insert(data.end(), 16, 0);
+    data.push_back(uint8_t(n_knot));
+    data.push_back(uint8_t(n_ctrlpt));
+    for (int i = 0; i < n_knot; i++)
+    {
+        data.push_back(i == n_knot / 2 ? 1 : 0);
+    }
+    data.insert(data.end(), 3 * n_ctrlpt, 0);
+    return data;
+}
+
+TEST(CurveCompactCodec_test, error_bound)
+{
+    auto curve = make_curve();
+
+    for (_Dt tolerance : {1e-2, 1e-4, 1e-6})
+    {
+        auto data = CurveCompactCodec<_Dt>::encode(curve, tolerance);
+
+        CurveCompactCodec<_Dt>::Info info;
+        ASSERT_TRUE(CurveCompactCodec<_Dt>::read_info(data.data(), data.size(), info));
+        EXPECT_EQ(3, info.degree);
+        EXPECT_LE(info.error_bound, tolerance);
+        // the inserted knots are removed
+        EXPECT_LE(info.n_ctrlpt, 12u);
+
+        _Ct decoded;
+        ASSERT_TRUE(CurveCompactCodec<_Dt>::decode(data.data(), data.size(), decoded));
+        EXPECT_EQ(info.n_ctrlpt, decoded.get_control_points().size());
+        EXPECT_EQ(info.n_knot, decoded.get_knot_vector().size());
+        EXPECT_LE(max_deviation(curve, decoded), info.error_bound) << "tolerance = " << tolerance;
+
+        // much smaller than raw doubles
+        EXPECT_LT(data.size(), curve.get_control_points().size() * 3 * sizeof(_Dt) / 2);
+    }
+}
+
+TEST(CurveCompactCodec_test, coarse_knots)
+{
+    // the knot quantization takes a large share of the tolerance, its bound must still hold between the samples
+    auto curve = make_curve();
+
+    for (int knot_bits : {10, 12, 16})
+    {
+        auto data = CurveCompactCodec<_Dt>::encode(curve, 1e-2, knot_bits);
+
+        CurveCompactCodec<_Dt>::Info info;
+        ASSERT_TRUE(CurveCompactCodec<_Dt>::read_info(data.data(), data.size(), info));
+        EXPECT_LE(info.error_bound, 1e-2);
+
+        _Ct decoded;
+        ASSERT_TRUE(CurveCompactCodec<_Dt>::decode(data.data(), data.size(), decoded));
+        EXPECT_LE(max_deviation(curve, decoded), info.error_bound) << "knot bits = " << knot_bits;
+    }
+}
+
+TEST(CurveCompactCodec_test, reject_bad_data)
+{
+    auto data = CurveCompactCodec<_Dt>::encode(make_curve(), 1e-4);
+
+    _Ct decoded;
+    EXPECT_FALSE(CurveCompactCodec<_Dt>::decode(data.data(), data.size() - 1, decoded));
+    EXPECT_FALSE(CurveCompactCodec<_Dt>::decode(data.data(), 10, decoded));
+
+    data[0] = 'X';
+    EXPECT_FALSE(CurveCompactCodec<_Dt>::decode(data.data(), data.size(), decoded));
+
+    // the counts must agree with the degree
+    auto valid = make_encoded(1, 4, 2);
+    EXPECT_TRUE(CurveCompactCodec<_Dt>::decode(valid.data(), valid.size(), decoded));
+    for (auto counts : std::vector<std::vector<int>>{{3, 5, 1}, {0, 2, 2}, {3, 0, 0}, {2, 5, 3}, {2, 7, 3}})
+    {
+        auto bad = make_encoded(counts[0], counts[1], counts[2]);
+        EXPECT_FALSE(CurveCompactCodec<_Dt>::decode(bad.data(), bad.size(), decoded))
+                    << "degree " << counts[0] << ", " << counts[1] << " knots, " << counts[2] << " control points";
+    }
+
+    EXPECT_THROW(CurveCompactCodec<_Dt>::encode(make_curve(), 0), std::invalid_argument);
+}
+
+}
@@ -0,0 +1,127 @@
+//
+// Created by haochuanchen on 18-5-10.
+//
+
+#include "../src/curve/util/CurveDecimation.h"
+#include "TestCurves.h"
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <string>
+
+using namespace testing;
+using namespace std;
+
+namespace
+{
+
+using _Dt = double;
+using _Pt = CurvePoint<_Dt, ParaPointTrait<_Dt>>;
+using _Ct = ParaCurve<_Pt>;
+
+/// Two straight runs with a corner at t = 0.5.
+Vertex<_Dt> polyline_shape(_Dt t)
+{
+    return t < 0.5 ? Vertex<_Dt>(t, 0, 0) : Vertex<_Dt>(0.5, t - 0.5, 0);
+}
+
+TEST(CurveDecimation, straight_runs)
+{
+    auto curve = make_uniform_curve(1001, polyline_shape);
+
+    auto indices = CurveDecimation<_Ct>(1e-6).select(curve);
+
+    ASSERT_EQ(3, indices.size());
+    EXPECT_EQ(0, indices[0]);
+    EXPECT_EQ(500, indices[1]);
+    EXPECT_EQ(1000, indices[2]);
+}
+
+TEST(CurveDecimation, max_gap)
+{
+    auto curve = make_uniform_curve(1001, polyline_shape);
+
+    auto decimated = CurveDecimation<_Ct>(1e-6, 0.1).decimate(curve);
+    const auto& vertices = decimated.get_vertices();
+
+    EXPECT_EQ(curve.get_vertices().front().trait.u, vertices.front().trait.u);
+    EXPECT_EQ(curve.get_vertices().back().trait.u, vertices.back().trait.u);
+
+    for (int i = 1; i < vertices.size(); i++)
+    {
+        EXPECT_LE((vertices[i].vertex - vertices[i - 1].vertex).length(), 0.1 + 1e-12);
+        EXPECT_LT(vertices[i - 1].trait.u, vertices[i].trait.u);
+    }
+    EXPECT_LT(vertices.size(), 30);
+}
+
+TEST(CurveDecimation, chunks)
+{
+    const int n_vertex = 20001;
+    auto curve = make_uniform_curve(n_vertex, [](_Dt t) { return Vertex<_Dt>(t, 0.1 * std::sin(30 * t), 0); });
+    const auto& vertices = curve.get_vertices();
+
+    _Dt tolerance = 1e-4;
+    CurveDecimation<_Ct> decimation(tolerance);
+    decimation.set_min_grain(1000);
+    auto indices = decimation.select(curve);
+
+    // the first vertex of every chunk is kept
+    unsigned n_chunk = parallel_chunk_count(n_vertex - 1, 1000);
+    for (unsigned i = 1; i < n_chunk; i++)
+    {
+        long boundary = long(n_vertex - 1) * i / n_chunk;
+        EXPECT_TRUE(std::binary_search(indices.begin(), indices.end(), boundary)) << "chunk " << i;
+    }
+
+    // every dropped vertex is within the tolerance of the polyline of the kept ones
+    _Dt max_error = 0;
+    for (int k = 1; k < indices.size(); k++)
+    {
+        auto a = vertices[indices[k - 1]].vertex;
+        auto ab = vertices[indices[k]].vertex - a;
+        for (int i = indices[k - 1] + 1; i < indices[k]; i++)
+        {
+            auto ap = vertices[i].vertex - a;
+            _Dt t = std::min(std::max(ap.dot(ab) / ab.squared_length(), _Dt(0.0)), _Dt(1.0));
+            max_error = std::max(max_error, (ap - ab * t).length());
+        }
+    }
+    EXPECT_LE(max_error, tolerance);
+    EXPECT_LT(indices.size(), n_vertex / 10);
+
+    EXPECT_THROW(decimation.set_min_grain(1), std::invalid_argument);
+}
+
+TEST(CurveDecimation, keeps_properties)
+{
+    // a closed circle, read from a file to be normalized and periodic
+    std::string filename = testing::TempDir() + "decimation_circle.obj";
+    {
+        std::ofstream out(filename);
+        for (int i = 0; i < 1000; i++)
+        {
+            _Dt t = 2 * std::acos(-1.0) * i / 1000;
+            out << "v " << 3 + 2 * std::cos(t) << " " << 2 * std::sin(t) << " 1\n";
+        }
+    }
+
+    _Ct curve;
+    curve.init_from_file(QString::fromStdString(filename));
+    curve.centripetal_parameterization();
+    ASSERT_TRUE(curve.is_periodic());
+
+    auto decimated = CurveDecimation<_Ct>(1e-3).decimate(curve);
+
+    EXPECT_LT(decimated.get_vertices().size(), curve.get_vertices().size());
+    EXPECT_TRUE(decimated.is_periodic());
+    EXPECT_EQ(ParameterizationMethod::CENTRIPETAL, decimated.set_para_type());
+    EXPECT_EQ(curve.get_normalize_transform().scale, decimated.get_normalize_transform().scale);
+    EXPECT_EQ(curve.get_normalize_transform().center.x, decimated.get_normalize_transform().center.x);
+    EXPECT_EQ(curve.get_bound_box().x_min, decimated.get_bound_box().x_min);
+    EXPECT_EQ(curve.get_bound_box().y_max, decimated.get_bound_box().y_max);
+}
+
+}
@@ -0,0 +1,115 @@
+//
+// Created by haochuanchen on 18-6-6.
+//
+
+#include "../src/curve/BSplineCurve.h"
+#include "../src/curve/util/CurveDifferential.h"
+#include <gmock/gmock.h>
+
+using namespace testing;
+using namespace std;
+
+namespace
+{
+
+using _Dt = double;
+using _Pt = CurvePoint<_Dt, BSplinePointTrait<_Dt>>;
+using _Vt = Vector3X<_Dt>;
+
+/// The twisted cubic C(u) = (u, u^2, u^3) on [0, 1] as a Bezier curve.
+BSplineCurve<_Pt> make_twisted_cubic()
+{
+    std::vector<Vertex<_Dt>> ctrlpts = {_Vt(0, 0, 0), _Vt(1.0 / 3, 0, 0), _Vt(2.0 / 3, 1.0 / 3, 0), _Vt(1, 1, 1)};
+    return BSplineCurve<_Pt>(3, ctrlpts, {0, 0, 0, 0, 1, 1, 1, 1});
+}
+
+std::vector<_Dt> make_parameters(int count)
+{
+    std::vector<_Dt> parameters;
+    for (int i = 0; i < count; i++)
+    {
+        parameters.push_back(_Dt(i) / (count - 1));
+    }
+    return parameters;
+}
+
+void expect_orthonormal(const CurveDifferential<_Dt>::Frames& frames, size_t i)
+{
+    _Vt t = frames.tangent[i], n = frames.normal[i], b = frames.binormal[i];
+    EXPECT_NEAR(1, t.length(), 1e-12);
+    EXPECT_NEAR(1, n.length(), 1e-12);
+    EXPECT_NEAR(0, t.dot(n), 1e-12);
+    EXPECT_NEAR(0, (t.cross(n) - b).length(), 1e-12);
+}
+
+TEST(CurveDifferential_profile, twisted_cubic)
+{
+    auto curve = make_twisted_cubic();
+    CurveDifferential<_Dt> differential(curve);
+
+    auto parameters = make_parameters(101);
+    auto profile = differential.curvature_profile(parameters);
+    ASSERT_EQ(parameters.size(), profile.curvature.size());
+
+    for (size_t i = 0; i < parameters.size(); i++)
+    {
+        _Dt u = parameters[i];
+        _Vt d1(1, 2 * u, 3 * u * u), cross(6 * u * u, -6 * u, 2);
+        EXPECT_NEAR(cross.length() / std::pow(d1.length(), 3), profile.curvature[i], 1e-12) << "u = " << u;
+        EXPECT_NEAR(12 / cross.squared_length(), profile.torsion[i], 1e-12) << "u = " << u;
+    }
+}
+
+TEST(CurveDifferential_frames, frenet)
+{
+    auto curve = make_twisted_cubic();
+    CurveDifferential<_Dt> differential(curve);
+
+    auto parameters = make_parameters(51);
+    auto frames = differential.frenet_frames(parameters);
+    for (size_t i = 0; i < parameters.size(); i++)
+    {
+        _Dt u = parameters[i];
+        expect_orthonormal(frames, i);
+        EXPECT_NEAR(0, (frames.point[i] - _Vt(u, u * u, u * u * u)).length(), 1e-12);
+
+        _Vt cross(6 * u * u, -6 * u, 2);
+        EXPECT_NEAR(0, (frames.binormal[i] - cross / cross.length()).length(), 1e-12) << "u = " << u;
+    }
+}
+
+TEST(CurveDifferential_frames, rotation_minimizing)
+{
+    // a planar wave: rotation minimizing normals stay the normal of the plane, Frenet normals flip at inflections
+    std::vector<Vertex<_Dt>> ctrlpts;
+    for (int i = 0; i < 10; i++)
+    {
+        ctrlpts.emplace_back(_Vt(i, std::sin(i * 1.3), 0));
+    }
+    BSplineCurve<_Pt> wave(3, ctrlpts);
+    CurveDifferential<_Dt> differential(wave);
+
+    auto parameters = make_parameters(2001);
+    auto frames = differential.rotation_minimizing_frames(parameters, _Vt(0, 0, 1));
+    for (size_t i = 0; i < parameters.size(); i++)
+    {
+        expect_orthonormal(frames, i);
+        EXPECT_NEAR(0, (frames.normal[i] - _Vt(0, 0, 1)).length(), 1e-9) << "i = " << i;
+    }
+
+    // on the twisted cubic, the frames rotate about the tangent no more than the discretization error
+    auto cubic = make_twisted_cubic();
+    CurveDifferential<_Dt> cubic_differential(cubic);
+    auto cubic_frames = cubic_differential.rotation_minimizing_frames(parameters);
+    _Dt max_twist = 0;
+    for (size_t i = 0; i + 1 < parameters.size(); i++)
+    {
+        expect_orthonormal(cubic_frames, i);
+        // angular velocity about the tangent: dr . b
+        _Dt twist = (cubic_frames.normal[i + 1] - cubic_frames.normal[i]).dot(cubic_frames.binormal[i]);
+        max_twist = std::max(max_twist, std::abs(twist));
+    }
+    EXPECT_LT(max_twist, 1e-6);
+}
+
+}
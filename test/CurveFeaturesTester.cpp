@@ -0,0 +1,69 @@
+//
+// Created by haochuanchen on 18-6-7.
+//
+
+#include "../src/curve/util/CurveFeatures.h"
+#include "TestCurves.h"
+#include <gmock/gmock.h>
+
+using namespace testing;
+using namespace std;
+
+namespace
+{
+
+using _Dt = double;
+using _Pt = CurvePoint<_Dt, ParaPointTrait<_Dt>>;
+using _Ct = ParaCurve<_Pt>;
+
+TEST(CurveFeatures, corner)
+{
+    // two straight runs with a corner at t = 0.5
+    auto curve = make_uniform_curve(1001, [](_Dt t)
+    {
+        return t < 0.5 ? Vertex<_Dt>(t, 0, 0) : Vertex<_Dt>(0.5, t - 0.5, 0);
+    });
+
+    auto features = CurveFeatures<_Ct>().extract(curve);
+
+    ASSERT_EQ(1001, features.size());
+    EXPECT_NEAR(1.0, features.total_length, 1e-12);
+    EXPECT_NEAR(std::acos(-1.0) / 2, features.total_angle, 1e-12);
+    EXPECT_THAT(features.corners, ElementsAre(500));
+    EXPECT_TRUE(features.inflections.empty());
+    EXPECT_NEAR(2.0, features.measure.back(), 1e-12);
+
+    // half of the feature measure is at the corner, so are nearly half of the selected vertices
+    auto selected = features.distribute(11);
+    ASSERT_EQ(11, selected.size());
+    EXPECT_EQ(0, selected.front());
+    EXPECT_EQ(1000, selected.back());
+    EXPECT_GE(std::count_if(selected.begin(), selected.end(), [](int k) { return std::abs(k - 500) <= 5; }), 4);
+
+    // a corner sharper than the threshold only
+    EXPECT_TRUE(CurveFeatures<_Ct>(2.0).extract(curve).corners.empty());
+}
+
+TEST(CurveFeatures, curvature_and_inflections)
+{
+    const _Dt pi = std::acos(-1.0);
+
+    // circle of radius 2
+    auto circle = make_uniform_curve(2001, [pi](_Dt t) { return Vertex<_Dt>(2 * std::cos(pi * t), 2 * std::sin(pi * t), 0); });
+    auto circle_features = CurveFeatures<_Ct>().extract(circle);
+    for (int k = 1; k < 2000; k++)
+    {
+        EXPECT_NEAR(0.5, circle_features.curvature[k], 1e-6) << "k = " << k;
+    }
+    EXPECT_TRUE(circle_features.inflections.empty());
+
+    // sine wave, the curvature changes sign at x = pi, 2 pi
+    auto wave = make_uniform_curve(3000, [pi](_Dt t) { return Vertex<_Dt>(3 * pi * t, std::sin(3 * pi * t), 0); });
+    const auto& vertices = wave.get_vertices();
+    auto wave_features = CurveFeatures<_Ct>().extract(wave);
+    ASSERT_EQ(2, wave_features.inflections.size());
+    EXPECT_NEAR(pi, vertices[wave_features.inflections[0]].vertex.x, 1e-2);
+    EXPECT_NEAR(2 * pi, vertices[wave_features.inflections[1]].vertex.x, 1e-2);
+}
+
+}
@@ -0,0 +1,97 @@
+//
+// Created by haochuanchen on 18-5-17.
+//
+
+#include "../src/curve/ParaCurve.h"
+#include <gmock/gmock.h>
+
+#include <string>
+
+using namespace testing;
+using namespace std;
+
+namespace
+{
+
+using _Dt = double;
+using _Pt = CurvePoint<_Dt, ParaPointTrait<_Dt>>;
+
+TEST(CurveIO_parse, separators)
+{
+    std::string text = "# comment\n"
+                       "v 1 2 3\n"
+                       "v\t4.5\t-5e-1  +6\r\n"
+                       "   v   7   8   9   \n"
+                       "vn 1 0 0\n"
+                       "vt 0.5 0.5\n"
+                       "v 1 2\n"
+                       "l 1 2 3\n"
+                       "v -1.25 0 1e3";
+
+    std::vector<_Pt> vertices;
+    CurveIO<_Pt>::parse_vertices(text.data(), text.data() + text.size(), vertices);
+
+    ASSERT_EQ(4, vertices.size());
+
+    EXPECT_DOUBLE_EQ(1.0, vertices[0].vertex.x);
+    EXPECT_DOUBLE_EQ(2.0, vertices[0].vertex.y);
+    EXPECT_DOUBLE_EQ(3.0, vertices[0].vertex.z);
+
+    EXPECT_DOUBLE_EQ(4.5, vertices[1].vertex.x);
+    EXPECT_DOUBLE_EQ(-0.5, vertices[1].vertex.y);
+    EXPECT_DOUBLE_EQ(6.0, vertices[1].vertex.z);
+
+    EXPECT_DOUBLE_EQ(7.0, vertices[2].vertex.x);
+    EXPECT_DOUBLE_EQ(9.0, vertices[2].vertex.z);
+
+    EXPECT_DOUBLE_EQ(-1.25, vertices[3].vertex.x);
+    EXPECT_DOUBLE_EQ(1000.0, vertices[3].vertex.z);
+}
+
+TEST(CurveIO_parse, large_input)
+{
+    std::string text;
+    const int n_vertex = 200000;
+    for (int i = 0; i < n_vertex; i++)
+    {
+        text += "v " + std::to_string(i) + " " + std::to_string(-i) + " 0.5\n";
+    }
+
+    std::vector<_Pt> vertices;
+    CurveIO<_Pt>::parse_vertices(text.data(), text.data() + text.size(), vertices);
+
+    ASSERT_EQ(n_vertex, vertices.size());
+    for (int i = 0; i < n_vertex; i++)
+    {
+        EXPECT_EQ(_Dt(i), vertices[i].vertex.x);
+        EXPECT_EQ(_Dt(-i), vertices[i].vertex.y);
+    }
+}
+
+TEST(CurveIO_parse, large_input_other_lines)
+{
+    // lines without a vertex in every chunk, appended to a structure of arrays holding a vertex already
+    std::string text;
+    const int n_vertex = 200000;
+    for (int i = 0; i < n_vertex; i++)
+    {
+        text += "v " + std::to_string(i) + " " + std::to_string(-i) + " 0.5\n";
+        if (i % 7 == 0)
+        {
+            text += "vn 0 0 1\n# comment\n\n";
+        }
+    }
+
+    SoAVertexArray<_Pt> vertices;
+    vertices.push_back(_Pt());
+    CurveIO<_Pt>::parse_vertices(text.data(), text.data() + text.size(), vertices);
+
+    ASSERT_EQ(n_vertex + 1, vertices.size());
+    for (int i = 0; i < n_vertex; i++)
+    {
+        EXPECT_EQ(_Dt(i), vertices.x()[i + 1]);
+        EXPECT_EQ(_Dt(-i), vertices.y()[i + 1]);
+    }
+}
+
+}
@@ -0,0 +1,175 @@
+//
+// Created by haochuanchen on 18-5-31.
+//
+
+#include "../src/curve/BSplineCurve.h"
+#include "../src/curve/util/CurveIndex.h"
+#include <gmock/gmock.h>
+
+using namespace testing;
+using namespace std;
+
+namespace
+{
+
+using _Dt = double;
+using _Pt = CurvePoint<_Dt, BSplinePointTrait<_Dt>>;
+
+/// Small wavy curves scattered over [0, 10]^3, and one long curve crossing the whole range.
+std::vector<BSplineCurve<_Pt>> make_curves()
+{
+    std::vector<BSplineCurve<_Pt>> curves;
+    for (int k = 0; k < 60; k++)
+    {
+        Vector3X<_Dt> origin(std::fmod(k * 3.7, 10), std::fmod(k * 5.3, 10), std::fmod(k * 7.1, 10));
+        std::vector<Vertex<_Dt>> ctrlpts;
+        for (int i = 0; i < 8; i++)
+        {
+            ctrlpts.emplace_back(origin + Vector3X<_Dt>(0.2 * i, 0.3 * std::sin(i + k), 0.3 * std::cos(2 * i + k)));
+        }
+        curves.emplace_back(3, ctrlpts);
+    }
+
+    std::vector<Vertex<_Dt>> ctrlpts;
+    for (int i = 0; i < 4; i++)
+    {
+        ctrlpts.emplace_back(Vector3X<_Dt>(10.0 * i / 3, 5 + i % 2, 0));
+    }
+    curves.emplace_back(3, ctrlpts);
+    return curves;
+}
+
+/// Distance to a curve by its projector.
+_Dt distance_to(const BSplineCurve<_Pt>& curve, const Vector3X<_Dt>& point)
+{
+    CurveProjector<_Dt> projector(curve);
+    return projector.project(point).distance;
+}
+
+std::vector<Vector3X<_Dt>> make_queries()
+{
+    std::vector<Vector3X<_Dt>> points;
+    for (int i = 0; i < 40; i++)
+    {
+        points.emplace_back(std::fmod(i * 2.9, 12) - 1, std::fmod(i * 4.1, 12) - 1, std::fmod(i * 6.7, 12) - 1);
+    }
+    points.emplace_back(100, -50, 30);
+    return points;
+}
+
+TEST(CurveIndex_query, nearest_matches_brute_force)
+{
+    auto curves = make_curves();
+    CurveIndex<_Dt> index(0.5);
+    for (const auto& curve : curves)
+    {
+        index.insert(curve);
+    }
+    ASSERT_EQ(curves.size(), index.size());
+
+    auto points = make_queries();
+    auto hits = index.nearest(points);
+    ASSERT_EQ(points.size(), hits.size());
+
+    for (size_t i = 0; i < points.size(); i++)
+    {
+        _Dt best = std::numeric_limits<_Dt>::max();
+        for (const auto& curve : curves)
+        {
+            best = std::min(best, distance_to(curve, points[i]));
+        }
+        ASSERT_GE(hits[i].id, 0);
+        EXPECT_NEAR(best, hits[i].distance, 1e-12) << "i = " << i;
+        EXPECT_NEAR(hits[i].distance, distance_to(curves[hits[i].id], points[i]), 1e-12) << "i = " << i;
+    }
+
+    EXPECT_EQ(-1, index.nearest(Vector3X<_Dt>(100, -50, 30), 1.0).id);
+}
+
+TEST(CurveIndex_query, within_and_overlapping)
+{
+    auto curves = make_curves();
+    CurveIndex<_Dt> index(0.5);
+    for (const auto& curve : curves)
+    {
+        index.insert(curve);
+    }
+
+    const _Dt radius = 1.0;
+    for (const auto& point : make_queries())
+    {
+        auto hits = index.within(point, radius);
+        std::vector<int> expected;
+        for (size_t k = 0; k < curves.size(); k++)
+        {
+            if (distance_to(curves[k], point) <= radius)
+            {
+                expected.push_back(int(k));
+            }
+        }
+
+        std::vector<int> ids;
+        for (size_t j = 0; j < hits.size(); j++)
+        {
+            ids.push_back(hits[j].id);
+            if (j > 0)
+            {
+                EXPECT_LE(hits[j - 1].distance, hits[j].distance);
+            }
+        }
+        std::sort(ids.begin(), ids.end());
+        EXPECT_EQ(expected, ids);
+    }
+
+    // a box around the middle of the long curve finds it
+    BoundBox<_Dt> box{4.9, 5.1, 5.4, 5.6, -0.1, 0.1};
+    auto ids = index.overlapping(box);
+    EXPECT_THAT(ids, Contains(int(curves.size()) - 1));
+    EXPECT_TRUE(index.overlapping(BoundBox<_Dt>{50, 51, 50, 51, 50, 51}).empty());
+}
+
+TEST(CurveIndex_modify, insert_and_remove)
+{
+    auto curves = make_curves();
+    CurveIndex<_Dt> index(0.5);
+    std::vector<int> ids;
+    for (const auto& curve : curves)
+    {
+        ids.push_back(index.insert(curve));
+    }
+
+    // remove the nearest curve, the next nearest is found
+    Vector3X<_Dt> point(3, 3, 3);
+    auto hit = index.nearest(point);
+    ASSERT_TRUE(index.remove(hit.id));
+    EXPECT_FALSE(index.remove(hit.id));
+    EXPECT_EQ(curves.size() - 1, index.size());
+
+    _Dt best = std::numeric_limits<_Dt>::max();
+    for (size_t k = 0; k < curves.size(); k++)
+    {
+        if (ids[k] != hit.id)
+        {
+            best = std::min(best, distance_to(curves[k], point));
+        }
+    }
+    auto next = index.nearest(point);
+    EXPECT_NE(hit.id, next.id);
+    EXPECT_NEAR(best, next.distance, 1e-12);
+
+    // insert it back with a new id
+    int id = index.insert(curves[hit.id]);
+    EXPECT_NE(hit.id, id);
+    EXPECT_EQ(id, index.nearest(point).id);
+    EXPECT_NEAR(hit.distance, index.nearest(point).distance, 1e-12);
+
+    for (int k : ids)
+    {
+        index.remove(k);
+    }
+    index.remove(id);
+    EXPECT_EQ(0, index.size());
+    EXPECT_EQ(-1, index.nearest(point).id);
+}
+
+}
@@ -0,0 +1,172 @@
+//
+// Created by haochuanchen on 18-6-2.
+//
+
+#include "../src/curve/BSplineCurve.h"
+#include "../src/curve/util/CurveIntersection.h"
+#include <gmock/gmock.h>
+
+using namespace testing;
+using namespace std;
+
+namespace
+{
+
+using _Dt = double;
+using _Pt = CurvePoint<_Dt, BSplinePointTrait<_Dt>>;
+using _Intersection = CurveIntersection<_Dt>;
+
+/// A wavy curve along x in the plane z = z.
+BSplineCurve<_Pt> make_wave(_Dt phase, _Dt z)
+{
+    std::vector<Vertex<_Dt>> ctrlpts;
+    for (int i = 0; i < 16; i++)
+    {
+        ctrlpts.emplace_back(Vector3X<_Dt>(i, std::sin(i * 1.3 + phase), z));
+    }
+    return BSplineCurve<_Pt>(3, ctrlpts);
+}
+
+/// A straight line from a to b.
+BSplineCurve<_Pt> make_line(const Vector3X<_Dt>& a, const Vector3X<_Dt>& b)
+{
+    std::vector<Vertex<_Dt>> ctrlpts;
+    for (int i = 0; i < 4; i++)
+    {
+        ctrlpts.emplace_back(a + (b - a) * (i / 3.0));
+    }
+    return BSplineCurve<_Pt>(3, ctrlpts);
+}
+
+/// Parameters where y(u) - c changes sign, by dense sampling.
+std::vector<_Dt> sign_changes(const BSplineCurve<_Pt>& curve, _Dt c)
+{
+    BSplineEvaluator<_Dt> evaluator(curve);
+    std::vector<_Dt> changes;
+    const int n = 100000;
+    _Dt last = evaluator.point(0).y - c;
+    for (int i = 1; i <= n; i++)
+    {
+        _Dt u = _Dt(i) / n;
+        _Dt d = evaluator.point(u).y - c;
+        if ((last < 0) != (d < 0))
+        {
+            changes.push_back(u);
+        }
+        last = d;
+    }
+    return changes;
+}
+
+TEST(CurveIntersection_plane, matches_sign_changes)
+{
+    auto curve = make_wave(0.3, 0);
+    BSplineEvaluator<_Dt> evaluator(curve);
+    _Intersection intersection;
+
+    for (_Dt c : {0.0, 0.25, -0.4})
+    {
+        auto hits = intersection.intersect(curve, _Intersection::Plane{Vector3X<_Dt>(0, c, 0), Vector3X<_Dt>(0, 2, 0)});
+        auto expected = sign_changes(curve, c);
+        ASSERT_EQ(expected.size(), hits.size()) << "c = " << c;
+        for (size_t i = 0; i < hits.size(); i++)
+        {
+            EXPECT_NEAR(expected[i], hits[i].u, 1e-4);
+            EXPECT_NEAR(c, hits[i].point.y, 1e-9);
+            EXPECT_NEAR(0, (evaluator.point(hits[i].u) - hits[i].point).length(), 1e-12);
+        }
+    }
+
+    // a plane missing the curve
+    EXPECT_TRUE(intersection.intersect(curve, _Intersection::Plane{Vector3X<_Dt>(0, 0, 1), Vector3X<_Dt>(0, 0, 1)})
+                    .empty());
+}
+
+TEST(CurveIntersection_curve, line_and_wave)
+{
+    auto wave = make_wave(0.3, 0);
+    auto line = make_line(Vector3X<_Dt>(-1, 0.1, 0), Vector3X<_Dt>(16, 0.1, 0));
+    BSplineEvaluator<_Dt> wave_evaluator(wave), line_evaluator(line);
+    _Intersection intersection;
+
+    auto hits = intersection.intersect(wave, line);
+    auto expected = sign_changes(wave, 0.1);
+    ASSERT_EQ(expected.size(), hits.size());
+    for (size_t i = 0; i < hits.size(); i++)
+    {
+        EXPECT_NEAR(expected[i], hits[i].u, 1e-4);
+        EXPECT_NEAR(0, (wave_evaluator.point(hits[i].u) - hits[i].point).length(), 1e-9);
+        EXPECT_NEAR(0, (line_evaluator.point(hits[i].v) - hits[i].point).length(), 1e-9);
+    }
+
+    // the line lifted out of the plane of the wave
+    auto lifted = make_line(Vector3X<_Dt>(-1, 0.1, 0.5), Vector3X<_Dt>(16, 0.1, 0.5));
+    EXPECT_TRUE(intersection.intersect(wave, lifted).empty());
+}
+
+TEST(CurveIntersection_curve, overlapping_lines)
+{
+    auto a = make_line(Vector3X<_Dt>(0, 0, 0), Vector3X<_Dt>(4, 0, 0));
+    auto b = make_line(Vector3X<_Dt>(6, 0, 0), Vector3X<_Dt>(2, 0, 0));
+    _Intersection intersection;
+
+    // the ends of the overlap [2, 4]
+    auto hits = intersection.intersect(a, b);
+    ASSERT_EQ(2, hits.size());
+    EXPECT_NEAR(0.5, hits[0].u, 1e-9);
+    EXPECT_NEAR(1.0, hits[0].v, 1e-9);
+    EXPECT_NEAR(1.0, hits[1].u, 1e-9);
+    EXPECT_NEAR(0.5, hits[1].v, 1e-9);
+    EXPECT_NEAR(0, (hits[0].point - Vector3X<_Dt>(2, 0, 0)).length(), 1e-9);
+    EXPECT_NEAR(0, (hits[1].point - Vector3X<_Dt>(4, 0, 0)).length(), 1e-9);
+
+    // lines touching end to end meet in a point
+    auto c = make_line(Vector3X<_Dt>(4, 0, 0), Vector3X<_Dt>(8, 0, 0));
+    hits = intersection.intersect(a, c);
+    ASSERT_EQ(1, hits.size());
+    EXPECT_NEAR(0, (hits[0].point - Vector3X<_Dt>(4, 0, 0)).length(), 1e-9);
+}
+
+TEST(CurveIntersection_batch, same_as_single)
+{
+    std::vector<BSplineCurve<_Pt>> curves;
+    for (int k = 0; k < 6; k++)
+    {
+        curves.push_back(make_wave(0.7 * k, 0));
+    }
+    std::vector<const BSplineCurve<_Pt>*> pointers;
+    std::vector<std::pair<int, int>> pairs;
+    for (int i = 0; i < 6; i++)
+    {
+        pointers.push_back(&curves[i]);
+        for (int j = i + 1; j < 6; j++)
+        {
+            pairs.emplace_back(i, j);
+        }
+    }
+
+    _Intersection intersection;
+    auto hits = intersection.intersect(pointers, pairs);
+    ASSERT_EQ(pairs.size(), hits.size());
+    for (size_t k = 0; k < pairs.size(); k++)
+    {
+        auto single = intersection.intersect(curves[pairs[k].first], curves[pairs[k].second]);
+        ASSERT_EQ(single.size(), hits[k].size());
+        EXPECT_FALSE(single.empty());
+        for (size_t i = 0; i < single.size(); i++)
+        {
+            EXPECT_EQ(single[i].u, hits[k][i].u);
+            EXPECT_EQ(single[i].v, hits[k][i].v);
+        }
+    }
+
+    _Intersection::Plane plane{Vector3X<_Dt>(0, 0.2, 0), Vector3X<_Dt>(0, 1, 0)};
+    auto slices = intersection.intersect(pointers, plane);
+    ASSERT_EQ(curves.size(), slices.size());
+    for (size_t k = 0; k < curves.size(); k++)
+    {
+        EXPECT_EQ(sign_changes(curves[k], 0.2).size(), slices[k].size());
+    }
+}
+
+}
@@ -0,0 +1,80 @@
+//
+// Created by haochuanchen on 18-5-30.
+//
+
+#include "../src/curve/BSplineCurve.h"
+#include "../src/curve/util/CurveProjector.h"
+#include <gmock/gmock.h>
+
+using namespace testing;
+using namespace std;
+
+namespace
+{
+
+using _Dt = double;
+using _Pt = CurvePoint<_Dt, BSplinePointTrait<_Dt>>;
+
+/// A wavy space curve with many spans.
+BSplineCurve<_Pt> make_curve()
+{
+    std::vector<Vertex<_Dt>> ctrlpts;
+    for (int i = 0; i < 40; i++)
+    {
+        _Dt t = 4 * M_PI * i / 39;
+        ctrlpts.emplace_back(Vector3X<_Dt>(std::cos(t) * (1 + 0.2 * (i % 3)), std::sin(t), 0.1 * t));
+    }
+    return BSplineCurve<_Pt>(3, ctrlpts);
+}
+
+/// Closest point by dense sampling.
+_Dt brute_force_distance(const BSplineEvaluator<_Dt>& evaluator, const Vector3X<_Dt>& point)
+{
+    _Dt best = std::numeric_limits<_Dt>::max();
+    const int n = 200000;
+    for (int i = 0; i <= n; i++)
+    {
+        best = std::min(best, (evaluator.point(_Dt(i) / n) - point).length());
+    }
+    return best;
+}
+
+TEST(CurveProjector_project, points_on_curve)
+{
+    auto bc = make_curve();
+    CurveProjector<_Dt> projector(bc);
+    BSplineEvaluator<_Dt> evaluator(bc);
+
+    for (int i = 0; i <= 50; i++)
+    {
+        _Dt u = _Dt(i) / 50;
+        auto projection = projector.project(evaluator.point(u));
+        EXPECT_NEAR(0, projection.distance, 1e-12) << "u = " << u;
+        EXPECT_NEAR(u, projection.u, 1e-9) << "u = " << u;
+    }
+}
+
+TEST(CurveProjector_project, matches_brute_force)
+{
+    auto bc = make_curve();
+    CurveProjector<_Dt> projector(bc);
+    BSplineEvaluator<_Dt> evaluator(bc);
+
+    std::vector<Vector3X<_Dt>> points;
+    for (int i = 0; i < 20; i++)
+    {
+        points.emplace_back(std::sin(i * 1.7) * 1.5, std::cos(i * 2.3) * 1.5, 0.07 * i);
+    }
+
+    auto projections = projector.project(points);
+    ASSERT_EQ(points.size(), projections.size());
+    for (size_t i = 0; i < points.size(); i++)
+    {
+        const auto& projection = projections[i];
+        EXPECT_NEAR(brute_force_distance(evaluator, points[i]), projection.distance, 1e-6) << "i = " << i;
+        EXPECT_NEAR(projection.distance, (points[i] - projection.point).length(), 1e-12);
+        EXPECT_NEAR(0, (evaluator.point(projection.u) - projection.point).length(), 1e-12);
+    }
+}
+
+}
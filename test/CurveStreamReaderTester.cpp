@@ -0,0 +1,65 @@
+//
+// Created by haochuanchen on 18-5-21.
+//
+
+#include "../src/curve/io/CurveStreamReader.h"
+#include "../src/curve/ParaCurve.h"
+#include <gmock/gmock.h>
+
+#include <fstream>
+
+using namespace testing;
+using namespace std;
+
+namespace
+{
+
+using _Dt = double;
+using _Pt = CurvePoint<_Dt, ParaPointTrait<_Dt>>;
+
+QString write_circle(const std::string& name, int n_vertex)
+{
+    std::string filename = testing::TempDir() + name;
+    std::ofstream out(filename);
+    for (int i = 0; i < n_vertex; i++)
+    {
+        double t = 2 * M_PI * i / n_vertex;
+        out << "v " << 3 + 2 * std::cos(t) << " " << 5 + 2 * std::sin(t) << " 7\n";
+    }
+    return QString::fromStdString(filename);
+}
+
+TEST(CurveStreamReader, matches_init_from_file)
+{
+    auto filename = write_circle("stream_circle.obj", 1000);
+
+    ParaCurve<_Pt> curve;
+    curve.init_from_file(filename);
+    const auto& expected = curve.get_vertices();
+
+    // small buffer, lines cross the buffer boundary
+    CurveStreamReader<_Pt> reader(filename, 64, 100);
+    auto statistics = reader.scan();
+
+    EXPECT_EQ(1000, statistics.count);
+    EXPECT_TRUE(statistics.is_periodic());
+    EXPECT_DOUBLE_EQ(7, statistics.box.z_max);
+
+    reader.set_transform(statistics.normalize_transform());
+    reader.set_close_periodic(statistics.is_periodic());
+
+    std::vector<_Pt> block, all;
+    while (reader.read_block(block) > 0)
+    {
+        EXPECT_LE(block.size(), 64);
+        all.insert(all.end(), block.begin(), block.end());
+    }
+
+    ASSERT_EQ(expected.size(), all.size());
+    for (int i = 0; i < all.size(); i++)
+    {
+        EXPECT_LT((expected[i].vertex - all[i].vertex).length(), 1e-12);
+    }
+}
+
+}
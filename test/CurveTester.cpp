@@ -0,0 +1,343 @@
+//
+// Created by haochuanchen on 18-5-25.
+//
+
+#include "../src/curve/ParaCurve.h"
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <fstream>
+
+using namespace testing;
+using namespace std;
+
+namespace
+{
+
+using _Dt = double;
+using _Pt = CurvePoint<_Dt, ParaPointTrait<_Dt>>;
+
+/// An open arc in the negative octant.
+QString write_arc(const std::string& name, int n_vertex)
+{
+    std::string filename = testing::TempDir() + name;
+    std::ofstream out(filename);
+    out.precision(17);
+    for (int i = 0; i < n_vertex; i++)
+    {
+        double t = M_PI * i / (n_vertex - 1);
+        out << "v " << -10 + 4 * std::cos(t) << " " << -20 - 2 * std::sin(t) << " -3\n";
+    }
+    return QString::fromStdString(filename);
+}
+
+TEST(Curve_init_from_file, negative_bound_box)
+{
+    auto filename = write_arc("negative_arc.obj", 200001);
+
+    ParaCurve<_Pt> raw;
+    raw.init_from_file(filename, false);
+    const auto& box = raw.get_bound_box();
+
+    EXPECT_DOUBLE_EQ(-14, box.x_min);
+    EXPECT_DOUBLE_EQ(-6, box.x_max);
+    EXPECT_DOUBLE_EQ(-22, box.y_min);
+    EXPECT_DOUBLE_EQ(-20, box.y_max);
+    EXPECT_DOUBLE_EQ(-3, box.z_min);
+    EXPECT_DOUBLE_EQ(-3, box.z_max);
+    EXPECT_FALSE(raw.is_periodic());
+
+    ParaCurve<_Pt> curve;
+    curve.init_from_file(filename);
+    const auto& normalized_box = curve.get_bound_box();
+
+    EXPECT_DOUBLE_EQ(-1, normalized_box.x_min);
+    EXPECT_DOUBLE_EQ(1, normalized_box.x_max);
+    EXPECT_DOUBLE_EQ(-0.25, normalized_box.y_min);
+    EXPECT_DOUBLE_EQ(0.25, normalized_box.y_max);
+
+    // the transform maps the normalized vertices back
+    const auto& transform = curve.get_normalize_transform();
+    EXPECT_DOUBLE_EQ(4, transform.scale);
+
+    const auto& vertices = curve.get_vertices();
+    const auto& raw_vertices = raw.get_vertices();
+    ASSERT_EQ(raw_vertices.size(), vertices.size());
+    for (size_t i = 0; i < vertices.size(); i += 1000)
+    {
+        EXPECT_LT((transform.invert(vertices[i].vertex) - raw_vertices[i].vertex).length(), 1e-12) << "i = " << i;
+    }
+}
+
+TEST(Curve_init_from_file, periodic)
+{
+    std::string filename = testing::TempDir() + "closed_square.obj";
+    {
+        std::ofstream out(filename);
+        out << "v -1 -1 0\nv 1 -1 0\nv 1 1 0\nv -1 1 0\n";
+    }
+
+    ParaCurve<_Pt> curve;
+    curve.init_from_file(QString::fromStdString(filename));
+
+    EXPECT_TRUE(curve.is_periodic());
+    ASSERT_EQ(5, curve.get_vertices().size());
+    EXPECT_EQ(curve.get_vertices().front().vertex, curve.get_vertices().back().vertex);
+}
+
+TEST(Curve_soa_storage, matches_aos)
+{
+    auto filename = write_arc("soa_arc.obj", 5000);
+
+    ParaCurve<_Pt> aos;
+    aos.init_from_file(filename);
+    aos.chordal_parameterization();
+
+    ParaCurve<_Pt, SoAStorage> soa;
+    soa.init_from_file(filename);
+    soa.chordal_parameterization();
+
+    const auto& aos_vertices = aos.get_vertices();
+    const auto& soa_vertices = soa.get_vertices();
+    ASSERT_EQ(aos_vertices.size(), soa_vertices.size());
+
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(soa_vertices.x()) % 64);
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(soa_vertices.u()) % 64);
+
+    for (size_t i = 0; i < aos_vertices.size(); i++)
+    {
+        EXPECT_EQ(aos_vertices[i].vertex, soa_vertices[i].vertex) << "i = " << i;
+        EXPECT_DOUBLE_EQ(aos_vertices[i].trait.u, soa_vertices.u()[i]) << "i = " << i;
+    }
+    EXPECT_DOUBLE_EQ(aos.get_bound_box().y_min, soa.get_bound_box().y_min);
+}
+
+TEST(Curve_soa_storage, proxy_access)
+{
+    SoAVertexArray<CurvePoint<_Dt, BSplinePointTrait<_Dt>>> vertices;
+
+    CurvePoint<_Dt, BSplinePointTrait<_Dt>> point;
+    point.vertex = Vertex<_Dt>(1, 2, 3);
+    point.trait.u = 0.5;
+    point.trait.span = 4;
+    vertices.push_back(point);
+    vertices.push_back(point);
+
+    vertices[1].vertex.y = -2;
+    vertices[1].trait.span = 7;
+    vertices[0] = vertices[1];
+
+    EXPECT_EQ(Vertex<_Dt>(1, -2, 3), vertices.front().vertex);
+    EXPECT_EQ(7, vertices.span()[0]);
+
+    int count = 0;
+    for (const auto& p : static_cast<const decltype(vertices)&>(vertices))
+    {
+        EXPECT_DOUBLE_EQ(0.5, p.trait.u);
+        count++;
+    }
+    EXPECT_EQ(2, count);
+}
+
+TEST(Curve_soa_storage, random_access_iterator)
+{
+    using _Array = SoAVertexArray<_Pt>;
+    _Array vertices;
+    for (int i = 0; i < 10; i++)
+    {
+        _Pt point;
+        point.vertex = Vertex<_Dt>(i, 0, 0);
+        point.trait.u = i * 0.1;
+        vertices.push_back(point);
+    }
+
+    _Array::iterator first = vertices.begin();
+    _Array::const_iterator last = vertices.end();
+    _Array::const_iterator middle = first + 5;
+
+    EXPECT_TRUE(first < last);
+    EXPECT_TRUE(last > first);
+    EXPECT_TRUE(middle <= middle);
+    EXPECT_TRUE(middle >= first);
+    EXPECT_FALSE(first >= middle);
+    EXPECT_TRUE(first != middle);
+    EXPECT_EQ(middle, 5 + first);
+    EXPECT_EQ(10, last - first);
+    EXPECT_DOUBLE_EQ(5, (*middle).vertex.x);
+
+    // standard algorithms on the random access iterators
+    auto found = std::lower_bound(vertices.begin(), vertices.end(), 0.45,
+                                  [](const _Pt& point, _Dt u) { return point.trait.u < u; });
+    EXPECT_EQ(5, found - vertices.begin());
+    std::reverse(vertices.begin(), vertices.end());
+    EXPECT_DOUBLE_EQ(9, vertices.front().vertex.x);
+}
+
+TEST(ParaCurve_parameterization, chordal_and_centripetal)
+{
+    ParaCurve<_Pt> curve;
+    auto& vertices = curve.get_vertices();
+    for (int i = 0; i < 100000; i++)
+    {
+        _Pt point;
+        point.vertex = Vertex<_Dt>(std::cos(i * 1e-3) * (1 + i % 3), std::sin(i * 1e-3), 0);
+        vertices.push_back(point);
+    }
+
+    for (int method = 0; method < 2; method++)
+    {
+        method == 0 ? curve.chordal_parameterization() : curve.centripetal_parameterization();
+
+        std::vector<_Dt> expected(vertices.size(), 0);
+        for (size_t i = 1; i < vertices.size(); i++)
+        {
+            _Dt length = (vertices[i].vertex - vertices[i - 1].vertex).length();
+            expected[i] = expected[i - 1] + (method == 0 ? length : std::sqrt(length));
+        }
+
+        EXPECT_EQ(0, vertices.front().trait.u);
+        EXPECT_EQ(1, vertices.back().trait.u);
+        for (size_t i = 0; i < vertices.size(); i += 97)
+        {
+            EXPECT_NEAR(expected[i] / expected.back(), vertices[i].trait.u, 1e-12) << "i = " << i;
+        }
+    }
+}
+
+TEST(ParaCurve_parameterization, coincident_vertices)
+{
+    ParaCurve<_Pt, SoAStorage> curve;
+    _Pt point;
+    point.vertex = Vertex<_Dt>(1, 1, 1);
+    for (int i = 0; i < 5; i++)
+    {
+        curve.get_vertices().push_back(point);
+    }
+
+    curve.chordal_parameterization();
+    for (int i = 0; i < 5; i++)
+    {
+        EXPECT_DOUBLE_EQ(0.25 * i, curve.get_vertices()[i].trait.u);
+    }
+}
+
+TEST(ParaCurve_parameterization, exponent)
+{
+    ParaCurve<_Pt> curve;
+    for (int i = 0; i < 50; i++)
+    {
+        _Pt point;
+        point.vertex = Vertex<_Dt>(i * i * 0.01, std::sin(i * 0.3), 0);
+        curve.get_vertices().push_back(point);
+    }
+
+    auto parameters = [&]
+    {
+        std::vector<_Dt> u;
+        for (const auto& v : curve.get_vertices())
+        {
+            u.push_back(v.trait.u);
+        }
+        return u;
+    };
+
+    curve.chordal_parameterization();
+    auto chordal = parameters();
+    curve.centripetal_parameterization();
+    auto centripetal = parameters();
+    curve.uniform_parameterization();
+    auto uniform = parameters();
+
+    curve.exponent_parameterization(1.0);
+    EXPECT_THAT(parameters(), Pointwise(DoubleNear(1e-12), chordal));
+    curve.exponent_parameterization(0.5);
+    EXPECT_THAT(parameters(), Pointwise(DoubleNear(1e-12), centripetal));
+    curve.exponent_parameterization(0.0);
+    EXPECT_THAT(parameters(), Pointwise(DoubleNear(1e-12), uniform));
+
+    EXPECT_THROW(curve.exponent_parameterization(-1.0), std::invalid_argument);
+}
+
+TEST(ParaCurve_parameterization, foley_nielsen)
+{
+    ParaCurve<_Pt, SoAStorage> curve;
+    auto& vertices = curve.get_vertices();
+
+    // straight line: no deflection, same as chordal
+    for (int i = 0; i < 10; i++)
+    {
+        _Pt point;
+        point.vertex = Vertex<_Dt>(i * (i + 1) * 0.5, 0, 0);
+        vertices.push_back(point);
+    }
+    curve.foley_nielsen_parameterization();
+    for (int i = 0; i < 10; i++)
+    {
+        EXPECT_NEAR(i * (i + 1) / 90.0, vertices.u()[i], 1e-12);
+    }
+
+    // right angle corner at vertex 2: the segments around it get longer
+    vertices.clear();
+    for (auto v : {Vertex<_Dt>(0, 0, 0), Vertex<_Dt>(1, 0, 0), Vertex<_Dt>(2, 0, 0), Vertex<_Dt>(2, 1, 0),
+                   Vertex<_Dt>(2, 2, 0)})
+    {
+        _Pt point;
+        point.vertex = v;
+        vertices.push_back(point);
+    }
+    curve.foley_nielsen_parameterization();
+
+    // factors: 1, 1 + 1.5 * pi/2 / 2, 1 + 1.5 * pi/2 / 2, 1
+    _Dt corner = 1 + 0.75 * M_PI / 2;
+    _Dt total = 2 + 2 * corner;
+    EXPECT_NEAR(1 / total, vertices.u()[1], 1e-12);
+    EXPECT_NEAR(0.5, vertices.u()[2], 1e-12);
+    EXPECT_NEAR((1 + 2 * corner) / total, vertices.u()[3], 1e-12);
+    EXPECT_EQ(1, vertices.u()[4]);
+}
+
+TEST(ParaCurve_parameterization, universal)
+{
+    const int n_vertex = 10, degree = 3;
+
+    ParaCurve<_Pt> curve;
+    for (int i = 0; i < n_vertex; i++)
+    {
+        _Pt point;
+        point.vertex = Vertex<_Dt>(i, i * i, 0);
+        curve.get_vertices().push_back(point);
+    }
+    curve.universal_parameterization(degree);
+    const auto& vertices = curve.get_vertices();
+
+    // uniform clamped knot vector with n_vertex basis functions
+    std::vector<_Dt> knots(n_vertex + degree + 1);
+    for (int i = 0; i < knots.size(); i++)
+    {
+        knots[i] = i <= degree ? 0 : (i >= n_vertex ? 1 : _Dt(i - degree) / (n_vertex - degree));
+    }
+    BSplineFunction<_Dt> bf(n_vertex - 1, degree, knots);
+    std::vector<_Dt> values(degree + 1);
+
+    for (int i = 0; i < n_vertex; i++)
+    {
+        // brute force maximum of the i-th basis function
+        _Dt best_u = 0, best = -1;
+        for (int j = 0; j <= 100000; j++)
+        {
+            _Dt u = j / 100000.0;
+            int span = bf.find_span(u);
+            bf.basis_funcs(span, u, values.data());
+            _Dt value = i >= span - degree && i <= span ? values[i - span + degree] : 0;
+            if (value > best)
+            {
+                best = value;
+                best_u = u;
+            }
+        }
+        EXPECT_NEAR(best_u, vertices[i].trait.u, 2e-5) << "i = " << i;
+        EXPECT_NEAR(1.0, vertices[i].trait.u + vertices[n_vertex - 1 - i].trait.u, 1e-7) << "i = " << i;
+    }
+}
+
+}
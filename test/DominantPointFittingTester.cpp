@@ -0,0 +1,81 @@
+//
+// Created by haochuanchen on 18-5-12.
+//
+
+#include "../src/fitting/DominantPointFitting.h"
+#include "../src/fitting/KTPFitting.h"
+#include "TestCurves.h"
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace testing;
+using namespace std;
+
+namespace
+{
+
+using _Fitting = BSplineCurveFitting_Base;
+using _Ct = _Fitting::_In_Ct;
+using _Dt = _Fitting::_Dt;
+
+/// A wiggly run and a smooth run joined at a corner at t = 0.5, the features are dense on the first half.
+Vertex<_Dt> corner_shape(_Dt t)
+{
+    return t < 0.5 ? Vertex<_Dt>(t, 0.02 * std::sin(40 * t), 0.1 * std::sin(20 * t * t))
+                   : Vertex<_Dt>(0.5, t - 0.5, 0.1 * std::sin(20 * t * t));
+}
+
+TEST(DominantPointFitting, dominant_points)
+{
+    auto curve = make_curve(2001, corner_shape);
+
+    for (int n_control_point : {4, 10, 64, 500})
+    {
+        // the number of control points, ascending and distinct, both ends
+        auto dominant = DominantPointFitting(curve, 3, n_control_point).select_dominant_points();
+
+        ASSERT_EQ(n_control_point, dominant.size());
+        EXPECT_EQ(0, dominant.front());
+        EXPECT_EQ(2000, dominant.back());
+        EXPECT_TRUE(std::adjacent_find(dominant.begin(), dominant.end(), std::greater_equal<int>()) == dominant.end())
+                    << "n = " << n_control_point;
+    }
+}
+
+TEST(DominantPointFitting, knot_at_corner)
+{
+    auto curve = make_curve(2001, corner_shape);
+    _Dt corner = curve.get_vertices()[1000].trait.u;
+
+    DominantPointFitting fitting(curve, 3, 40);
+    EXPECT_THAT(fitting.select_dominant_points(), Contains(1000));
+
+    auto knots = fitting.select_knot_vector();
+    _Dt distance = 1;
+    for (_Dt knot : knots)
+    {
+        distance = std::min(distance, std::abs(knot - corner));
+    }
+    // a tenth of a uniform knot span
+    EXPECT_LT(distance, 0.1 / (40 - 3));
+}
+
+TEST(DominantPointFitting, lower_error_than_ktp)
+{
+    auto curve = make_curve(5001, corner_shape);
+
+    for (int n_control_point : {32, 64, 128})
+    {
+        KTPFitting ktp(curve, 3, n_control_point);
+        DominantPointFitting dominant(curve, 3, n_control_point);
+
+        auto fitted = dominant.fitting();
+        ASSERT_EQ(n_control_point, fitted.get_control_points().size());
+        EXPECT_LT(ktp.fitting_error(fitted).max_error, ktp.fitting_error(ktp.fitting()).max_error)
+                    << "n = " << n_control_point;
+    }
+}
+
+}
@@ -0,0 +1,66 @@
+//
+// Created by haochuanchen on 18-5-12.
+//
+
+#include "../src/fitting/ErrorDrivenFitting.h"
+#include "TestCurves.h"
+#include <gmock/gmock.h>
+
+#include <algorithm>
+
+using namespace testing;
+using namespace std;
+
+namespace
+{
+
+using _Fitting = BSplineCurveFitting_Base;
+using _Ct = _Fitting::_In_Ct;
+using _Pt = _Fitting::_In_Pt;
+using _Dt = _Fitting::_Dt;
+
+/// A wiggly run and a smooth run joined at a corner, the error concentrates on a few spans.
+Vertex<_Dt> corner_shape(_Dt t)
+{
+    return t < 0.5 ? Vertex<_Dt>(t, 0.02 * std::sin(40 * t), 0.1 * std::sin(20 * t * t))
+                   : Vertex<_Dt>(0.5, t - 0.5, 0.1 * std::sin(20 * t * t));
+}
+
+TEST(ErrorDrivenFitting, lower_error_than_ktp)
+{
+    auto curve = make_curve(5001, corner_shape);
+
+    for (int n_control_point : {64, 128, 256})
+    {
+        KTPFitting ktp(curve, 3, n_control_point);
+        ErrorDrivenFitting error_driven(curve, 3, n_control_point);
+
+        auto fitted = error_driven.fitting();
+        ASSERT_EQ(n_control_point, fitted.get_control_points().size());
+        EXPECT_LT(ktp.fitting_error(fitted).max_error, ktp.fitting_error(ktp.fitting()).max_error)
+                    << "n = " << n_control_point;
+    }
+}
+
+TEST(ErrorDrivenFitting, knots_keep_a_vertex_in_every_span)
+{
+    // many control points for few vertices, the redistributed knots must not empty a span
+    auto curve = make_curve(600, corner_shape);
+
+    ErrorDrivenFitting fitting(curve, 3, 256);
+    auto knots = fitting.select_knot_vector();
+    ASSERT_EQ(256 + 3 + 1, knots.size());
+
+    const auto& vertices = curve.get_vertices();
+    for (int i = 3; i < 256; i++)
+    {
+        EXPECT_LT(knots[i], knots[i + 1]);
+        auto in_span = std::find_if(vertices.begin(), vertices.end(), [&knots, i](const _Pt& point)
+        {
+            return point.trait.u >= knots[i] && point.trait.u < knots[i + 1];
+        });
+        EXPECT_NE(vertices.end(), in_span) << "span " << i;
+    }
+}
+
+}
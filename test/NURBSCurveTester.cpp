@@ -0,0 +1,121 @@
+//
+// Created by haochuanchen on 18-6-4.
+//
+
+#include "../src/curve/NURBSCurve.h"
+#include <gmock/gmock.h>
+
+using namespace testing;
+using namespace std;
+
+namespace
+{
+
+using _Dt = double;
+using _Pt = CurvePoint<_Dt, BSplinePointTrait<_Dt>>;
+
+/// The unit circle, *The NURBS Book* Example 7.1
+NURBSCurve<_Pt> make_circle()
+{
+    _Dt ctrlpts_src[][2] = {{1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}, {0, -1}, {1, -1}, {1, 0}};
+    std::vector<Vertex<_Dt>> ctrlpts;
+    std::vector<_Dt> weights;
+    for (int i = 0; i < 9; i++)
+    {
+        ctrlpts.emplace_back(Vector3X<_Dt>(ctrlpts_src[i][0], ctrlpts_src[i][1], 0));
+        weights.push_back(i % 2 == 0 ? 1 : std::sqrt(0.5));
+    }
+    std::vector<_Dt> knots = {0, 0, 0, 0.25, 0.25, 0.5, 0.5, 0.75, 0.75, 1, 1, 1};
+    return NURBSCurve<_Pt>(2, ctrlpts, weights, knots);
+}
+
+TEST(NURBSCurve_evaluate, circle)
+{
+    auto circle = make_circle();
+    NURBSEvaluator<_Dt> evaluator(circle);
+
+    for (int i = 0; i <= 100; i++)
+    {
+        _Dt u = i / 100.0;
+        EXPECT_NEAR(1, evaluator.point(u).length(), 1e-14) << "u = " << u;
+    }
+
+    circle.recalculate_curve(0.01);
+    for (const auto& point : circle.get_vertices())
+    {
+        EXPECT_NEAR(1, point.vertex.length(), 1e-14);
+    }
+}
+
+TEST(NURBSCurve_evaluate, derivatives)
+{
+    auto circle = make_circle();
+    NURBSEvaluator<_Dt> evaluator(circle);
+
+    const _Dt h = 1e-5;
+    Vector3X<_Dt> ders[4];
+    for (_Dt u : {0.1, 0.3, 0.6, 0.9})
+    {
+        evaluator.derivatives(u, 3, ders);
+        EXPECT_NEAR(0, (ders[0] - evaluator.point(u)).length(), 1e-14);
+
+        auto first = (evaluator.point(u + h) - evaluator.point(u - h)) / (2 * h);
+        auto second = (evaluator.point(u + h) - 2 * evaluator.point(u) + evaluator.point(u - h)) / (h * h);
+        EXPECT_NEAR(0, (ders[1] - first).length(), 1e-6) << "u = " << u;
+        EXPECT_NEAR(0, (ders[2] - second).length(), 1e-3) << "u = " << u;
+
+        // on a circle the velocity is tangent
+        EXPECT_NEAR(0, ders[0].dot(ders[1]), 1e-12) << "u = " << u;
+    }
+}
+
+TEST(NURBSCurve_evaluate, unit_weights_as_b_spline)
+{
+    std::vector<Vertex<_Dt>> ctrlpts;
+    for (int i = 0; i < 8; i++)
+    {
+        ctrlpts.emplace_back(Vector3X<_Dt>(i, std::sin(i), std::cos(2 * i)));
+    }
+    BSplineCurve<_Pt> bc(3, ctrlpts);
+    NURBSCurve<_Pt> nc(bc);
+
+    BSplineEvaluator<_Dt> expected(bc);
+    NURBSEvaluator<_Dt> actual(nc);
+    Vector3X<_Dt> expected_ders[4], actual_ders[4];
+    for (int i = 0; i <= 50; i++)
+    {
+        _Dt u = i / 50.0;
+        expected.derivatives(u, 3, expected_ders);
+        actual.derivatives(u, 3, actual_ders);
+        for (int k = 0; k <= 3; k++)
+        {
+            EXPECT_NEAR(0, (expected_ders[k] - actual_ders[k]).length(), 1e-9 * (1 + expected_ders[k].length()))
+                << "u = " << u << ", k = " << k;
+        }
+    }
+
+    EXPECT_THROW(NURBSCurve<_Pt>(3, ctrlpts, std::vector<_Dt>(8, 0.0)), std::invalid_argument);
+    EXPECT_THROW(NURBSCurve<_Pt>(3, ctrlpts, std::vector<_Dt>(7, 1.0)), std::invalid_argument);
+}
+
+TEST(NURBSCurve_knots, as_b_spline)
+{
+    std::vector<Vertex<_Dt>> ctrlpts(6, Vertex<_Dt>(0, 0, 0));
+    std::vector<_Dt> weights(6, 1.0);
+
+    // normalized as the B spline curve does
+    std::vector<_Dt> knots = {2, 2, 2, 2, 3, 5, 6, 6, 6, 6};
+    NURBSCurve<_Pt> curve(3, ctrlpts, weights, knots);
+    EXPECT_THAT(curve.get_knot_vector(), ElementsAreArray(BSplineCurve<_Pt>(3, ctrlpts, knots).get_knot_vector()));
+    EXPECT_THAT(curve.get_knot_vector(), ElementsAre(0, 0, 0, 0, 0.25, 0.75, 1, 1, 1, 1));
+
+    EXPECT_THAT(NURBSCurve<_Pt>(3, ctrlpts, weights).get_knot_vector(),
+                ElementsAreArray(BSplineCurve<_Pt>(3, ctrlpts).get_knot_vector()));
+
+    // a knot less than the one before it, not only than the first one
+    std::vector<_Dt> descending = {0, 0, 0, 0, 0.6, 0.3, 1, 1, 1, 1};
+    EXPECT_THROW(curve.set_knot_vector(descending), std::logic_error);
+    EXPECT_THROW(BSplineCurve<_Pt>(3, ctrlpts, descending), std::logic_error);
+}
+
+}
@@ -0,0 +1,66 @@
+//
+// Created by haochuanchen on 18-5-10.
+//
+
+#include "../src/curve/util/Parallel.h"
+#include <gmock/gmock.h>
+
+using namespace testing;
+using namespace std;
+
+namespace
+{
+
+TEST(Parallel, chunks_cover_the_range)
+{
+    std::vector<int> visits(1000, 0);
+    parallel_for_chunk(0, 1000, 7, [&visits](unsigned, long first, long last)
+    {
+        for (long i = first; i < last; i++)
+        {
+            visits[i]++;
+        }
+    });
+    EXPECT_THAT(visits, Each(1));
+}
+
+TEST(Parallel, nested)
+{
+    // every chunk runs a parallel loop itself, on the same shared pool
+    std::vector<std::atomic<int>> sums(16);
+    parallel_for_chunk(0, 16, 16, [&sums](unsigned, long first, long last)
+    {
+        for (long i = first; i < last; i++)
+        {
+            parallel_for_chunk(0, 100, 8, [&sums, i](unsigned, long inner_first, long inner_last)
+            {
+                sums[i] += int(inner_last - inner_first);
+            });
+        }
+    });
+    for (const auto& sum : sums)
+    {
+        EXPECT_EQ(100, sum.load());
+    }
+}
+
+TEST(Parallel, exception)
+{
+    std::atomic<int> n_run(0);
+    EXPECT_THROW(parallel_for_chunk(0, 64, 8, [&n_run](unsigned chunk, long, long)
+    {
+        n_run++;
+        if (chunk % 2 == 1)
+        {
+            throw std::runtime_error("chunk failed.");
+        }
+    }), std::runtime_error);
+    EXPECT_GE(n_run.load(), 1);
+
+    // the pool still works after a failure
+    std::atomic<long> total(0);
+    parallel_for_chunk(0, 64, 8, [&total](unsigned, long first, long last) { total += last - first; });
+    EXPECT_EQ(64, total.load());
+}
+
+}
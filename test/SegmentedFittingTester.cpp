@@ -0,0 +1,74 @@
+//
+// Created by haochuanchen on 18-5-8.
+//
+
+#include "../src/fitting/SegmentedFitting.h"
+#include "../src/curve/util/BSplineEvaluator.h"
+#include "TestCurves.h"
+#include <gmock/gmock.h>
+
+using namespace testing;
+using namespace std;
+
+namespace
+{
+
+using _Fitting = BSplineCurveFitting_Base;
+using _Ct = _Fitting::_In_Ct;
+using _Dt = _Fitting::_Dt;
+using _Vt = _Fitting::_Vt;
+
+TEST(SegmentedFitting, split_at_corner)
+{
+    // a wiggly run and a smooth run joined at a corner at t = 0.5
+    auto curve = make_curve(10001, [](_Dt t)
+    {
+        return t < 0.5 ? Vertex<_Dt>(t, 0.02 * std::sin(40 * t), 0.1 * std::sin(20 * t * t))
+                       : Vertex<_Dt>(0.5, t - 0.5, 0.1 * std::sin(20 * t * t));
+    });
+
+    SegmentedFitting fitting(curve, 3, 100);
+    std::vector<char> is_corner;
+    EXPECT_THAT(fitting.segment_breakpoints(is_corner), ElementsAre(0, 5000, 10000));
+    EXPECT_THAT(is_corner, ElementsAre(0, 1, 0));
+
+    auto fitted = fitting.fitting();
+    EXPECT_EQ(100, fitted.get_control_points().size());
+
+    // the corner is kept, a single fit rounds it off
+    KTPFitting ktp(curve, 3, 100);
+    auto error = ktp.fitting_error(fitted);
+    EXPECT_LT(error.max_error, ktp.fitting_error(ktp.fitting()).max_error);
+}
+
+TEST(SegmentedFitting, chunks_continuity)
+{
+    auto curve = make_curve(8001, [](_Dt t) { return Vertex<_Dt>(std::cos(6 * t), std::sin(6 * t), t); });
+    const auto& vertices = curve.get_vertices();
+
+    SegmentedFitting fitting(curve, 3, 120, SegmentedFitting::Continuity::C2);
+    fitting.set_chunk_size(2000);
+    std::vector<char> is_corner;
+    auto breakpoints = fitting.segment_breakpoints(is_corner);
+    ASSERT_EQ(5, breakpoints.size());
+
+    auto fitted = fitting.fitting();
+    EXPECT_EQ(120, fitted.get_control_points().size());
+
+    KTPFitting ktp(curve, 3, 120);
+    EXPECT_LT(ktp.fitting_error(fitted).max_error, 10 * ktp.fitting_error(ktp.fitting()).max_error);
+
+    // the first and second derivatives agree on both sides of the joints
+    BSplineEvaluator<_Dt> evaluator(fitted, 2);
+    _Vt left[3], right[3];
+    for (int i = 1; i + 1 < breakpoints.size(); i++)
+    {
+        _Dt u = vertices[breakpoints[i]].trait.u;
+        evaluator.derivatives(u - 1e-12, 2, left);
+        evaluator.derivatives(u + 1e-12, 2, right);
+        EXPECT_NEAR(0, (left[1] - right[1]).length(), 1e-6 * left[1].length()) << "u = " << u;
+        EXPECT_NEAR(0, (left[2] - right[2]).length(), 1e-6 * left[2].length()) << "u = " << u;
+    }
+}
+
+}
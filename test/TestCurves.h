@@ -0,0 +1,53 @@
+//
+// Created by haochuanchen on 18-5-8.
+//
+
+#ifndef B_SPLINE_TESTCURVES_H
+#define B_SPLINE_TESTCURVES_H
+
+#include "../src/curve/ParaCurve.h"
+
+/// Sample `func` at `n_vertex` uniform t in [0, 1], and parameterize the curve by chord length.
+/// \param n_vertex the number of vertices, at least 2
+/// \param func the shape, a vertex for every t
+/// \return the parameterized curve
+template <typename _Ct = ParaCurve<CurvePoint<double, ParaPointTrait<double>>>, typename _Func>
+_Ct make_curve(int n_vertex, _Func func)
+{
+    using _Dt = typename _Ct::_Dt;
+
+    _Ct curve;
+    auto& vertices = curve.get_vertices();
+    for (int i = 0; i < n_vertex; i++)
+    {
+        typename _Ct::_Pt point;
+        point.vertex = func(_Dt(i) / (n_vertex - 1));
+        vertices.push_back(point);
+    }
+    curve.chordal_parameterization();
+    return curve;
+}
+
+/// Sample `func` at `n_vertex` uniform t in [0, 1], t is the parameter of the vertex.
+/// \param n_vertex the number of vertices, at least 2
+/// \param func the shape, a vertex for every t
+/// \return the parameterized curve
+template <typename _Ct = ParaCurve<CurvePoint<double, ParaPointTrait<double>>>, typename _Func>
+_Ct make_uniform_curve(int n_vertex, _Func func)
+{
+    using _Dt = typename _Ct::_Dt;
+
+    _Ct curve;
+    auto& vertices = curve.get_vertices();
+    for (int i = 0; i < n_vertex; i++)
+    {
+        typename _Ct::_Pt point;
+        _Dt t = _Dt(i) / (n_vertex - 1);
+        point.vertex = func(t);
+        point.trait.u = t;
+        vertices.push_back(point);
+    }
+    return curve;
+}
+
+#endif //B_SPLINE_TESTCURVES_H